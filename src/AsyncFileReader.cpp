@@ -0,0 +1,755 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "AsyncFileReader.h"
+
+#include "compat.h"
+#include "ProgressProxy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <tuple>
+#include <utility>
+
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <cstdint>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace {
+// Smaller files are read synchronously.
+constexpr qint64 minAsyncChunks = 4;
+} // namespace
+
+class AsyncFileReader::Engine
+{
+  public:
+    virtual ~Engine() = default;
+
+    // Starts reading length bytes at offset into pData. Returns an errno value if that failed.
+    virtual qint32 submit(size_t slot, qint64 offset, char* pData, qint64 length) = 0;
+    // Waits for a read to finish, result is the number of bytes read or -errno. Returns an errno value if waiting failed.
+    virtual qint32 wait(size_t& slot, qint64& result) = 0;
+};
+
+#ifdef Q_OS_LINUX
+namespace {
+/*
+    A submission and a completion ring shared with the kernel, set up with the plain system calls.
+    Each read is a readv of one buffer, the oldest read opcode there is.
+
+    Setting up a ring maps three areas and populates them, too much for every file. So each thread
+    has one ring that all of its readers share, completions carry the reader they belong to.
+*/
+class IoUringRing
+{
+  public:
+    // Returns nullptr where io_uring can't be used.
+    static IoUringRing* forThisThread()
+    {
+        static thread_local std::unique_ptr<IoUringRing> t_pRing;
+        static thread_local bool t_bUnavailable = false;
+        if(t_pRing == nullptr && !t_bUnavailable)
+        {
+            t_pRing.reset(new IoUringRing());
+            if(!t_pRing->setup(ringEntries))
+            {
+                t_pRing.reset();
+                t_bUnavailable = true;
+            }
+        }
+        return t_pRing.get();
+    }
+
+    ~IoUringRing()
+    {
+        if(m_pSqes != nullptr)
+            ::munmap(m_pSqes, m_sqesSize);
+        if(m_pCqRing != nullptr && m_pCqRing != m_pSqRing)
+            ::munmap(m_pCqRing, m_cqRingSize);
+        if(m_pSqRing != nullptr)
+            ::munmap(m_pSqRing, m_sqRingSize);
+        if(m_ringFd >= 0)
+            ::close(m_ringFd);
+    }
+
+    IoUringRing(const IoUringRing&) = delete;
+    IoUringRing& operator=(const IoUringRing&) = delete;
+
+    // Tells the readers of this thread apart.
+    [[nodiscard]] quint32 newOwner() { return ++m_lastOwner; }
+
+    // Returns an errno value if the read wasn't started.
+    qint32 submit(const quint32 owner, const size_t slot, const int fd, const qint64 offset, iovec* pIovec)
+    {
+        // Completions that don't fit the queue would be lost on older kernels.
+        if(m_nofRunning >= m_cqEntries)
+            return EBUSY;
+
+        // Only this thread writes the tail.
+        const unsigned tail = *m_pSqTail;
+        if(tail - __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE) >= m_sqEntries)
+            return EBUSY;
+
+        const unsigned index = tail & *m_pSqMask;
+        io_uring_sqe& sqe = m_pSqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.off = (__u64)offset;
+        sqe.addr = (__u64)(std::uintptr_t)pIovec;
+        sqe.len = 1;
+        sqe.user_data = ((__u64)owner << 32) | (__u64)slot;
+        m_pSqArray[index] = index;
+        __atomic_store_n(m_pSqTail, tail + 1, __ATOMIC_RELEASE);
+
+        for(;;)
+        {
+            const long result = enter(1, 0, 0);
+            if(result == 1)
+            {
+                ++m_nofRunning;
+                return 0;
+            }
+            if(result < 0 && errno == EINTR)
+                continue;
+
+            /*
+                The kernel didn't take the entry. Left in the ring it would be submitted with the
+                next one, reading into a buffer that may be gone by then.
+            */
+            const qint32 error = result == 0 ? EAGAIN : errno;
+            __atomic_store_n(m_pSqTail, tail, __ATOMIC_RELEASE);
+            return error;
+        }
+    }
+
+    // Waits for a read of owner to finish. Returns an errno value if waiting failed.
+    qint32 wait(const quint32 owner, size_t& slot, qint64& result)
+    {
+        for(;;)
+        {
+            const auto it = std::find_if(m_done.begin(), m_done.end(), [owner](const Completion& done) { return done.m_owner == owner; });
+            if(it != m_done.end())
+            {
+                slot = it->m_slot;
+                result = it->m_result;
+                m_done.erase(it);
+                return 0;
+            }
+
+            // Completions of the other readers of this thread are kept for them.
+            const unsigned head = *m_pCqHead;
+            if(head != __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE))
+            {
+                const io_uring_cqe& cqe = m_pCqes[head & *m_pCqMask];
+                m_done.push_back({(quint32)(cqe.user_data >> 32), (size_t)(cqe.user_data & 0xffffffff), cqe.res});
+                __atomic_store_n(m_pCqHead, head + 1, __ATOMIC_RELEASE);
+                --m_nofRunning;
+                continue;
+            }
+
+            if(enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                return errno;
+        }
+    }
+
+  private:
+    // Enough for the readers of one thread, each has a few reads running.
+    static constexpr quint32 ringEntries = 64;
+
+    struct Completion
+    {
+        quint32 m_owner;
+        size_t m_slot;
+        qint64 m_result;
+    };
+
+    IoUringRing() = default;
+
+    bool setup(const quint32 entries)
+    {
+        io_uring_params params{};
+        m_ringFd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+        if(m_ringFd < 0)
+            return false;
+
+        m_sqEntries = params.sq_entries;
+        m_cqEntries = params.cq_entries;
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(bSingleMap)
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+
+        m_pSqRing = map(m_sqRingSize, IORING_OFF_SQ_RING);
+        if(m_pSqRing == nullptr)
+            return false;
+        m_pCqRing = bSingleMap ? m_pSqRing : map(m_cqRingSize, IORING_OFF_CQ_RING);
+        if(m_pCqRing == nullptr)
+            return false;
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_pSqes = static_cast<io_uring_sqe*>(map(m_sqesSize, IORING_OFF_SQES));
+        if(m_pSqes == nullptr)
+            return false;
+
+        char* pSq = static_cast<char*>(m_pSqRing);
+        m_pSqHead = reinterpret_cast<unsigned*>(pSq + params.sq_off.head);
+        m_pSqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+        m_pSqMask = reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+        m_pSqArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+        char* pCq = static_cast<char*>(m_pCqRing);
+        m_pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+        m_pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+        m_pCqMask = reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+        m_pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+        return true;
+    }
+
+    [[nodiscard]] void* map(const size_t size, const off_t offset) const
+    {
+        void* pData = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, offset);
+        return pData == MAP_FAILED ? nullptr : pData;
+    }
+
+    long enter(const unsigned toSubmit, const unsigned minComplete, const unsigned flags) const
+    {
+        return ::syscall(__NR_io_uring_enter, m_ringFd, toSubmit, minComplete, flags, nullptr, 0);
+    }
+
+    int m_ringFd = -1;
+    quint32 m_sqEntries = 0;
+    quint32 m_cqEntries = 0;
+
+    void* m_pSqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    void* m_pCqRing = nullptr;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe* m_pSqes = nullptr;
+    size_t m_sqesSize = 0;
+
+    unsigned* m_pSqHead = nullptr;
+    unsigned* m_pSqTail = nullptr;
+    unsigned* m_pSqMask = nullptr;
+    unsigned* m_pSqArray = nullptr;
+    unsigned* m_pCqHead = nullptr;
+    unsigned* m_pCqTail = nullptr;
+    unsigned* m_pCqMask = nullptr;
+    io_uring_cqe* m_pCqes = nullptr;
+
+    quint32 m_lastOwner = 0;
+    quint32 m_nofRunning = 0;
+    // Finished reads not yet picked up by their reader.
+    std::deque<Completion> m_done;
+};
+} // namespace
+
+// Reads through the ring of the thread that opened the file.
+class AsyncFileReader::IoUringEngine: public Engine
+{
+  public:
+    // Returns nullptr where io_uring can't be used.
+    static std::unique_ptr<IoUringEngine> create(const int fd, const quint32 entries)
+    {
+        IoUringRing* pRing = IoUringRing::forThisThread();
+        if(pRing == nullptr)
+            return nullptr;
+        return std::unique_ptr<IoUringEngine>(new IoUringEngine(*pRing, fd, entries));
+    }
+
+    qint32 submit(const size_t slot, const qint64 offset, char* pData, const qint64 length) override
+    {
+        m_iovecs[slot] = {pData, (size_t)length};
+        return m_ring.submit(m_owner, slot, m_fd, offset, &m_iovecs[slot]);
+    }
+
+    qint32 wait(size_t& slot, qint64& result) override { return m_ring.wait(m_owner, slot, result); }
+
+  private:
+    IoUringEngine(IoUringRing& ring, const int fd, const quint32 entries):
+        m_ring(ring), m_owner(ring.newOwner()), m_fd(fd), m_iovecs(entries) {}
+
+    IoUringRing& m_ring;
+    const quint32 m_owner;
+    const int m_fd;
+    // The buffer of each slot, must stay valid while its read runs.
+    std::vector<iovec> m_iovecs;
+};
+#endif
+
+#ifndef Q_OS_WIN
+namespace {
+/*
+    pread on worker threads, for where io_uring isn't available. The threads are started once
+    and shared by all readers.
+*/
+class ReadThreadPool
+{
+  public:
+    // Where a finished read is handed to, one per reader.
+    struct Queue
+    {
+        std::deque<std::pair<size_t, qint64>> m_done; // Guarded by the pool's mutex
+    };
+
+    static ReadThreadPool& instance()
+    {
+        static ReadThreadPool pool;
+        return pool;
+    }
+
+    ~ReadThreadPool()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_bStop = true;
+            m_workAvailable.wakeAll();
+        }
+        for(const std::unique_ptr<Worker>& pWorker: m_workers)
+            pWorker->wait();
+    }
+
+    ReadThreadPool(const ReadThreadPool&) = delete;
+    ReadThreadPool& operator=(const ReadThreadPool&) = delete;
+
+    void submit(Queue& queue, const size_t slot, const int fd, const qint64 offset, char* pData, const qint64 length)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_requests.push_back({&queue, slot, fd, offset, pData, length});
+        m_workAvailable.wakeOne();
+    }
+
+    void wait(Queue& queue, size_t& slot, qint64& result)
+    {
+        QMutexLocker locker(&m_mutex);
+        while(queue.m_done.empty())
+            m_readDone.wait(&m_mutex);
+
+        std::tie(slot, result) = queue.m_done.front();
+        queue.m_done.pop_front();
+    }
+
+  private:
+    struct Request
+    {
+        Queue* m_pQueue;
+        size_t m_slot;
+        int m_fd;
+        qint64 m_offset;
+        char* m_pData;
+        qint64 m_length;
+    };
+
+    class Worker: public QThread
+    {
+      public:
+        explicit Worker(ReadThreadPool& pool): m_pool(pool) {}
+
+        void run() override { m_pool.work(); }
+
+      private:
+        ReadThreadPool& m_pool;
+    };
+
+    ReadThreadPool()
+    {
+        // Enough to keep a few readers busy on a fast device, more doesn't help a slow one.
+        const qint32 nofThreads = std::clamp(QThread::idealThreadCount() * 2, 4, 16);
+        for(qint32 i = 0; i < nofThreads; ++i)
+        {
+            m_workers.push_back(std::make_unique<Worker>(*this));
+            m_workers.back()->start();
+        }
+    }
+
+    void work()
+    {
+        QMutexLocker locker(&m_mutex);
+        for(;;)
+        {
+            while(m_requests.empty() && !m_bStop)
+                m_workAvailable.wait(&m_mutex);
+            if(m_bStop)
+                return;
+
+            const Request request = m_requests.front();
+            m_requests.pop_front();
+            locker.unlock();
+
+            ssize_t result = 0;
+            do
+            {
+                result = ::pread(request.m_fd, request.m_pData, (size_t)request.m_length, (off_t)request.m_offset);
+            } while(result < 0 && errno == EINTR);
+            const qint64 readResult = result < 0 ? -errno : result;
+
+            locker.relock();
+            request.m_pQueue->m_done.emplace_back(request.m_slot, readResult);
+            // Several readers may be waiting, each for its own reads.
+            m_readDone.wakeAll();
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_readDone;
+    // Guarded by m_mutex
+    std::deque<Request> m_requests;
+    bool m_bStop = false;
+};
+} // namespace
+
+class AsyncFileReader::ThreadEngine: public Engine
+{
+  public:
+    explicit ThreadEngine(const int fd): m_fd(fd) {}
+
+    qint32 submit(const size_t slot, const qint64 offset, char* pData, const qint64 length) override
+    {
+        ReadThreadPool::instance().submit(m_queue, slot, m_fd, offset, pData, length);
+        return 0;
+    }
+
+    qint32 wait(size_t& slot, qint64& result) override
+    {
+        ReadThreadPool::instance().wait(m_queue, slot, result);
+        return 0;
+    }
+
+  private:
+    const int m_fd;
+    ReadThreadPool::Queue m_queue;
+};
+#endif
+
+// Reads at once when a read is submitted.
+class AsyncFileReader::SynchronousEngine: public Engine
+{
+  public:
+    explicit SynchronousEngine(QFile& file): m_file(file) {}
+
+    qint32 submit(const size_t slot, const qint64 offset, char* pData, const qint64 length) override
+    {
+        qint64 result = -EIO;
+        if(m_file.seek(offset))
+        {
+            const qint64 len = m_file.read(pData, length);
+            if(len >= 0)
+                result = len;
+        }
+        m_done.emplace_back(slot, result);
+        return 0;
+    }
+
+    qint32 wait(size_t& slot, qint64& result) override
+    {
+        if(m_done.empty())
+            return EINVAL;
+
+        std::tie(slot, result) = m_done.front();
+        m_done.pop_front();
+        return 0;
+    }
+
+  private:
+    QFile& m_file;
+    std::deque<std::pair<size_t, qint64>> m_done;
+};
+
+AsyncFileReader::AsyncFileReader(const qint64 chunkSize, const qint32 queueDepth, const Backend backend):
+    m_chunkSize(chunkSize), m_queueDepth(std::max(queueDepth, 1)), m_requestedBackend(backend)
+{
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    close();
+}
+
+bool AsyncFileReader::open(const QString& path)
+{
+    close();
+    m_errorText.clear();
+
+    m_file.setFileName(path);
+    // Unbuffered, all reads are at explicit offsets.
+    if(!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        m_errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", path, m_file.errorString());
+        return false;
+    }
+
+    m_size = m_file.size();
+    Backend backend = m_requestedBackend;
+    if(backend == eAutomatic)
+        backend = m_size < minAsyncChunks * m_chunkSize ? eSynchronous : eIoUring;
+    m_pEngine = createEngine(backend);
+    m_slots.assign(m_backend == eSynchronous ? 1 : (size_t)m_queueDepth, Slot());
+    m_submitOffset = 0;
+    m_readOffset = 0;
+    m_inUse = -1;
+    return true;
+}
+
+std::unique_ptr<AsyncFileReader::Engine> AsyncFileReader::createEngine(Backend backend)
+{
+#ifdef Q_OS_LINUX
+    if(backend == eIoUring)
+    {
+        std::unique_ptr<IoUringEngine> pEngine = IoUringEngine::create(m_file.handle(), (quint32)m_queueDepth);
+        if(pEngine != nullptr)
+        {
+            m_backend = eIoUring;
+            return pEngine;
+        }
+        backend = eThreads;
+    }
+#endif
+#ifndef Q_OS_WIN
+    if(backend == eIoUring || backend == eThreads)
+    {
+        m_backend = eThreads;
+        return std::make_unique<ThreadEngine>(m_file.handle());
+    }
+#endif
+    m_backend = eSynchronous;
+    return std::make_unique<SynchronousEngine>(m_file);
+}
+
+const char* AsyncFileReader::next(qint64& len)
+{
+    len = 0;
+    if(m_pEngine == nullptr)
+        return nullptr;
+
+    // The caller is done with the chunk handed out last time.
+    if(m_inUse >= 0)
+    {
+        Slot& slot = m_slots[(size_t)m_inUse];
+        if(m_bDropCache)
+            dropCache(slot.m_offset, slot.m_length);
+        slot.m_state = Slot::eFree;
+        m_inUse = -1;
+    }
+    if(m_readOffset >= m_size)
+        return nullptr;
+
+    if(m_buffers.empty())
+    {
+        m_buffers.resize(m_slots.size());
+        for(std::unique_ptr<char[]>& pBuffer: m_buffers)
+            pBuffer = std::make_unique<char[]>((size_t)m_chunkSize);
+    }
+
+    // Chunk n is always read into slot n % m_slots.size(), so they come back in order.
+    while(m_submitOffset < m_size)
+    {
+        const size_t index = (size_t)(m_submitOffset / m_chunkSize) % m_slots.size();
+        Slot& slot = m_slots[index];
+        if(slot.m_state != Slot::eFree)
+            break;
+
+        slot.m_offset = m_submitOffset;
+        slot.m_pData = m_buffers[index].get();
+        slot.m_length = std::min(m_chunkSize, m_size - m_submitOffset);
+        slot.m_done = 0;
+        if(!submit(index))
+        {
+            stop();
+            return nullptr;
+        }
+        m_submitOffset += slot.m_length;
+    }
+
+    const size_t index = (size_t)(m_readOffset / m_chunkSize) % m_slots.size();
+    while(m_slots[index].m_state != Slot::eReady)
+    {
+        if(!waitForOne())
+        {
+            stop();
+            return nullptr;
+        }
+    }
+
+    Slot& slot = m_slots[index];
+    slot.m_state = Slot::eInUse;
+    m_inUse = (qint32)index;
+    m_readOffset += slot.m_length;
+    len = slot.m_length;
+    return slot.m_pData;
+}
+
+bool AsyncFileReader::readAll(char* pDest, const qint64 len)
+{
+    if(m_pEngine == nullptr)
+        return false;
+
+    ProgressScope pp;
+    ProgressProxy::setMaxNofSteps(len / m_chunkSize + 1);
+
+    for(;;)
+    {
+        bool bReading = false;
+        for(size_t index = 0; index < m_slots.size(); ++index)
+        {
+            Slot& slot = m_slots[index];
+            if(slot.m_state == Slot::eFree && m_submitOffset < len)
+            {
+                slot.m_offset = m_submitOffset;
+                slot.m_pData = pDest + m_submitOffset;
+                slot.m_length = std::min(m_chunkSize, len - m_submitOffset);
+                slot.m_done = 0;
+                if(!submit(index))
+                {
+                    stop();
+                    return false;
+                }
+                m_submitOffset += slot.m_length;
+            }
+            bReading = bReading || slot.m_state == Slot::eReading;
+        }
+        if(!bReading)
+            return true;
+
+        if(!waitForOne())
+        {
+            stop();
+            return false;
+        }
+        for(Slot& slot: m_slots)
+        {
+            if(slot.m_state == Slot::eReady)
+            {
+                slot.m_state = Slot::eFree;
+                ProgressProxy::step();
+            }
+        }
+
+        if(ProgressProxy::wasCancelled())
+        {
+            m_errorText = i18nc("@info %1 is a path", "User cancelled read operation on %1", m_file.fileName());
+            stop();
+            return false;
+        }
+    }
+}
+
+void AsyncFileReader::close()
+{
+    stop();
+    if(m_file.isOpen())
+    {
+        m_file.close();
+    }
+    m_slots.clear();
+    m_buffers.clear();
+    m_size = 0;
+    m_backend = eAutomatic;
+}
+
+bool AsyncFileReader::submit(const size_t index)
+{
+    Slot& slot = m_slots[index];
+    const qint32 error = m_pEngine->submit(index, slot.m_offset + slot.m_done, slot.m_pData + slot.m_done, slot.m_length - slot.m_done);
+    if(error != 0)
+    {
+        setReadError(-error);
+        return false;
+    }
+    slot.m_state = Slot::eReading;
+    return true;
+}
+
+bool AsyncFileReader::waitForOne()
+{
+    size_t index = 0;
+    qint64 result = 0;
+    const qint32 error = m_pEngine->wait(index, result);
+    if(error != 0)
+    {
+        setReadError(-error);
+        return false;
+    }
+
+    Slot& slot = m_slots[index];
+    slot.m_state = Slot::eFree;
+    if(result <= 0)
+    {
+        setReadError(result);
+        return false;
+    }
+
+    slot.m_done += result;
+    if(slot.m_done < slot.m_length)
+        return submit(index);
+
+    slot.m_state = Slot::eReady;
+    return true;
+}
+
+void AsyncFileReader::stop()
+{
+    if(m_pEngine == nullptr)
+        return;
+
+    // The buffers may only go once the kernel or the workers are done with them.
+    for(Slot& slot: m_slots)
+    {
+        while(slot.m_state == Slot::eReading)
+        {
+            size_t index = 0;
+            qint64 result = 0;
+            if(m_pEngine->wait(index, result) != 0)
+                break;
+            m_slots[index].m_state = Slot::eFree;
+        }
+    }
+    m_pEngine.reset();
+}
+
+void AsyncFileReader::dropCache(const qint64 offset, const qint64 length)
+{
+#if !defined(Q_OS_WIN) && defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(m_file.handle(), offset, length, POSIX_FADV_DONTNEED);
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(length);
+#endif
+}
+
+void AsyncFileReader::setReadError(const qint64 result)
+{
+    QString reason;
+    if(result == 0)
+        reason = i18nc("@info:status", "The file is shorter than expected.");
+    else if(m_backend == eSynchronous)
+        reason = m_file.errorString();
+    else
+        reason = QString::fromLocal8Bit(strerror((int)-result));
+
+    m_errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", m_file.fileName(), reason);
+}
@@ -0,0 +1,122 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef ASYNCFILEREADER_H
+#define ASYNCFILEREADER_H
+
+#include <memory>
+#include <vector>
+
+#include <QFile>
+#include <QString>
+
+/*
+    Reads a local file front to back with several chunks in flight, so the device always has the
+    next reads queued while the caller works on the current chunk. Usable on any thread, one
+    reader per file. A file is read on the thread that opened it.
+
+    On Linux the reads go through io_uring, one ring per thread shared by its readers. Where that
+    isn't available, e.g. blocked by a seccomp filter or io_uring_disabled, a pool of threads shared
+    by all readers reads the chunks with pread. Small files and files on Windows are read
+    synchronously, the setup isn't worth it for them.
+*/
+class AsyncFileReader
+{
+  public:
+    enum Backend
+    {
+        eAutomatic,   // Best available for the file size
+        eIoUring,     // Linux only
+        eThreads,     // Not on Windows
+        eSynchronous  // Plain reads on the calling thread
+    };
+
+    // Chunks and buffers are chunkSize bytes, at most queueDepth of them are read at a time.
+    explicit AsyncFileReader(qint64 chunkSize = 1024 * 1024, qint32 queueDepth = 4, Backend backend = eAutomatic);
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    bool open(const QString& path);
+    [[nodiscard]] qint64 size() const { return m_size; }
+    // The backend used for the open file, eAutomatic when nothing is open.
+    [[nodiscard]] Backend backend() const { return m_backend; }
+
+    /*
+        After a chunk is used the reader tells the OS that it isn't needed again, so that a scan
+        over a whole tree doesn't evict everything else from the page cache.
+    */
+    void setDropCache(bool bDropCache) { m_bDropCache = bDropCache; }
+
+    /*
+        The next chunk, valid until the next call. len is chunkSize or the rest of the file, 0 at the
+        end. Returns nullptr at the end or on a read error.
+    */
+    [[nodiscard]] const char* next(qint64& len);
+    // Reads the first len bytes of the file into pDest, with progress and the cancel button.
+    bool readAll(char* pDest, qint64 len);
+
+    void close();
+
+    [[nodiscard]] const QString& errorString() const { return m_errorText; }
+
+  private:
+    class Engine;
+    class IoUringEngine;
+    class ThreadEngine;
+    class SynchronousEngine;
+
+    struct Slot
+    {
+        enum State
+        {
+            eFree,
+            eReading,
+            eReady,
+            eInUse
+        };
+
+        State m_state = eFree;
+        qint64 m_offset = 0;
+        char* m_pData = nullptr;
+        qint64 m_length = 0;
+        qint64 m_done = 0;
+    };
+
+    [[nodiscard]] std::unique_ptr<Engine> createEngine(Backend backend);
+    bool submit(size_t slot);
+    // Waits until one read finished, resubmits short reads.
+    bool waitForOne();
+    // Waits for the reads still running and drops the engine, nothing is read after an error.
+    void stop();
+    void dropCache(qint64 offset, qint64 length);
+    // result is what a read returned: 0 at an unexpected end of the file or -errno.
+    void setReadError(qint64 result);
+
+    const qint64 m_chunkSize;
+    const qint32 m_queueDepth;
+    const Backend m_requestedBackend;
+
+    QFile m_file;
+    QString m_errorText;
+    qint64 m_size = 0;
+    Backend m_backend = eAutomatic;
+    bool m_bDropCache = false;
+
+    std::unique_ptr<Engine> m_pEngine;
+    std::vector<Slot> m_slots;
+    std::vector<std::unique_ptr<char[]>> m_buffers;
+    qint64 m_submitOffset = 0;
+    qint64 m_readOffset = 0;
+    // Slot handed out by the last call of next()
+    qint32 m_inUse = -1;
+};
+
+#endif /* ASYNCFILEREADER_H */
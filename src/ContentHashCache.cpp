@@ -0,0 +1,221 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "ContentHashCache.h"
+
+#include "Logging.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <KLocalizedString>
+
+namespace {
+constexpr quint32 cacheMagic = 0x4b443348; // "KD3H"
+constexpr quint32 cacheVersion = 1;
+// Six 64 bit numbers and the length of an empty hash.
+constexpr qint64 minRecordSize = 6 * 8 + 4;
+} // namespace
+
+size_t qHash(const ContentHashCache::Key& key, size_t seed) noexcept
+{
+    return qHashMulti(seed, key.m_device, key.m_inode, key.m_size, key.m_mtimeNs, key.m_ctimeNs);
+}
+
+std::optional<ContentHashCache::Key> ContentHashCache::keyFor(const QString& localPath)
+{
+#ifndef Q_OS_WIN
+    struct stat st;
+    if(::stat(QFile::encodeName(localPath).constData(), &st) != 0)
+        return std::nullopt;
+
+    Key key;
+    key.m_device = (quint64)st.st_dev;
+    key.m_inode = (quint64)st.st_ino;
+    key.m_size = (qint64)st.st_size;
+#ifdef Q_OS_MACOS
+    key.m_mtimeNs = (qint64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+    key.m_ctimeNs = (qint64)st.st_ctimespec.tv_sec * 1000000000 + st.st_ctimespec.tv_nsec;
+#else
+    key.m_mtimeNs = (qint64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    key.m_ctimeNs = (qint64)st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec;
+#endif
+    return key;
+#else
+    // stat() on Windows has no inode and st_ctime is the creation time.
+    Q_UNUSED(localPath);
+    return std::nullopt;
+#endif
+}
+
+QString ContentHashCache::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/contenthashes");
+}
+
+ContentHashCache::ContentHashCache(const QString& fileName):
+    m_fileName(fileName)
+{
+}
+
+bool ContentHashCache::read(QHash<Key, Entry>& entries) const
+{
+    QFile file(m_fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 nofEntries = 0;
+    stream >> magic >> version >> nofEntries;
+    if(stream.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion || nofEntries < 0)
+    {
+        qCWarning(kdiffMain) << "Ignoring unknown or damaged hash cache" << m_fileName;
+        return false;
+    }
+
+    // The count comes from the file, no more records than it can hold.
+    entries.reserve(entries.size() + std::min(nofEntries, file.size() / minRecordSize));
+    for(qint64 i = 0; i < nofEntries && stream.status() == QDataStream::Ok; ++i)
+    {
+        Key key;
+        Entry entry;
+        stream >> key.m_device >> key.m_inode >> key.m_size >> key.m_mtimeNs >> key.m_ctimeNs >> entry.m_lastUsed >> entry.m_hash;
+        if(stream.status() != QDataStream::Ok)
+            break;
+
+        // Keep the most recent use when both sides know the file.
+        auto it = entries.find(key);
+        if(it == entries.end())
+            entries.insert(key, entry);
+        else if(it->m_lastUsed < entry.m_lastUsed)
+            it->m_lastUsed = entry.m_lastUsed;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+void ContentHashCache::load()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    if(!read(m_entries))
+        m_entries.clear();
+}
+
+bool ContentHashCache::save(qint64 maxEntries)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const QString dirName = QFileInfo(m_fileName).absolutePath();
+    if(!QDir().mkpath(dirName))
+        return false;
+
+    // Another process may be writing right now, wait for it and then build on its result.
+    QLockFile lock(m_fileName + QStringLiteral(".lock"));
+    if(!lock.lock())
+        return false;
+
+    QHash<Key, Entry> entries = m_entries;
+    if(!read(entries))
+        entries = m_entries;
+
+    std::vector<std::pair<qint64, Key>> byAge;
+    if(entries.size() > maxEntries)
+    {
+        byAge.reserve(entries.size());
+        for(auto it = entries.cbegin(); it != entries.cend(); ++it)
+            byAge.emplace_back(it->m_lastUsed, it.key());
+
+        const qint64 nofRemoved = entries.size() - std::max<qint64>(maxEntries, 0);
+        std::nth_element(byAge.begin(), byAge.begin() + nofRemoved, byAge.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for(qint64 i = 0; i < nofRemoved; ++i)
+            entries.remove(byAge[i].second);
+    }
+
+    QSaveFile file(m_fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream << cacheMagic << cacheVersion << (qint64)entries.size();
+    for(auto it = entries.cbegin(); it != entries.cend(); ++it)
+    {
+        const Key& key = it.key();
+        stream << key.m_device << key.m_inode << key.m_size << key.m_mtimeNs << key.m_ctimeNs << it->m_lastUsed << it->m_hash;
+    }
+
+    if(stream.status() != QDataStream::Ok || !file.commit())
+        return false;
+
+    m_entries = std::move(entries);
+    return true;
+}
+
+std::optional<QByteArray> ContentHashCache::find(const Key& key)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(key);
+    if(it == m_entries.end())
+        return std::nullopt;
+
+    it->m_lastUsed = QDateTime::currentSecsSinceEpoch();
+    return it->m_hash;
+}
+
+void ContentHashCache::insert(const Key& key, const QByteArray& hash)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(key, Entry{hash, QDateTime::currentSecsSinceEpoch()});
+}
+
+qint64 ContentHashCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+QString ContentHashCache::describe() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    qint64 oldest = 0;
+    qint64 newest = 0;
+    for(const Entry& entry: m_entries)
+    {
+        oldest = oldest == 0 ? entry.m_lastUsed : std::min(oldest, entry.m_lastUsed);
+        newest = std::max(newest, entry.m_lastUsed);
+    }
+
+    QString s = i18n("Hash cache: %1", m_fileName) + u'\n';
+    s += i18n("Size on disk: %1 bytes", QFileInfo(m_fileName).size()) + u'\n';
+    s += i18n("Entries: %1", m_entries.size()) + u'\n';
+    if(!m_entries.isEmpty())
+    {
+        s += i18n("Least recently used: %1", QDateTime::fromSecsSinceEpoch(oldest).toString(Qt::ISODate)) + u'\n';
+        s += i18n("Most recently used: %1", QDateTime::fromSecsSinceEpoch(newest).toString(Qt::ISODate)) + u'\n';
+    }
+    return s;
+}
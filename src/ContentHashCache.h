@@ -0,0 +1,92 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef CONTENTHASHCACHE_H
+#define CONTENTHASHCACHE_H
+
+#include <memory>
+#include <optional>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/*
+    Content hashes of local files remembered between folder comparisons.
+
+    An entry is keyed by device, inode, size and the modification and status change times in
+    nanoseconds. Any write to the file changes at least one of these, so a cached hash is only
+    found for unchanged files. Stale entries are never found again and age out as the cache is
+    trimmed to its maximum size, least recently used first.
+
+    The cache file is replaced atomically and updated under a lock file. Several KDiff3 processes
+    may use it at the same time, entries added by one are merged into what the others write.
+
+    Lookups and inserts are thread safe.
+*/
+class ContentHashCache
+{
+  public:
+    struct Key
+    {
+        quint64 m_device = 0;
+        quint64 m_inode = 0;
+        qint64 m_size = 0;
+        qint64 m_mtimeNs = 0;
+        qint64 m_ctimeNs = 0;
+
+        bool operator==(const Key& other) const
+        {
+            return m_device == other.m_device && m_inode == other.m_inode && m_size == other.m_size &&
+                   m_mtimeNs == other.m_mtimeNs && m_ctimeNs == other.m_ctimeNs;
+        }
+        bool operator!=(const Key& other) const { return !(*this == other); }
+    };
+
+    // Returns nullopt if the file can't be stat'ed or the platform has no stable inode numbers.
+    [[nodiscard]] static std::optional<Key> keyFor(const QString& localPath);
+    [[nodiscard]] static QString defaultFileName();
+
+    explicit ContentHashCache(const QString& fileName = defaultFileName());
+
+    [[nodiscard]] const QString& fileName() const { return m_fileName; }
+
+    // A missing or damaged cache file just means an empty cache.
+    void load();
+    // Merges with the current file contents and keeps the maxEntries most recently used entries.
+    bool save(qint64 maxEntries);
+
+    [[nodiscard]] std::optional<QByteArray> find(const Key& key);
+    void insert(const Key& key, const QByteArray& hash);
+
+    [[nodiscard]] qint64 count() const;
+    // Summary for the command line.
+    [[nodiscard]] QString describe() const;
+
+  private:
+    struct Entry
+    {
+        QByteArray m_hash;
+        qint64 m_lastUsed = 0; // Seconds since epoch
+    };
+
+    [[nodiscard]] bool read(QHash<Key, Entry>& entries) const;
+
+    QString m_fileName;
+    mutable QMutex m_mutex;
+    QHash<Key, Entry> m_entries;
+};
+
+size_t qHash(const ContentHashCache::Key& key, size_t seed = 0) noexcept;
+
+// Only set while a folder comparison with the hash cache enabled is running.
+inline std::unique_ptr<ContentHashCache> gContentHashCache;
+
+#endif /* CONTENTHASHCACHE_H */
@@ -21,7 +21,6 @@
 #include <QByteArray>
 #include <QDir>
 #include <QFile>
-#include <QRegularExpression>
 #include <QStringList>
 #include <QTextStream>
 
@@ -56,6 +55,14 @@ void CvsIgnoreList::enterDir(const QString& dir, const DirectoryList& directoryL
             addEntriesFromFile(dir, file.getTempName());
         }
     }
+
+    // Compiled here, matches() then only reads and may run on several threads.
+    const auto ignorePatternsIt = m_ignorePatterns.find(dir);
+    if(ignorePatternsIt != m_ignorePatterns.end())
+    {
+        (void)ignorePatternsIt->second.matcher(true);
+        (void)ignorePatternsIt->second.matcher(false);
+    }
 }
 
 void CvsIgnoreList::addEntriesFromString(const QString& dir, const QString& str)
@@ -112,28 +119,32 @@ void CvsIgnoreList::addEntry(const QString& dir, const QString& pattern)
             ++pos;
         }
 
+        CvsIgnorePatterns& patterns = m_ignorePatterns[dir];
+        patterns.m_pCaseSensitiveMatcher.reset();
+        patterns.m_pCaseInsensitiveMatcher.reset();
+
         if(nofMetaCharacters == 0)
         {
-            m_ignorePatterns[dir].m_exactPatterns.append(pattern);
+            patterns.m_exactPatterns.append(pattern);
         }
         else if(nofMetaCharacters == 1)
         {
             if(pattern.at(0) == QChar(u'*'))
             {
-                m_ignorePatterns[dir].m_endPatterns.append(pattern.right(pattern.length() - 1));
+                patterns.m_endPatterns.append(pattern.right(pattern.length() - 1));
             }
             else if(pattern.at(pattern.length() - 1) == QChar(u'*'))
             {
-                m_ignorePatterns[dir].m_startPatterns.append(pattern.left(pattern.length() - 1));
+                patterns.m_startPatterns.append(pattern.left(pattern.length() - 1));
             }
             else
             {
-                m_ignorePatterns[dir].m_generalPatterns.append(pattern);
+                patterns.m_generalPatterns.append(pattern);
             }
         }
         else
         {
-            m_ignorePatterns[dir].m_generalPatterns.append(pattern);
+            patterns.m_generalPatterns.append(pattern);
         }
     }
     else
@@ -149,36 +160,8 @@ bool CvsIgnoreList::matches(const QString& dir, const QString& text, bool bCaseS
     {
         return false;
     }
-    //Do not use QStringList::indexof here it has no case flag
-    if(ignorePatternsIt->second.m_exactPatterns.contains(text, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive))
-    {
-        return true;
-    }
 
-    for(const QString& startPattern: ignorePatternsIt->second.m_startPatterns)
-    {
-        if(text.startsWith(startPattern, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive))
-        {
-            return true;
-        }
-    }
-
-    for(const QString& endPattern: ignorePatternsIt->second.m_endPatterns)
-    {
-        if(text.endsWith(endPattern, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive))
-        {
-            return true;
-        }
-    }
-
-    for(const QString& globStr: ignorePatternsIt->second.m_generalPatterns)
-    {
-        QRegularExpression pattern(QRegularExpression::wildcardToRegularExpression(globStr), bCaseSensitive ? QRegularExpression::UseUnicodePropertiesOption : QRegularExpression::UseUnicodePropertiesOption | QRegularExpression::CaseInsensitiveOption);
-        if(pattern.match(text).hasMatch())
-            return true;
-    }
-
-    return false;
+    return ignorePatternsIt->second.matcher(bCaseSensitive).matches(text);
 }
 
 bool CvsIgnoreList::ignoreExists(const DirectoryList& pDirList)
@@ -190,3 +173,23 @@ bool CvsIgnoreList::ignoreExists(const DirectoryList& pDirList)
     }
     return false;
 }
+
+const GlobMatcher& CvsIgnorePatterns::matcher(bool bCaseSensitive) const
+{
+    std::shared_ptr<const GlobMatcher>& pMatcher = bCaseSensitive ? m_pCaseSensitiveMatcher : m_pCaseInsensitiveMatcher;
+    if(pMatcher == nullptr)
+    {
+        // Kept as addEntry sorted them, start and end patterns are plain text even if they contain a '['.
+        const std::shared_ptr<GlobMatcher> pNewMatcher = std::make_shared<GlobMatcher>(bCaseSensitive);
+        for(const QString& pattern: m_exactPatterns)
+            pNewMatcher->addName(pattern);
+        for(const QString& pattern: m_startPatterns)
+            pNewMatcher->addPrefix(pattern);
+        for(const QString& pattern: m_endPatterns)
+            pNewMatcher->addSuffix(pattern);
+        for(const QString& pattern: m_generalPatterns)
+            pNewMatcher->addGlob(pattern);
+        pMatcher = pNewMatcher;
+    }
+    return *pMatcher;
+}
@@ -14,12 +14,14 @@
 //#include "fileaccess.h"
 
 #include "DirectoryList.h"
+#include "GlobMatcher.h"
 #include "IgnoreList.h"
 
 #include <QString>
 #include <QStringList>
 
 #include <map>
+#include <memory>
 
 struct CvsIgnorePatterns
 {
@@ -27,6 +29,12 @@ struct CvsIgnorePatterns
     QStringList m_startPatterns;
     QStringList m_endPatterns;
     QStringList m_generalPatterns;
+
+    // Built from the lists above on first use, addEntry discards them. Copies share them.
+    mutable std::shared_ptr<const GlobMatcher> m_pCaseSensitiveMatcher;
+    mutable std::shared_ptr<const GlobMatcher> m_pCaseInsensitiveMatcher;
+
+    [[nodiscard]] const GlobMatcher& matcher(bool bCaseSensitive) const;
 };
 
 class CvsIgnoreList : public IgnoreList
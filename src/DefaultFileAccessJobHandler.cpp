@@ -12,8 +12,12 @@
 
 #include "compat.h"
 #include "defmac.h"
+#include "DirectoryWalker.h"
 #include "fileaccess.h"
+#include "FileFilter.h"
 #include "IgnoreList.h"
+#include "LocalDirectoryScanner.h"
+#include "LocalFileCopy.h"
 #include "Logging.h"
 #include "progress.h"
 #include "ProgressProxyExtender.h"
@@ -21,10 +25,13 @@
 
 #include <algorithm>
 #include <list>
+#include <optional>
 #include <utility>
 
+#include <QCoreApplication>
 #include <QFileInfoList>
 #include <QDir>
+#include <QThread>
 #include <QUrl>
 
 #include <KIO/CopyJob>
@@ -357,6 +364,9 @@ bool DefaultFileAccessJobHandler::copyFile(const QString& inDest)
     mFileAccess->setStatusText(QString());
     if(!mFileAccess->isNormal() || !dest.isNormal()) return false;
 
+    if(mFileAccess->isLocal() && dest.isLocal())
+        return copyLocalFile(dest);
+
     qint32 permissions = (mFileAccess->isExecutable() ? 0111 : 0) + (mFileAccess->isWritable() ? 0222 : 0) + (mFileAccess->isReadable() ? 0444 : 0);
     m_bSuccess = false;
     KIO::FileCopyJob* pJob = KIO::file_copy(mFileAccess->url(), dest.url(), permissions, KIO::HideProgressInfo|KIO::Overwrite);
@@ -371,6 +381,19 @@ bool DefaultFileAccessJobHandler::copyFile(const QString& inDest)
     // Note that the KIO-slave preserves the original date, if this is supported.
 }
 
+// KIO needs the GUI thread. Local copies are made without it, so the folder merge can run them on worker threads.
+bool DefaultFileAccessJobHandler::copyLocalFile(const FileAccess& dest)
+{
+    QString errorText;
+    const LocalFileCopy::Method method = LocalFileCopy::copy(mFileAccess->absoluteFilePath(), dest.absoluteFilePath(), errorText);
+    if(method == LocalFileCopy::eFailed)
+    {
+        mFileAccess->setStatusText(errorText);
+        return false;
+    }
+    return true;
+}
+
 bool DefaultFileAccessJobHandler::listDir(DirectoryList* pDirList, bool bRecursive, bool bFindHidden, const QString& filePattern,
                                    const QString& fileAntiPattern, const QString& dirAntiPattern, bool bFollowDirLinks, IgnoreList& ignoreList)
 {
@@ -387,44 +410,26 @@ bool DefaultFileAccessJobHandler::listDir(DirectoryList* pDirList, bool bRecursi
     if(ProgressProxy::wasCancelled())
         return true; // Cancelled is not an error.
 
-    ProgressProxy::setInformation(i18nc("Status message", "Reading folder: %1", mFileAccess->absoluteFilePath()), 0, false);
+    // Local folders may be scanned on a helper thread. The progress dialog can only be updated from the GUI thread.
+    if(QThread::currentThread() == QCoreApplication::instance()->thread())
+        ProgressProxy::setInformation(i18nc("Status message", "Reading folder: %1", mFileAccess->absoluteFilePath()), 0, false);
     qCInfo(kdiffFileAccess) << "Reading folder: " << mFileAccess->absoluteFilePath();
 
     if(mFileAccess->isLocal())
     {
-        m_bSuccess = true;
-        QDir dir(mFileAccess->absoluteFilePath());
-
-        dir.setSorting(QDir::Name | QDir::DirsFirst);
-        if(bFindHidden)
-            dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
-        else
-            dir.setFilter(QDir::Files | QDir::Dirs | QDir::System | QDir::NoDotAndDotDot);
-
-        const QFileInfoList fiList = dir.entryInfoList();
-        if(fiList.isEmpty())
+        if(bRecursive)
         {
-            /*
-                Sadly Qt provides no error information making this case ambiguous.
-                A readability check is the best we can do.
-            */
-            m_bSuccess = dir.isReadable();
+            // Sub-folders are listed and filtered on a thread pool, see DirectoryWalker.
+            DirectoryWalker walker([bFindHidden](FileAccess& dir, DirectoryList& entries) { return scanLocalDirectory(dir, entries, bFindHidden); },
+                                   ignoreList);
+            walker.setFilters(filePattern, fileAntiPattern, dirAntiPattern);
+            walker.setFollowDirLinks(bFollowDirLinks);
+
+            m_bSuccess = walker.walk(*mFileAccess, *pDirList);
+            return m_bSuccess;
         }
-        else
-        {
-            for(const QFileInfo& fi: fiList) // for each file...
-            {
-                if(ProgressProxy::wasCancelled())
-                    break;
 
-                assert(fi.fileName() != "." && fi.fileName() != "..");
-
-                FileAccess fa;
-
-                fa.setFile(mFileAccess, fi);
-                pDirList->push_back(fa);
-            }
-        }
+        m_bSuccess = scanLocalDirectory(*mFileAccess, *pDirList, bFindHidden);
     }
     else
     {
@@ -450,7 +455,7 @@ bool DefaultFileAccessJobHandler::listDir(DirectoryList* pDirList, bool bRecursi
     }
 
     ignoreList.enterDir(mFileAccess->absoluteFilePath(), *pDirList);
-    mFileAccess->filterList(mFileAccess->absoluteFilePath(), pDirList, filePattern, fileAntiPattern, dirAntiPattern, ignoreList);
+    mFileAccess->filterList(mFileAccess->absoluteFilePath(), pDirList, FileFilter(filePattern, fileAntiPattern, dirAntiPattern), ignoreList);
 
     if(bRecursive)
     {
@@ -477,6 +482,45 @@ bool DefaultFileAccessJobHandler::listDir(DirectoryList* pDirList, bool bRecursi
     return m_bSuccess;
 }
 
+bool DefaultFileAccessJobHandler::scanLocalDirectory(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden)
+{
+    const std::optional<bool> bNativeSuccess = LocalDirectoryScanner::scan(dirAccess, dirList, bFindHidden);
+    if(bNativeSuccess.has_value())
+        return bNativeSuccess.value();
+
+    QDir dir(dirAccess.absoluteFilePath());
+
+    dir.setSorting(QDir::Name | QDir::DirsFirst);
+    if(bFindHidden)
+        dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    else
+        dir.setFilter(QDir::Files | QDir::Dirs | QDir::System | QDir::NoDotAndDotDot);
+
+    const QFileInfoList fiList = dir.entryInfoList();
+    if(fiList.isEmpty())
+    {
+        /*
+            Sadly Qt provides no error information making this case ambiguous.
+            A readability check is the best we can do.
+        */
+        return dir.isReadable();
+    }
+
+    for(const QFileInfo& fi: fiList) // for each file...
+    {
+        if(ProgressProxy::wasCancelled())
+            break;
+
+        assert(fi.fileName() != "." && fi.fileName() != "..");
+
+        // Built in place, FileAccess is not cheap to copy.
+        FileAccess& fa = dirList.emplace_back();
+        fa.setFile(&dirAccess, fi);
+    }
+
+    return true;
+}
+
 void DefaultFileAccessJobHandler::slotListDirProcessNewEntries(KIO::Job*, const KIO::UDSEntryList& l)
 {
     //This function is called for non-local urls. Don't use QUrl::fromLocalFile here as it does not handle these.
@@ -53,7 +53,11 @@ class DefaultFileAccessJobHandler: public FileAccessJobHandler
     bool mkDirImp(const QString& dirName) override;
     bool rmDirImp(const QString& dirName) override;
 
-    bool scanLocalDirectory(const QString& dirName, DirectoryList* dirList);
+    // Copies without KIO, usable on any thread.
+    bool copyLocalFile(const FileAccess& dest);
+
+    // Lists the immediate entries of a local folder. Thread safe, used by DirectoryWalker.
+    static bool scanLocalDirectory(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden);
 
   private Q_SLOTS:
     void slotJobEnded(KJob*);
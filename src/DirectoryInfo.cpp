@@ -13,8 +13,53 @@
 #include "CvsIgnoreList.h"
 #include "GitIgnoreList.h"
 #include "options.h"
+#include "ProgressProxy.h"
 
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <KLocalizedString>
+
+namespace {
+/*
+    Scans one local folder off the GUI thread.
+    The progress dialog belongs to the GUI thread. Everything the scan reports is muted here, only
+    ProgressProxy::wasCancelled gets through.
+*/
+class DirectoryScanThread: public QThread
+{
+  public:
+    DirectoryScanThread(std::function<bool()> scan, DirectoryList& dirList, bool& bSuccess):
+        m_scan(std::move(scan)), m_dirList(dirList), m_bSuccess(bSuccess)
+    {
+    }
+
+    void run() override
+    {
+        const ProgressMute mute;
+        m_bSuccess = m_scan();
+        /*
+            The job handler of each entry was created on this thread. Hand them to the thread that
+            owns us before exiting, otherwise queued KIO signals would target a dead thread later.
+        */
+        for(FileAccess& fileAccess: m_dirList)
+            fileAccess.moveToThread(thread());
+    }
+
+  private:
+    std::function<bool()> m_scan;
+    DirectoryList& m_dirList;
+    bool& m_bSuccess;
+};
+} // namespace
 
 bool DirectoryInfo::listDirA()
 {
@@ -31,6 +76,61 @@ bool DirectoryInfo::listDirC()
     return listDir(m_dirC, m_dirListC);
 }
 
+void DirectoryInfo::listDirs(bool& bSuccessA, bool& bSuccessB, bool& bSuccessC)
+{
+    assert(QThread::currentThread() == QCoreApplication::instance()->thread());
+
+    const std::array<std::tuple<FileAccess*, DirectoryList*, bool*>, 3> scans = {{{&m_dirA, &m_dirListA, &bSuccessA},
+                                                                                  {&m_dirB, &m_dirListB, &bSuccessB},
+                                                                                  {&m_dirC, &m_dirListC, &bSuccessC}}};
+    std::vector<std::unique_ptr<DirectoryScanThread>> threads;
+    qint32 nofScans = 0;
+    qint32 nofFinished = 0;
+
+    for(const auto& [pDir, pDirList, pSuccess]: scans)
+    {
+        *pSuccess = true;
+        if(!pDir->isValid())
+            continue;
+
+        ++nofScans;
+        if(pDir->isLocal())
+        {
+            FileAccess* pScanDir = pDir;
+            DirectoryList* pScanList = pDirList;
+            threads.push_back(std::make_unique<DirectoryScanThread>([this, pScanDir, pScanList]() { return listDir(*pScanDir, *pScanList); },
+                                                                    *pDirList, *pSuccess));
+            threads.back()->start();
+        }
+    }
+
+    ProgressProxy::setMaxNofSteps(nofScans);
+    // KIO needs the GUI event loop so remote folders are read here while the local scans proceed.
+    for(const auto& [pDir, pDirList, pSuccess]: scans)
+    {
+        if(!pDir->isValid() || pDir->isLocal())
+            continue;
+
+        *pSuccess = listDir(*pDir, *pDirList);
+        ProgressProxy::setCurrent(++nofFinished);
+    }
+
+    while(std::any_of(threads.cbegin(), threads.cend(), [](const std::unique_ptr<DirectoryScanThread>& thread) { return !thread->isFinished(); }))
+    {
+        const qint32 nofRunning = (qint32)std::count_if(threads.cbegin(), threads.cend(),
+                                                        [](const std::unique_ptr<DirectoryScanThread>& thread) { return !thread->isFinished(); });
+        ProgressProxy::setInformation(i18nc("Status message", "Reading folders: %1 of %2 done", nofScans - nofRunning, nofScans), nofScans - nofRunning, false);
+        // Keeps the GUI responsive and lets the user cancel. The scanners poll the same flag.
+        ProgressProxy::wasCancelled();
+        QThread::msleep(20);
+    }
+
+    for(const std::unique_ptr<DirectoryScanThread>& thread: threads)
+        thread->wait();
+
+    ProgressProxy::setCurrent(nofScans);
+}
+
 bool DirectoryInfo::listDir(FileAccess& fileAccess, DirectoryList& dirList)
 {
     CompositeIgnoreList ignoreList;
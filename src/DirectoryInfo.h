@@ -45,6 +45,12 @@ class DirectoryInfo
     bool listDirA();
     bool listDirB();
     bool listDirC();
+    /*
+        Reads all valid folders at once. Local folders are scanned on helper threads while
+        remote folders, which need the KIO event loop, are read on the calling thread.
+        Must be called from the GUI thread.
+    */
+    void listDirs(bool& bSuccessA, bool& bSuccessB, bool& bSuccessC);
     DirectoryList& getDirListA() { return m_dirListA; }
     DirectoryList& getDirListB() { return m_dirListB; }
     DirectoryList& getDirListC() { return m_dirListC; }
@@ -13,6 +13,12 @@
 #include <list>
 
 class FileAccess;
+/*
+    TODO: Compact entries. Scanned entries are still full FileAccess objects, only their file handles,
+    job handlers and path strings are created on demand. Still open is a packed, arena-backed entry with
+    interned names that becomes a FileAccess only when the file is opened, copied or merged. The merge
+    code, the ignore lists and DirectoryWalker's splicing all rely on FileAccess pointers into this list.
+*/
 using DirectoryList =  std::list<FileAccess>;
 
 #endif
@@ -0,0 +1,244 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "DirectoryWalker.h"
+
+#include "fileaccess.h"
+#include "IgnoreList.h"
+#include "ProgressProxy.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QThread>
+
+namespace {
+/*
+    Folders are entered one at a time, see IgnoreList. Matching only reads and runs on all
+    workers at once.
+*/
+class LockedIgnoreList: public IgnoreList
+{
+  public:
+    explicit LockedIgnoreList(IgnoreList& ignoreList): m_ignoreList(ignoreList) {}
+
+    void enterDir(const QString& dir, const DirectoryList& directoryList) override
+    {
+        QWriteLocker locker(&m_lock);
+        m_ignoreList.enterDir(dir, directoryList);
+    }
+
+    [[nodiscard]] bool matches(const QString& dir, const QString& text, bool bCaseSensitive) const override
+    {
+        QReadLocker locker(&m_lock);
+        return m_ignoreList.matches(dir, text, bCaseSensitive);
+    }
+
+  private:
+    IgnoreList& m_ignoreList;
+    mutable QReadWriteLock m_lock;
+};
+} // namespace
+
+struct DirectoryWalker::Task
+{
+    explicit Task(FileAccess* pDir): m_pDir(pDir) {}
+
+    FileAccess* m_pDir;
+    DirectoryList m_entries;
+    // In the order the folders appear in m_entries.
+    std::vector<std::unique_ptr<Task>> m_subTasks;
+    bool m_bSuccess = true;
+};
+
+class DirectoryWalker::TaskQueue
+{
+  public:
+    void push(Task* pTask)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_tasks.push_back(pTask);
+    }
+
+    // The owner works depth first from the back, thieves take the oldest (biggest) folders.
+    Task* pop()
+    {
+        QMutexLocker locker(&m_mutex);
+        if(m_tasks.empty())
+            return nullptr;
+
+        Task* pTask = m_tasks.back();
+        m_tasks.pop_back();
+        return pTask;
+    }
+
+    Task* steal()
+    {
+        QMutexLocker locker(&m_mutex);
+        if(m_tasks.empty())
+            return nullptr;
+
+        Task* pTask = m_tasks.front();
+        m_tasks.pop_front();
+        return pTask;
+    }
+
+  private:
+    QMutex m_mutex;
+    std::deque<Task*> m_tasks;
+};
+
+class DirectoryWalker::Worker: public QThread
+{
+  public:
+    Worker(DirectoryWalker& walker, size_t workerIdx):
+        m_walker(walker), m_workerIdx(workerIdx) {}
+
+    void run() override { m_walker.work(m_workerIdx); }
+
+  private:
+    DirectoryWalker& m_walker;
+    size_t m_workerIdx;
+};
+
+DirectoryWalker::DirectoryWalker(ScanFunction scan, IgnoreList& ignoreList):
+    m_scan(std::move(scan)), m_ignoreList(std::make_unique<LockedIgnoreList>(ignoreList))
+{
+}
+
+DirectoryWalker::~DirectoryWalker() = default;
+
+void DirectoryWalker::setFilters(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern)
+{
+    m_filter = FileFilter(filePattern, fileAntiPattern, dirAntiPattern);
+}
+
+bool DirectoryWalker::walk(FileAccess& root, DirectoryList& dirList)
+{
+    // Folder listing is I/O bound, allow more threads than cores but keep the count sane.
+    const qint32 nofThreads = m_maxThreads > 0 ? m_maxThreads : std::clamp(QThread::idealThreadCount() * 2, 2, 16);
+
+    Task rootTask(&root);
+    m_pTargetThread = QThread::currentThread();
+
+    m_queues.clear();
+    for(qint32 i = 0; i < nofThreads; ++i)
+        m_queues.push_back(std::make_unique<TaskQueue>());
+
+    m_pendingTasks.storeRelease(1);
+    m_queues[0]->push(&rootTask);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for(qint32 i = 0; i < nofThreads; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, (size_t)i));
+        workers.back()->start();
+    }
+
+    for(const std::unique_ptr<Worker>& worker: workers)
+    {
+        // On the GUI thread this keeps the window alive and lets the user cancel.
+        while(!worker->wait(50))
+            ProgressProxy::wasCancelled();
+    }
+
+    m_queues.clear();
+
+    dirList.clear();
+    collect(rootTask, dirList);
+
+    return rootTask.m_bSuccess;
+}
+
+DirectoryWalker::Task* DirectoryWalker::takeTask(size_t workerIdx)
+{
+    Task* pTask = m_queues[workerIdx]->pop();
+    for(size_t i = 1; pTask == nullptr && i < m_queues.size(); ++i)
+        pTask = m_queues[(workerIdx + i) % m_queues.size()]->steal();
+
+    return pTask;
+}
+
+void DirectoryWalker::work(size_t workerIdx)
+{
+    for(;;)
+    {
+        Task* pTask = takeTask(workerIdx);
+        if(pTask == nullptr)
+        {
+            // Looked again under the lock, new tasks and the end of the walk are signalled with it held.
+            QMutexLocker locker(&m_idleMutex);
+            pTask = takeTask(workerIdx);
+            // Someone else is still listing a folder that may produce more work.
+            while(pTask == nullptr && m_pendingTasks.loadAcquire() > 0)
+            {
+                m_workAvailable.wait(&m_idleMutex);
+                pTask = takeTask(workerIdx);
+            }
+            if(pTask == nullptr)
+                return;
+        }
+
+        process(*pTask, workerIdx);
+        if(m_pendingTasks.fetchAndSubOrdered(1) == 1)
+        {
+            QMutexLocker locker(&m_idleMutex);
+            m_workAvailable.wakeAll();
+        }
+    }
+}
+
+void DirectoryWalker::process(Task& task, size_t workerIdx)
+{
+    if(ProgressProxy::wasCancelled())
+        return; // Cancelled is not an error.
+
+    FileAccess& dir = *task.m_pDir;
+    const QString dirPath = dir.absoluteFilePath();
+
+    task.m_bSuccess = m_scan(dir, task.m_entries);
+
+    m_ignoreList->enterDir(dirPath, task.m_entries);
+    dir.filterList(dirPath, &task.m_entries, m_filter, *m_ignoreList);
+
+    for(FileAccess& entry: task.m_entries)
+    {
+        assert(entry.isValid());
+        // The job handlers were created on this worker which exits once the walk is done.
+        entry.moveToThread(m_pTargetThread);
+
+        if(entry.isDir() && (!entry.isSymLink() || m_bFollowDirLinks))
+            task.m_subTasks.push_back(std::make_unique<Task>(&entry));
+    }
+
+    m_pendingTasks.fetchAndAddOrdered((qint64)task.m_subTasks.size());
+    // Pushed in reverse so the owner pops them in listing order.
+    for(auto it = task.m_subTasks.rbegin(); it != task.m_subTasks.rend(); ++it)
+        m_queues[workerIdx]->push(it->get());
+
+    // This worker goes on with the first one, others may steal the rest.
+    if(task.m_subTasks.size() > 1)
+    {
+        QMutexLocker locker(&m_idleMutex);
+        for(size_t i = 1; i < task.m_subTasks.size(); ++i)
+            m_workAvailable.wakeOne();
+    }
+}
+
+void DirectoryWalker::collect(Task& task, DirectoryList& dirList)
+{
+    // Splicing keeps the nodes in place so m_pParent pointers into the lists stay valid.
+    dirList.splice(dirList.end(), task.m_entries);
+    for(const std::unique_ptr<Task>& subTask: task.m_subTasks)
+        collect(*subTask, dirList);
+}
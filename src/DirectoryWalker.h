@@ -0,0 +1,80 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include "DirectoryList.h"
+#include "FileFilter.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+class FileAccess;
+class IgnoreList;
+class QThread;
+
+/*
+    Recursive scan of a local folder tree spread over a pool of worker threads.
+
+    Every folder is a task. A worker pushes the sub-folders it finds onto its own queue and
+    steals from the other queues once that runs dry, or sleeps while there is nothing to steal.
+    Ignore lists and file filters are applied on the workers. The result is independent of scheduling and matches a serial depth-first
+    scan: the entries of a folder followed by the contents of each of its sub-folders in turn.
+
+    KIO needs the GUI event loop, so remote folders must not be walked this way.
+*/
+class DirectoryWalker
+{
+  public:
+    // Lists the immediate entries of dir. Called concurrently from the worker threads.
+    using ScanFunction = std::function<bool(FileAccess& dir, DirectoryList& entries)>;
+
+    DirectoryWalker(ScanFunction scan, IgnoreList& ignoreList);
+    ~DirectoryWalker();
+
+    void setFilters(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern);
+    void setFollowDirLinks(bool bFollowDirLinks) { m_bFollowDirLinks = bFollowDirLinks; }
+    void setMaxThreads(qint32 maxThreads) { m_maxThreads = maxThreads; }
+
+    // Returns false if root itself could not be read. Unreadable sub-folders are skipped as before.
+    bool walk(FileAccess& root, DirectoryList& dirList);
+
+  private:
+    struct Task;
+    class TaskQueue;
+    class Worker;
+
+    void work(size_t workerIdx);
+    void process(Task& task, size_t workerIdx);
+    [[nodiscard]] Task* takeTask(size_t workerIdx);
+    static void collect(Task& task, DirectoryList& dirList);
+
+    ScanFunction m_scan;
+    std::unique_ptr<IgnoreList> m_ignoreList;
+
+    FileFilter m_filter{QStringLiteral("*"), QString(), QString()};
+    bool m_bFollowDirLinks = false;
+    qint32 m_maxThreads = 0;
+
+    std::vector<std::unique_ptr<TaskQueue>> m_queues;
+    QAtomicInteger<qint64> m_pendingTasks = 0;
+    // Idle workers sleep here until a folder is queued or the last one is done.
+    QMutex m_idleMutex;
+    QWaitCondition m_workAvailable;
+    QThread* m_pTargetThread = nullptr;
+};
+
+#endif /* DIRECTORYWALKER_H */
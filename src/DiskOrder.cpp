@@ -0,0 +1,110 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "DiskOrder.h"
+
+#include "compat.h"
+#include "IoWorkerPool.h"
+#include "ProgressProxy.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <QFile>
+
+std::optional<DiskOrder::Position> DiskOrder::of(const QString& localPath)
+{
+#ifndef Q_OS_WIN
+    const int fd = ::open(QFile::encodeName(localPath).constData(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return std::nullopt;
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    Position position;
+    position.m_device = (quint64)st.st_dev;
+    position.m_offset = (quint64)st.st_ino;
+
+#ifdef Q_OS_LINUX
+    // Room for the first extent only. Unlike FileIdentity no FIEMAP_FLAG_SYNC, a guess will do here.
+    quint64 buffer[(sizeof(struct fiemap) + sizeof(struct fiemap_extent)) / sizeof(quint64) + 1] = {};
+    struct fiemap* pMap = reinterpret_cast<struct fiemap*>(buffer);
+    pMap->fm_start = 0;
+    pMap->fm_length = FIEMAP_MAX_OFFSET;
+    pMap->fm_extent_count = 1;
+    // Delayed allocation has no address yet, inline data none of its own.
+    if(S_ISREG(st.st_mode) && ::ioctl(fd, FS_IOC_FIEMAP, pMap) == 0 && pMap->fm_mapped_extents == 1 &&
+       (pMap->fm_extents[0].fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_DATA_INLINE)) == 0)
+    {
+        position.m_bPhysical = true;
+        position.m_offset = pMap->fm_extents[0].fe_physical;
+    }
+#endif
+
+    ::close(fd);
+    return position;
+#else
+    Q_UNUSED(localPath);
+    return std::nullopt;
+#endif
+}
+
+std::optional<std::vector<size_t>> DiskOrder::sorted(const std::vector<File>& files)
+{
+    ProgressScope pp;
+    ProgressProxy::setInformation(i18nc("Status message", "Looking up where the files are on disk"), false);
+    ProgressProxy::setMaxNofSteps(files.size());
+
+    std::vector<std::pair<std::optional<Position>, size_t>> positions;
+    positions.reserve(files.size());
+    IoWorkerPool pool;
+    for(const File& file: files)
+    {
+        positions.emplace_back(std::nullopt, positions.size());
+        if(file.m_localPath.isEmpty())
+            continue;
+
+        // Each job writes its own element only, positions is not resized any more.
+        std::optional<Position>& position = positions.back().first;
+        pool.add(
+            file.m_device.isEmpty() ? QByteArrayList() : QByteArrayList{file.m_device},
+            [&position, path = file.m_localPath]() { position = of(path); },
+            []() {
+                ProgressProxy::step();
+                return !ProgressProxy::wasCancelled();
+            });
+    }
+    if(!pool.run())
+        return std::nullopt;
+
+    std::stable_sort(positions.begin(), positions.end(), [](const auto& left, const auto& right) {
+        return left.first.has_value() && (!right.first.has_value() || *left.first < *right.first);
+    });
+
+    std::vector<size_t> order(positions.size());
+    std::transform(positions.begin(), positions.end(), order.begin(), [](const auto& position) { return position.second; });
+    return order;
+}
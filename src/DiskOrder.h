@@ -0,0 +1,66 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef DISKORDER_H
+#define DISKORDER_H
+
+#include <optional>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+/*
+    Where the data of a local file sits on its device. Reading many files in this order instead of
+    the order of the tree saves rotating disks most of their seeks.
+
+    On Linux this is the physical address of the first extent. Where the file system can't report
+    extents, and for files without any, the inode number stands in for it: file systems tend to
+    place the data of files created together close to each other and to their inodes.
+*/
+class DiskOrder
+{
+  public:
+    struct Position
+    {
+        quint64 m_device = 0;
+        // Physical addresses and inode numbers aren't comparable, each is only sorted among its own kind.
+        bool m_bPhysical = false;
+        quint64 m_offset = 0;
+
+        bool operator<(const Position& other) const
+        {
+            if(m_device != other.m_device)
+                return m_device < other.m_device;
+            if(m_bPhysical != other.m_bPhysical)
+                return m_bPhysical;
+            return m_offset < other.m_offset;
+        }
+    };
+
+    struct File
+    {
+        QString m_localPath; // Empty if the file has no local path, it goes last.
+        QByteArray m_device; // Device for IoWorkerPool::add, may be empty.
+    };
+
+    // Reads in flight per device in disk order. A small batch from one region of the disk, then the heads move on.
+    static constexpr qint32 maxReadsPerDevice = 4;
+
+    // Returns nullopt if the file can't be stat'ed and on Windows.
+    [[nodiscard]] static std::optional<Position> of(const QString& localPath);
+    /*
+        The order to read files in, as indices into files. Files without a known position keep
+        their order and go last. Positions are looked up on an IoWorkerPool with progress, returns
+        nullopt if the user cancels meanwhile.
+    */
+    [[nodiscard]] static std::optional<std::vector<size_t>> sorted(const std::vector<File>& files);
+};
+
+#endif /* DISKORDER_H */
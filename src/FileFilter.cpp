@@ -0,0 +1,51 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "FileFilter.h"
+
+#include <QStringList>
+
+namespace {
+//TODO: Ask os for this information don't hard code it.
+#if defined(Q_OS_WIN)
+constexpr bool bLocalCaseSensitive = false;
+#else
+constexpr bool bLocalCaseSensitive = true;
+#endif
+} // namespace
+
+FileFilter::FileFilter(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern):
+    FileFilter(filePattern, fileAntiPattern, dirAntiPattern, bLocalCaseSensitive)
+{
+}
+
+FileFilter::FileFilter(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern, const bool bCaseSensitive):
+    m_bCaseSensitive(bCaseSensitive),
+    m_filePattern(compile(filePattern, bCaseSensitive)),
+    m_fileAntiPattern(compile(fileAntiPattern, bCaseSensitive)),
+    m_dirAntiPattern(compile(dirAntiPattern, bCaseSensitive))
+{
+}
+
+bool FileFilter::isFileIncluded(const QString& fileName) const
+{
+    return m_filePattern.matches(fileName) && !m_fileAntiPattern.matches(fileName);
+}
+
+bool FileFilter::isDirExcluded(const QString& dirName) const
+{
+    return m_dirAntiPattern.matches(dirName);
+}
+
+GlobMatcher FileFilter::compile(const QString& multiPattern, const bool bCaseSensitive)
+{
+    GlobMatcher matcher(bCaseSensitive);
+    matcher.addPatterns(multiPattern.split(QChar(u';')));
+    return matcher;
+}
@@ -0,0 +1,46 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef FILEFILTER_H
+#define FILEFILTER_H
+
+#include "GlobMatcher.h"
+
+#include <QString>
+
+/*
+    The file pattern, file anti-pattern and folder anti-pattern of a folder comparison,
+    each a ';'-separated list of wildcards.
+
+    Compiled once when the scan starts. A filter is not changed afterwards, so the scan
+    threads can share it without locking.
+*/
+class FileFilter
+{
+  public:
+    // Case sensitive where the local file system is.
+    FileFilter(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern);
+    FileFilter(const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern, bool bCaseSensitive);
+
+    // Matched by the file pattern and not by the file anti-pattern.
+    [[nodiscard]] bool isFileIncluded(const QString& fileName) const;
+    [[nodiscard]] bool isDirExcluded(const QString& dirName) const;
+
+    [[nodiscard]] bool isCaseSensitive() const { return m_bCaseSensitive; }
+
+  private:
+    [[nodiscard]] static GlobMatcher compile(const QString& multiPattern, bool bCaseSensitive);
+
+    bool m_bCaseSensitive;
+    GlobMatcher m_filePattern;
+    GlobMatcher m_fileAntiPattern;
+    GlobMatcher m_dirAntiPattern;
+};
+
+#endif /* FILEFILTER_H */
@@ -0,0 +1,200 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "FileIdentity.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+namespace {
+// bcachefs, not in every linux/magic.h yet.
+constexpr quint32 bcachefsMagic = 0xca451a4e;
+
+struct Extent
+{
+    quint64 m_logical = 0;
+    quint64 m_physical = 0;
+    quint64 m_length = 0;
+
+    bool operator==(const Extent& other) const
+    {
+        return m_logical == other.m_logical && m_physical == other.m_physical && m_length == other.m_length;
+    }
+};
+
+constexpr quint32 extentsPerCall = 256;
+// Heavily fragmented files are cheaper to just read.
+constexpr size_t maxExtents = 16 * 1024;
+
+/*
+    The physical address of these extents doesn't tell what a read returns. Compressed or inline
+    extents may be shared by ranges with different contents, delayed and unwritten ones have no
+    data on disk yet.
+*/
+constexpr quint32 unsafeExtentFlags = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_ENCODED |
+                                      FIEMAP_EXTENT_DATA_ENCRYPTED | FIEMAP_EXTENT_NOT_ALIGNED | FIEMAP_EXTENT_DATA_INLINE |
+                                      FIEMAP_EXTENT_DATA_TAIL | FIEMAP_EXTENT_UNWRITTEN;
+
+class ReadOnlyFile
+{
+  public:
+    explicit ReadOnlyFile(const QString& localPath):
+        m_fd(::open(QFile::encodeName(localPath).constData(), O_RDONLY | O_CLOEXEC)) {}
+    ~ReadOnlyFile()
+    {
+        if(m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    ReadOnlyFile(const ReadOnlyFile&) = delete;
+    ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+
+    [[nodiscard]] int fd() const { return m_fd; }
+
+  private:
+    int m_fd;
+};
+
+/*
+    Only these file systems share extents between files. Elsewhere FIEMAP_FLAG_SYNC would just
+    force a writeback for nothing.
+*/
+bool canShareExtents(int fd)
+{
+    struct statfs fs;
+    if(::fstatfs(fd, &fs) != 0)
+        return false;
+
+    // The magic numbers don't all fit a signed f_type.
+    switch((quint32)fs.f_type)
+    {
+        case BTRFS_SUPER_MAGIC:
+        case XFS_SUPER_MAGIC:
+        case OCFS2_SUPER_MAGIC:
+        case bcachefsMagic:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Only succeeds if every extent is shared and safe to compare by address.
+bool readSharedExtents(int fd, std::vector<Extent>& extents)
+{
+    std::vector<quint64> buffer((sizeof(struct fiemap) + extentsPerCall * sizeof(struct fiemap_extent)) / sizeof(quint64) + 1);
+    quint64 start = 0;
+    for(;;)
+    {
+        std::fill(buffer.begin(), buffer.end(), 0);
+        struct fiemap* pMap = reinterpret_cast<struct fiemap*>(buffer.data());
+        pMap->fm_start = start;
+        pMap->fm_length = FIEMAP_MAX_OFFSET - start;
+        // Write back dirty pages first, otherwise data not yet on disk would be hidden.
+        pMap->fm_flags = FIEMAP_FLAG_SYNC;
+        pMap->fm_extent_count = extentsPerCall;
+
+        if(::ioctl(fd, FS_IOC_FIEMAP, pMap) != 0)
+            return false;
+        if(pMap->fm_mapped_extents == 0)
+            return true;
+
+        for(quint32 i = 0; i < pMap->fm_mapped_extents; ++i)
+        {
+            const struct fiemap_extent& extent = pMap->fm_extents[i];
+            if((extent.fe_flags & unsafeExtentFlags) != 0 || (extent.fe_flags & FIEMAP_EXTENT_SHARED) == 0)
+                return false;
+
+            extents.push_back({extent.fe_logical, extent.fe_physical, extent.fe_length});
+            if(extents.size() > maxExtents)
+                return false;
+
+            if((extent.fe_flags & FIEMAP_EXTENT_LAST) != 0)
+                return true;
+            start = extent.fe_logical + extent.fe_length;
+        }
+    }
+}
+} // namespace
+#endif
+
+FileIdentity::Equality FileIdentity::check(const QString& localPath1, const QString& localPath2)
+{
+    if(isSameFile(localPath1, localPath2))
+        return eSameFile;
+    if(hasSameExtents(localPath1, localPath2))
+        return eSharedExtents;
+
+    return eUnknown;
+}
+
+bool FileIdentity::isSameFile(const QString& localPath1, const QString& localPath2)
+{
+#ifndef Q_OS_WIN
+    struct stat st1;
+    struct stat st2;
+    if(::stat(QFile::encodeName(localPath1).constData(), &st1) != 0 || ::stat(QFile::encodeName(localPath2).constData(), &st2) != 0)
+        return false;
+
+    return S_ISREG(st1.st_mode) && st1.st_dev == st2.st_dev && st1.st_ino == st2.st_ino;
+#else
+    // stat() on Windows has no inode.
+    Q_UNUSED(localPath1);
+    Q_UNUSED(localPath2);
+    return false;
+#endif
+}
+
+bool FileIdentity::hasSameExtents(const QString& localPath1, const QString& localPath2)
+{
+#ifdef Q_OS_LINUX
+    const ReadOnlyFile file1(localPath1);
+    const ReadOnlyFile file2(localPath2);
+    if(file1.fd() < 0 || file2.fd() < 0)
+        return false;
+
+    struct stat st1;
+    struct stat st2;
+    if(::fstat(file1.fd(), &st1) != 0 || ::fstat(file2.fd(), &st2) != 0)
+        return false;
+    // Physical addresses are only comparable within one file system.
+    if(!S_ISREG(st1.st_mode) || !S_ISREG(st2.st_mode) || st1.st_dev != st2.st_dev || st1.st_size != st2.st_size)
+        return false;
+    if(!canShareExtents(file1.fd()))
+        return false;
+
+    std::vector<Extent> extents1;
+    std::vector<Extent> extents2;
+    if(!readSharedExtents(file1.fd(), extents1) || !readSharedExtents(file2.fd(), extents2))
+        return false;
+
+    // Without any extents nothing is shared, leave sparse and empty files to the normal comparison.
+    return !extents1.empty() && extents1 == extents2;
+#else
+    Q_UNUSED(localPath1);
+    Q_UNUSED(localPath2);
+    return false;
+#endif
+}
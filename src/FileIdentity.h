@@ -0,0 +1,47 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef FILEIDENTITY_H
+#define FILEIDENTITY_H
+
+#include <QString>
+
+/*
+    Proves two local files equal from file system metadata alone.
+
+    Hard links, bind mounts and the staging folders of "git difftool --dir-diff" often make both
+    sides of a comparison the same inode. Reflinked copies on btrfs or XFS are different inodes
+    that share all of their data extents. Neither case needs the contents to be read.
+
+    A result of eUnknown only means the files have to be compared the normal way.
+
+    isSameFile() is a stat() of each file. hasSameExtents() flushes dirty data of both files, check
+    anything cheaper first. It only looks at file systems that can share extents at all.
+*/
+class FileIdentity
+{
+  public:
+    enum Equality
+    {
+        eUnknown,
+        eSameFile,     // Same device and inode
+        eSharedExtents // Every extent of the data is shared between both files
+    };
+
+    [[nodiscard]] static Equality check(const QString& localPath1, const QString& localPath2);
+
+    [[nodiscard]] static bool isSameFile(const QString& localPath1, const QString& localPath2);
+    /*
+        Linux only, on btrfs, XFS, OCFS2 and bcachefs. Dirty data is flushed first so pending
+        writes can't hide behind a shared extent.
+    */
+    [[nodiscard]] static bool hasSameExtents(const QString& localPath1, const QString& localPath2);
+};
+
+#endif /* FILEIDENTITY_H */
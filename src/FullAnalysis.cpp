@@ -0,0 +1,215 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "FullAnalysis.h"
+
+#include "diff.h"
+#include "Logging.h"
+#include "MergeEditLine.h"
+#include "options.h"
+#include "ProgressProxy.h"
+#include "SourceData.h"
+
+#include <exception>
+#include <memory>
+#include <new>
+
+#include <QDataStream>
+
+#include <KLocalizedString>
+
+namespace {
+void diffTwoFiles(const std::shared_ptr<SourceData>& sdA, const std::shared_ptr<SourceData>& sdB, const IgnoreFlags eIgnoreFlags,
+                  DiffList& diffList12, Diff3LineList& diff3LineList, TotalDiffStatus& totalDiffStatus)
+{
+    totalDiffStatus.setBinaryEqualAB(sdA->isBinaryEqualWith(sdB));
+    if(!sdA->isText() || !sdB->isText())
+        return;
+
+    ManualDiffHelpList manualDiffHelpList;
+    manualDiffHelpList.runDiff(sdA->getLineDataForDiff(), sdA->lineCount(), sdB->getLineDataForDiff(), sdB->lineCount(), diffList12, e_SrcSelector::A, e_SrcSelector::B);
+    diff3LineList.calcDiff3LineListUsingAB(&diffList12);
+
+    totalDiffStatus.setTextEqualAB(diff3LineList.fineDiff(e_SrcSelector::A, sdA->getLineDataForDisplay(), sdB->getLineDataForDisplay(), eIgnoreFlags));
+    if(sdA->getSizeBytes() == 0)
+        totalDiffStatus.setTextEqualAB(false);
+}
+
+void diffThreeFiles(const std::shared_ptr<SourceData>& sdA, const std::shared_ptr<SourceData>& sdB, const std::shared_ptr<SourceData>& sdC,
+                    const IgnoreFlags eIgnoreFlags, DiffList& diffList12, DiffList& diffList13, DiffList& diffList23,
+                    Diff3LineList& diff3LineList, TotalDiffStatus& totalDiffStatus)
+{
+    totalDiffStatus.setBinaryEqualAB(sdA->isBinaryEqualWith(sdB));
+    totalDiffStatus.setBinaryEqualAC(sdA->isBinaryEqualWith(sdC));
+    totalDiffStatus.setBinaryEqualBC(sdC->isBinaryEqualWith(sdB));
+
+    ManualDiffHelpList manualDiffHelpList;
+
+    if(sdA->isText() && sdB->isText())
+    {
+        manualDiffHelpList.runDiff(sdA->getLineDataForDiff(), sdA->lineCount(), sdB->getLineDataForDiff(), sdB->lineCount(), diffList12, e_SrcSelector::A, e_SrcSelector::B);
+        diff3LineList.calcDiff3LineListUsingAB(&diffList12);
+    }
+
+    if(sdA->isText() && sdC->isText())
+    {
+        manualDiffHelpList.runDiff(sdA->getLineDataForDiff(), sdA->lineCount(), sdC->getLineDataForDiff(), sdC->lineCount(), diffList13, e_SrcSelector::A, e_SrcSelector::C);
+        diff3LineList.calcDiff3LineListUsingAC(&diffList13);
+        diff3LineList.correctManualDiffAlignment(&manualDiffHelpList);
+        diff3LineList.calcDiff3LineListTrim(sdA->getLineDataForDiff(), sdB->getLineDataForDiff(), sdC->getLineDataForDiff(), &manualDiffHelpList);
+    }
+
+    if(sdB->isText() && sdC->isText())
+    {
+        manualDiffHelpList.runDiff(sdB->getLineDataForDiff(), sdB->lineCount(), sdC->getLineDataForDiff(), sdC->lineCount(), diffList23, e_SrcSelector::B, e_SrcSelector::C);
+        if(gOptions->m_bDiff3AlignBC)
+        {
+            diff3LineList.calcDiff3LineListUsingBC(&diffList23);
+            diff3LineList.correctManualDiffAlignment(&manualDiffHelpList);
+            diff3LineList.calcDiff3LineListTrim(sdA->getLineDataForDiff(), sdB->getLineDataForDiff(), sdC->getLineDataForDiff(), &manualDiffHelpList);
+        }
+    }
+
+    if(sdA->hasData() && sdB->hasData() && sdA->isText() && sdB->isText())
+        totalDiffStatus.setTextEqualAB(diff3LineList.fineDiff(e_SrcSelector::A, sdA->getLineDataForDisplay(), sdB->getLineDataForDisplay(), eIgnoreFlags));
+    if(sdB->hasData() && sdC->hasData() && sdB->isText() && sdC->isText())
+        totalDiffStatus.setTextEqualBC(diff3LineList.fineDiff(e_SrcSelector::B, sdB->getLineDataForDisplay(), sdC->getLineDataForDisplay(), eIgnoreFlags));
+    if(sdA->hasData() && sdC->hasData() && sdA->isText() && sdC->isText())
+        totalDiffStatus.setTextEqualAC(diff3LineList.fineDiff(e_SrcSelector::C, sdC->getLineDataForDisplay(), sdA->getLineDataForDisplay(), eIgnoreFlags));
+
+    if(sdA->getSizeBytes() == 0)
+    {
+        totalDiffStatus.setTextEqualAB(false);
+        totalDiffStatus.setTextEqualAC(false);
+    }
+    if(sdB->getSizeBytes() == 0)
+    {
+        totalDiffStatus.setTextEqualAB(false);
+        totalDiffStatus.setTextEqualBC(false);
+    }
+}
+
+// What MergeResultWindow::merge counts after an automatic merge.
+void countConflicts(const Diff3LineList& diff3LineList, const bool bThreeWay, TotalDiffStatus& totalDiffStatus)
+{
+    MergeBlockList mergeBlockList;
+    mergeBlockList.buildFromDiff3(diff3LineList, bThreeWay);
+
+    const qint32 whiteSpaceDefault = bThreeWay ? gOptions->m_whiteSpace3FileMergeDefault : gOptions->m_whiteSpace2FileMergeDefault;
+    if(whiteSpaceDefault != (qint32)e_SrcSelector::None)
+    {
+        assert(whiteSpaceDefault <= (qint32)e_SrcSelector::Max && whiteSpaceDefault >= (qint32)e_SrcSelector::Min);
+        mergeBlockList.updateDefaults((e_SrcSelector)whiteSpaceDefault, false, true);
+    }
+
+    for(MergeBlock& mb: mergeBlockList)
+        mb.removeEmptySource();
+
+    mergeBlockList.countConflicts(totalDiffStatus);
+}
+} // namespace
+
+bool FullAnalysis::isSupported()
+{
+    /*
+        A failing preprocessor clears its option, that can't happen from several threads at once.
+        The automatic merges at merge start are implemented by the merge result window.
+    */
+    return gOptions->m_PreProcessorCmd.isEmpty() && gOptions->m_LineMatchingPreProcessorCmd.isEmpty() &&
+           !gOptions->m_bRunHistoryAutoMergeOnMergeStart && !gOptions->m_bRunRegExpAutoMergeOnMergeStart;
+}
+
+QByteArray FullAnalysis::optionsKey()
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << gOptions->mEncodingA << gOptions->mAutoDetectA << gOptions->mEncodingB << gOptions->mAutoDetectB
+           << gOptions->mEncodingC << gOptions->mAutoDetectC << gOptions->mEncodingPP
+           << gOptions->m_PreProcessorCmd << gOptions->m_LineMatchingPreProcessorCmd
+           << gOptions->ignoreComments() << gOptions->whiteSpaceIsEqual() << gOptions->m_bIgnoreCase
+           << gOptions->m_bIgnoreNumbers << gOptions->m_bTryHard << gOptions->m_bDiff3AlignBC;
+    return key;
+}
+
+std::unique_ptr<FullAnalysis::Comparison> FullAnalysis::compare(const QString& fileA, const QString& fileB, const QString& fileC)
+{
+    // The diff code reports its progress for the GUI thread.
+    const ProgressMute mute;
+
+    IgnoreFlags eIgnoreFlags = IgnoreFlag::none;
+    if(gOptions->ignoreComments())
+        eIgnoreFlags |= IgnoreFlag::ignoreComments;
+    if(gOptions->whiteSpaceIsEqual())
+        eIgnoreFlags |= IgnoreFlag::ignoreWhiteSpace;
+
+    std::unique_ptr<Comparison> pComparison = std::make_unique<Comparison>();
+    const std::shared_ptr<SourceData> sdA = pComparison->m_sdA = std::make_shared<SourceData>();
+    const std::shared_ptr<SourceData> sdB = pComparison->m_sdB = std::make_shared<SourceData>();
+    const std::shared_ptr<SourceData> sdC = pComparison->m_sdC = std::make_shared<SourceData>();
+    sdA->setFilename(fileA);
+    sdB->setFilename(fileB);
+    sdC->setFilename(fileC);
+
+    sdA->readAndPreprocess(gOptions->mEncodingA, gOptions->mAutoDetectA);
+    sdB->readAndPreprocess(gOptions->mEncodingB, gOptions->mAutoDetectB);
+
+    QStringList& fileErrors = pComparison->m_errors;
+    fileErrors = sdA->getErrors();
+    fileErrors.append(sdB->getErrors());
+
+    TotalDiffStatus& totalDiffStatus = pComparison->m_totalDiffStatus;
+    Diff3LineList& diff3LineList = pComparison->m_diff3LineList;
+    if(fileErrors.isEmpty())
+    {
+        try
+        {
+            if(sdC->isEmpty())
+                diffTwoFiles(sdA, sdB, eIgnoreFlags, pComparison->m_diffList12, diff3LineList, totalDiffStatus);
+            else
+            {
+                sdC->readAndPreprocess(gOptions->mEncodingC, gOptions->mAutoDetectC);
+                diffThreeFiles(sdA, sdB, sdC, eIgnoreFlags, pComparison->m_diffList12, pComparison->m_diffList13, pComparison->m_diffList23,
+                               diff3LineList, totalDiffStatus);
+                fileErrors.append(sdC->getErrors());
+            }
+        }
+        catch(const std::bad_alloc&)
+        {
+            diff3LineList.clear();
+            fileErrors.append(i18nc("Error message", "Not enough memory to complete request."));
+        }
+        catch(const std::exception& e)
+        {
+            qCCritical(kdiffMain) << "An internal error occurred:" << e.what();
+            diff3LineList.clear();
+            fileErrors.append(i18n("An internal error occurred: %1", QString::fromStdString(e.what())));
+        }
+    }
+
+    return pComparison;
+}
+
+void FullAnalysis::run(const QString& fileA, const QString& fileB, const QString& fileC,
+                       TotalDiffStatus& totalDiffStatus, QStringList& errors)
+{
+    const ProgressMute mute;
+
+    const std::unique_ptr<Comparison> pComparison = compare(fileA, fileB, fileC);
+    const std::shared_ptr<SourceData>& sdA = pComparison->m_sdA;
+    const std::shared_ptr<SourceData>& sdB = pComparison->m_sdB;
+    const std::shared_ptr<SourceData>& sdC = pComparison->m_sdC;
+    Diff3LineList& diff3LineList = pComparison->m_diff3LineList;
+
+    if(pComparison->m_errors.isEmpty() && sdA->isText() && sdB->isText())
+        diff3LineList.calcWhiteDiff3Lines(sdA->getLineDataForDiff(), sdB->getLineDataForDiff(), sdC->getLineDataForDiff(), gOptions->ignoreComments());
+
+    totalDiffStatus = pComparison->m_totalDiffStatus;
+    countConflicts(diff3LineList, !sdC->isEmpty(), totalDiffStatus);
+    errors.append(pComparison->m_errors);
+}
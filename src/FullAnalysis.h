@@ -0,0 +1,60 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef FULLANALYSIS_H
+#define FULLANALYSIS_H
+
+#include "diff.h"
+
+#include <memory>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class SourceData;
+
+/*
+    The full analysis of a folder comparison without the GUI.
+
+    Loads the files, diffs them and counts the conflicts of an automatic merge, the same way
+    KDiff3App::mainInit does for the merge result window. No widgets or dialogs are involved,
+    so several files can be analysed at once on worker threads. Only local files are supported.
+*/
+class FullAnalysis
+{
+  public:
+    // The files loaded and diffed, what KDiff3App::mainInit computes before it shows them.
+    struct Comparison
+    {
+        std::shared_ptr<SourceData> m_sdA;
+        std::shared_ptr<SourceData> m_sdB;
+        std::shared_ptr<SourceData> m_sdC;
+        DiffList m_diffList12;
+        DiffList m_diffList13;
+        DiffList m_diffList23;
+        Diff3LineList m_diff3LineList;
+        TotalDiffStatus m_totalDiffStatus;
+        QStringList m_errors;
+    };
+
+    // False if the current options need the GUI, see KDiff3App::mainInit then.
+    [[nodiscard]] static bool isSupported();
+    // The current values of the options compare() depends on. A result only holds while they stay the same.
+    [[nodiscard]] static QByteArray optionsKey();
+
+    // Pass an empty name for a missing file. The conflicts aren't counted yet.
+    [[nodiscard]] static std::unique_ptr<Comparison> compare(const QString& fileA, const QString& fileB, const QString& fileC);
+
+    // Pass an empty name for a missing file. Problems are appended to errors.
+    static void run(const QString& fileA, const QString& fileB, const QString& fileC,
+                    TotalDiffStatus& totalDiffStatus, QStringList& errors);
+};
+
+#endif /* FULLANALYSIS_H */
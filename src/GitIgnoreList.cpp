@@ -17,6 +17,7 @@
 #include <utility>
 
 #include <QFile>
+#include <QRegularExpression>
 #include <QStringList>
 #include <QTextStream>
 
@@ -42,44 +43,60 @@ void GitIgnoreList::enterDir(const QString& dir, const DirectoryList& directoryL
     {
         addEntries(dir, readFile(directoryListIt->absoluteFilePath()));
     }
+    m_dirScopes[dir] = scopesOf(dir);
 }
 
 bool GitIgnoreList::matches(const QString& dir, const QString& text, bool bCaseSensitive) const
 {
-    /*
-        Unknown compiler/library bug is triggering a warning from valgring about an unitialized with no useful stack trace.
-        Isolated to:
-            for(auto& dirPattern: m_patterns).
-
-            gcc14, clang18 tested. valgrind-3.24.0, distro arch linux.
-    */
-    for(auto& dirPattern: m_patterns)
+    const auto dirScopesIt = m_dirScopes.find(dir);
+    if(dirScopesIt != m_dirScopes.end())
+        return matches(dirScopesIt->second, text, bCaseSensitive);
+
+    // Folders that were never entered are looked up each time.
+    return matches(scopesOf(dir), text, bCaseSensitive);
+}
+
+bool GitIgnoreList::matches(const std::vector<const Scope*>& scopes, const QString& text, bool bCaseSensitive)
+{
+    for(const Scope* pScope: scopes)
     {
-        if(!dir.startsWith(dirPattern.first))
+        if(pScope->matcher(bCaseSensitive).matches(text))
         {
-            continue;
-        }
-        for(QRegularExpression& pattern: dirPattern.second)
-        {
-            if(!bCaseSensitive)
-            {
-                pattern.setPatternOptions(QRegularExpression::CaseInsensitiveOption | QRegularExpression::UseUnicodePropertiesOption);
-            }
-            else
-            {
-                pattern.setPatternOptions(QRegularExpression::UseUnicodePropertiesOption);
-            }
-            const QRegularExpressionMatch match = pattern.match(text);
-            if(match.hasMatch())
-            {
-                qCDebug(kdiffGitIgnoreList) << "Matched entry" << text;
-                return true;
-            }
+            qCDebug(kdiffGitIgnoreList) << "Matched entry" << text;
+            return true;
         }
     }
     return false;
 }
 
+/*
+    The patterns of a folder apply to its subfolders as well. Rather than testing every folder
+    with a .gitignore, look up the folder itself and each of its parents. A plain prefix test
+    would apply the patterns of "dir" to "dir2" as well.
+*/
+std::vector<const GitIgnoreList::Scope*> GitIgnoreList::scopesOf(const QString& dir) const
+{
+    std::vector<const Scope*> scopes;
+    const auto addScope = [this, &scopes](const QString& scopeDir) {
+        const auto scopeIt = m_scopes.find(scopeDir);
+        if(scopeIt != m_scopes.end())
+            scopes.push_back(&scopeIt->second);
+    };
+
+    addScope(dir);
+    qsizetype pos = dir.lastIndexOf(u'/');
+    while(pos >= 0)
+    {
+        // Folders may be known with a trailing '/', the root always is.
+        if(pos + 1 < dir.size())
+            addScope(dir.left(pos + 1));
+        if(pos > 0)
+            addScope(dir.left(pos));
+        pos = pos > 0 ? dir.lastIndexOf(u'/', pos - 1) : -1;
+    }
+    return scopes;
+}
+
 QString GitIgnoreList::readFile(const QString& fileName) const
 {
     QFile file(fileName);
@@ -95,19 +112,32 @@ void GitIgnoreList::addEntries(const QString& dir, const QString& lines)
 {
     static const QRegularExpression newLineReg = QRegularExpression("[\r\n]");
     const QStringList lineList = lines.split(newLineReg, Qt::SkipEmptyParts);
+    const bool bNewScope = m_scopes.find(dir) == m_scopes.end();
+    Scope* pScope = nullptr;
     for(const QString& line: lineList)
     {
         if(isComment(line))
         {
             continue;
         }
-        QRegularExpression expression(QRegularExpression::wildcardToRegularExpression(line));
-        if(!expression.isValid())
-        {
-            qCDebug(kdiffGitIgnoreList) << "Expression" << line << "is not valid - skipping ...";
-            continue;
-        }
         qCDebug(kdiffGitIgnoreList) << "Adding entry [" << dir << "]" << line;
-        m_patterns[dir].push_back(expression);
+        pScope = &m_scopes[dir];
+        pScope->m_patterns.append(line);
     }
+    if(pScope == nullptr)
+        return;
+
+    pScope->m_pCaseSensitiveMatcher = std::make_unique<GlobMatcher>(true);
+    pScope->m_pCaseSensitiveMatcher->addPatterns(pScope->m_patterns);
+    pScope->m_pCaseInsensitiveMatcher = std::make_unique<GlobMatcher>(false);
+    pScope->m_pCaseInsensitiveMatcher->addPatterns(pScope->m_patterns);
+
+    // A new scope may be a parent of folders entered before.
+    if(bNewScope)
+        m_dirScopes.clear();
+}
+
+const GlobMatcher& GitIgnoreList::Scope::matcher(bool bCaseSensitive) const
+{
+    return bCaseSensitive ? *m_pCaseSensitiveMatcher : *m_pCaseInsensitiveMatcher;
 }
@@ -11,12 +11,14 @@
 #ifndef GIT_IGNORE_LIST_H
 #define GIT_IGNORE_LIST_H
 
+#include "GlobMatcher.h"
 #include "IgnoreList.h"
 
-#include <QRegularExpression>
 #include <QString>
+#include <QStringList>
 
-#include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 class GitIgnoreList : public IgnoreList
@@ -28,11 +30,29 @@ class GitIgnoreList : public IgnoreList
     [[nodiscard]] bool matches(const QString& dir, const QString& text, bool bCaseSensitive) const override;
 
   private:
+    // The patterns of one .gitignore, compiled for each case sensitivity whenever they change.
+    struct Scope
+    {
+        QStringList m_patterns;
+        std::unique_ptr<GlobMatcher> m_pCaseSensitiveMatcher;
+        std::unique_ptr<GlobMatcher> m_pCaseInsensitiveMatcher;
+
+        [[nodiscard]] const GlobMatcher& matcher(bool bCaseSensitive) const;
+    };
+
     [[nodiscard]] virtual QString readFile(const QString& fileName) const;
     void addEntries(const QString& dir, const QString& lines);
+    // The scopes of dir and its parent folders.
+    [[nodiscard]] std::vector<const Scope*> scopesOf(const QString& dir) const;
+    [[nodiscard]] static bool matches(const std::vector<const Scope*>& scopes, const QString& text, bool bCaseSensitive);
 
   private:
-    mutable std::map<QString, std::vector<QRegularExpression>> m_patterns;
+    std::unordered_map<QString, Scope> m_scopes;
+    /*
+        The scopes of each entered folder, looked up once per folder. Filled in by enterDir() only,
+        so matches() changes nothing and may run on several threads.
+    */
+    std::unordered_map<QString, std::vector<const Scope*>> m_dirScopes;
 };
 
 #endif
@@ -0,0 +1,232 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "GlobMatcher.h"
+
+namespace {
+
+bool isMetaCharacter(const QChar c)
+{
+    return c == u'*' || c == u'?' || c == u'[';
+}
+
+/*
+    Matches c against the set starting after the '[' at pos. On success pos is moved past the
+    closing ']'. Returns false if the set is not closed, the '[' is a plain character then.
+*/
+bool matchSet(const QStringView glob, qsizetype& pos, const QChar c, bool& bMatched)
+{
+    qsizetype i = pos;
+    const bool bNegated = i < glob.size() && (glob[i] == u'!' || glob[i] == u'^');
+    if(bNegated)
+        ++i;
+
+    // A ']' right after the opening bracket belongs to the set.
+    const qsizetype first = i;
+    bool bFound = false;
+    for(; i < glob.size(); ++i)
+    {
+        if(glob[i] == u']' && i > first)
+        {
+            pos = i + 1;
+            bMatched = bFound != bNegated;
+            return true;
+        }
+
+        if(i + 2 < glob.size() && glob[i + 1] == u'-' && glob[i + 2] != u']')
+        {
+            bFound = bFound || (glob[i] <= c && c <= glob[i + 2]);
+            i += 2;
+        }
+        else
+            bFound = bFound || glob[i] == c;
+    }
+
+    return false;
+}
+
+} // namespace
+
+GlobMatcher::GlobMatcher(const bool bCaseSensitive):
+    m_bCaseSensitive(bCaseSensitive)
+{
+}
+
+void GlobMatcher::addPattern(const QString& pattern)
+{
+    qsizetype nofMetaCharacters = 0;
+    for(const QChar c: pattern)
+    {
+        if(isMetaCharacter(c))
+            ++nofMetaCharacters;
+    }
+
+    if(nofMetaCharacters == 0)
+        addName(pattern);
+    else if(nofMetaCharacters == 1 && pattern.startsWith(u'*'))
+        addSuffix(pattern.mid(1));
+    else if(nofMetaCharacters == 1 && pattern.endsWith(u'*'))
+        addPrefix(pattern.left(pattern.size() - 1));
+    else
+        addGlob(pattern);
+}
+
+void GlobMatcher::addPatterns(const QStringList& patterns)
+{
+    for(const QString& pattern: patterns)
+        addPattern(pattern);
+}
+
+void GlobMatcher::addName(const QString& name)
+{
+    m_names.insert(fold(name));
+}
+
+void GlobMatcher::addPrefix(const QString& prefix)
+{
+    addAffix(m_prefixes, fold(prefix));
+}
+
+void GlobMatcher::addSuffix(const QString& suffix)
+{
+    addAffix(m_suffixes, fold(suffix));
+}
+
+void GlobMatcher::addGlob(const QString& glob)
+{
+    const QString folded = fold(glob);
+    const QChar last = folded.isEmpty() ? QChar(u'*') : folded.back();
+    if(last == u'*' || last == u'?' || last == u']')
+        m_otherGlobs.push_back(folded);
+    else
+        m_globsByLastChar[last].push_back(folded);
+}
+
+bool GlobMatcher::isEmpty() const
+{
+    return m_names.isEmpty() && m_prefixes.empty() && m_suffixes.empty() && m_globsByLastChar.isEmpty() && m_otherGlobs.empty();
+}
+
+bool GlobMatcher::matches(const QString& name) const
+{
+    const QString folded = fold(name);
+    if(m_names.contains(folded))
+        return true;
+
+    const QStringView view(folded);
+    for(const auto& [length, prefixes]: m_prefixes)
+    {
+        if(length > view.size())
+            break;
+        if(containsAffix(prefixes, view.first(length)))
+            return true;
+    }
+
+    for(const auto& [length, suffixes]: m_suffixes)
+    {
+        if(length > view.size())
+            break;
+        if(containsAffix(suffixes, view.last(length)))
+            return true;
+    }
+
+    if(!view.isEmpty())
+    {
+        const auto globsIt = m_globsByLastChar.constFind(view.back());
+        if(globsIt != m_globsByLastChar.constEnd())
+        {
+            for(const QString& glob: *globsIt)
+            {
+                if(globMatch(glob, view))
+                    return true;
+            }
+        }
+    }
+
+    for(const QString& glob: m_otherGlobs)
+    {
+        if(globMatch(glob, view))
+            return true;
+    }
+
+    return false;
+}
+
+bool GlobMatcher::globMatch(const QStringView glob, const QStringView name)
+{
+    qsizetype g = 0;
+    qsizetype n = 0;
+    // Where to continue after a mismatch: the pattern behind the last '*' and the name position it took over.
+    qsizetype starG = -1;
+    qsizetype starN = 0;
+
+    while(n < name.size())
+    {
+        if(g < glob.size())
+        {
+            const QChar c = glob[g];
+            if(c == u'*')
+            {
+                starG = ++g;
+                starN = n;
+                continue;
+            }
+
+            qsizetype next = g + 1;
+            bool bMatched = false;
+            if(c == u'?')
+                bMatched = true;
+            else if(c != u'[' || !matchSet(glob, next, name[n], bMatched))
+                bMatched = c == name[n];
+
+            if(bMatched)
+            {
+                g = next;
+                ++n;
+                continue;
+            }
+        }
+
+        if(starG < 0)
+            return false;
+
+        // Let the last '*' take one more character.
+        g = starG;
+        n = ++starN;
+    }
+
+    while(g < glob.size() && glob[g] == u'*')
+        ++g;
+
+    return g == glob.size();
+}
+
+QString GlobMatcher::fold(const QString& text) const
+{
+    return m_bCaseSensitive ? text : text.toCaseFolded();
+}
+
+void GlobMatcher::addAffix(std::map<qsizetype, Affixes>& affixes, const QString& affix)
+{
+    Affixes& sameLength = affixes[affix.size()];
+    if(!containsAffix(sameLength, affix))
+        sameLength.insert(qHash(QStringView(affix)), affix);
+}
+
+bool GlobMatcher::containsAffix(const Affixes& affixes, const QStringView text)
+{
+    const size_t hash = qHash(text);
+    for(auto it = affixes.constFind(hash); it != affixes.constEnd() && it.key() == hash; ++it)
+    {
+        if(it.value() == text)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,73 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef GLOBMATCHER_H
+#define GLOBMATCHER_H
+
+#include <map>
+#include <vector>
+
+#include <QChar>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/*
+    A set of wildcard patterns compiled once for matching many file names.
+
+    The syntax is that of QRegularExpression::wildcardToRegularExpression: '*', '?' and
+    character sets like "[a-z]" or "[!0-9]". A '[' without a closing ']' is taken literally.
+
+    Plain names are found with one hash lookup. "prefix*" and "*suffix" patterns are hashed by
+    length, so a name is only looked up once for each distinct prefix or suffix length. The
+    remaining patterns are matched without regular expressions and grouped by their last
+    character, a name only tries those ending in its own last character.
+*/
+class GlobMatcher
+{
+  public:
+    explicit GlobMatcher(bool bCaseSensitive = true);
+
+    // Sorts the pattern into one of the groups below.
+    void addPattern(const QString& pattern);
+    void addPatterns(const QStringList& patterns);
+
+    // For callers that already know the kind of their pattern.
+    void addName(const QString& name);
+    void addPrefix(const QString& prefix);
+    void addSuffix(const QString& suffix);
+    void addGlob(const QString& glob);
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] bool matches(const QString& name) const;
+
+    // Matches one pattern against the whole name, case sensitive.
+    [[nodiscard]] static bool globMatch(QStringView glob, QStringView name);
+
+  private:
+    // Strings of the same length, looked up by views of a longer name without copying.
+    using Affixes = QMultiHash<size_t, QString>;
+
+    [[nodiscard]] QString fold(const QString& text) const;
+    static void addAffix(std::map<qsizetype, Affixes>& affixes, const QString& affix);
+    [[nodiscard]] static bool containsAffix(const Affixes& affixes, QStringView text);
+
+    bool m_bCaseSensitive;
+    QSet<QString> m_names;
+    std::map<qsizetype, Affixes> m_prefixes;
+    std::map<qsizetype, Affixes> m_suffixes;
+    QHash<QChar, std::vector<QString>> m_globsByLastChar;
+    // Patterns ending in '*', '?' or a character set.
+    std::vector<QString> m_otherGlobs;
+};
+
+#endif /* GLOBMATCHER_H */
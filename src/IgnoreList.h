@@ -19,6 +19,10 @@
 
 #include <QString>
 
+/*
+    enterDir() is called for a folder before its entries are matched. It must not run concurrently
+    with anything else, matches() may run on several threads at once.
+*/
 class IgnoreList
 {
 public:
@@ -0,0 +1,298 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "IoWorkerPool.h"
+
+#include "ProgressProxy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <utility>
+
+#include <QMutexLocker>
+#include <QThread>
+
+struct IoWorkerPool::Task
+{
+    std::vector<size_t> m_devices;
+    Job m_job;
+    DoneFunction m_done;
+    // Jobs waiting for this one.
+    std::vector<Task*> m_dependents;
+    // Guarded by m_mutex
+    size_t m_nofPrerequisites = 0;
+    bool m_bQueued = false;
+    bool m_bUrgent = false;
+    // Only used by the thread that called start()
+    bool m_bDone = false;
+};
+
+class IoWorkerPool::Worker: public QThread
+{
+  public:
+    explicit Worker(IoWorkerPool& pool): m_pool(pool) {}
+
+    void run() override { m_pool.work(); }
+
+  private:
+    IoWorkerPool& m_pool;
+};
+
+IoWorkerPool::IoWorkerPool() = default;
+
+IoWorkerPool::~IoWorkerPool()
+{
+    stop();
+}
+
+size_t IoWorkerPool::add(const QByteArrayList& devices, Job job, DoneFunction done, const std::vector<size_t>& prerequisites)
+{
+    assert(m_workers.empty());
+
+    Task& task = m_tasks.emplace_back();
+    for(const size_t prerequisite: prerequisites)
+    {
+        assert(prerequisite < m_tasks.size() - 1);
+        m_tasks[prerequisite].m_dependents.push_back(&task);
+        ++task.m_nofPrerequisites;
+    }
+    for(const QByteArray& device: devices)
+    {
+        const size_t deviceId = m_deviceIds.emplace(device, m_deviceIds.size()).first->second;
+        if(std::find(task.m_devices.begin(), task.m_devices.end(), deviceId) == task.m_devices.end())
+            task.m_devices.push_back(deviceId);
+    }
+    task.m_job = std::move(job);
+    task.m_done = std::move(done);
+    return m_tasks.size() - 1;
+}
+
+size_t IoWorkerPool::count() const
+{
+    return m_tasks.size();
+}
+
+bool IoWorkerPool::run()
+{
+    start();
+    while(processDone(50))
+    {
+        // On the GUI thread this keeps the window alive and lets the user cancel.
+        if(ProgressProxy::wasCancelled())
+            m_bStopped = true;
+    }
+
+    const bool bContinue = !m_bStopped;
+    stop();
+    m_tasks.clear();
+    m_deviceIds.clear();
+    return bContinue;
+}
+
+void IoWorkerPool::start()
+{
+    assert(m_workers.empty());
+    m_nofDone = 0;
+    m_bStopped = false;
+    if(m_tasks.empty())
+        return;
+
+    // Blocking reads leave the cores idle, allow more threads than cores but keep the count sane.
+    const qint32 nofThreads = (qint32)std::min<qint64>(m_maxThreads > 0 ? m_maxThreads : std::clamp(QThread::idealThreadCount() * 2, 2, 16), (qint64)m_tasks.size());
+
+    m_pending.clear();
+    m_urgent.clear();
+    m_done.clear();
+    for(Task& task: m_tasks)
+    {
+        if(task.m_nofPrerequisites > 0)
+            continue;
+        task.m_bQueued = true;
+        m_pending.push_back(&task);
+    }
+    m_deviceLoad.assign(m_deviceIds.size(), 0);
+    m_nofRunning = 0;
+    m_bStop = false;
+
+    for(qint32 i = 0; i < nofThreads; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>(*this));
+        m_workers.back()->start();
+    }
+}
+
+bool IoWorkerPool::processDone(qint32 timeoutMs)
+{
+    if(m_bStopped || m_nofDone == m_tasks.size())
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    if(m_done.empty() && timeoutMs > 0)
+        m_taskDone.wait(&m_mutex, timeoutMs);
+
+    std::deque<Task*> done;
+    done.swap(m_done);
+    locker.unlock();
+
+    for(Task* pTask: done)
+    {
+        ++m_nofDone;
+        pTask->m_bDone = true;
+        if(!m_bStopped && pTask->m_done)
+            m_bStopped = !pTask->m_done();
+    }
+
+    if(m_bStopped)
+    {
+        locker.relock();
+        m_bStop = true;
+        m_pending.clear();
+        m_urgent.clear();
+        m_workAvailable.wakeAll();
+        return false;
+    }
+
+    return m_nofDone < m_tasks.size();
+}
+
+void IoWorkerPool::prioritize(size_t jobId)
+{
+    assert(jobId < m_tasks.size());
+    Task& task = m_tasks[jobId];
+
+    QMutexLocker locker(&m_mutex);
+    if(!task.m_bQueued || task.m_bUrgent)
+        return;
+
+    // The entry in m_pending is skipped once the task was taken from here.
+    task.m_bUrgent = true;
+    m_urgent.push_back(&task);
+    m_workAvailable.wakeOne();
+}
+
+bool IoWorkerPool::isDone(size_t jobId) const
+{
+    assert(jobId < m_tasks.size());
+    return m_tasks[jobId].m_bDone;
+}
+
+bool IoWorkerPool::waitFor(const std::vector<size_t>& jobIds)
+{
+    for(size_t jobId: jobIds)
+        prioritize(jobId);
+
+    for(size_t jobId: jobIds)
+    {
+        while(!isDone(jobId))
+        {
+            if(!processDone(50) && !isDone(jobId))
+                return false;
+            if(ProgressProxy::wasCancelled())
+                return false;
+        }
+    }
+    return true;
+}
+
+void IoWorkerPool::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_pending.clear();
+        m_urgent.clear();
+        m_workAvailable.wakeAll();
+    }
+
+    for(const std::unique_ptr<Worker>& worker: m_workers)
+        worker->wait();
+    m_workers.clear();
+}
+
+IoWorkerPool::Task* IoWorkerPool::takeTask(std::deque<Task*>& queue)
+{
+    // Don't search the whole queue when a device is saturated, a later job will get its turn soon enough.
+    constexpr size_t maxLookAhead = 256;
+
+    const qint32 maxPerDevice = std::max(m_maxPerDevice, 1);
+    size_t looked = 0;
+    for(auto it = queue.begin(); it != queue.end() && looked < maxLookAhead;)
+    {
+        Task* pTask = *it;
+        // Already taken from the other queue.
+        if(!pTask->m_bQueued)
+        {
+            it = queue.erase(it);
+            continue;
+        }
+
+        const bool bFits = std::all_of(pTask->m_devices.begin(), pTask->m_devices.end(),
+                                       [this, maxPerDevice](size_t deviceId) { return m_deviceLoad[deviceId] < maxPerDevice; });
+        if(bFits)
+        {
+            queue.erase(it);
+            pTask->m_bQueued = false;
+            return pTask;
+        }
+        ++it;
+        ++looked;
+    }
+
+    return nullptr;
+}
+
+IoWorkerPool::Task* IoWorkerPool::takeTask()
+{
+    Task* pTask = takeTask(m_urgent);
+    return pTask != nullptr ? pTask : takeTask(m_pending);
+}
+
+void IoWorkerPool::work()
+{
+    QMutexLocker locker(&m_mutex);
+    while(!m_bStop)
+    {
+        Task* pTask = takeTask();
+        if(pTask == nullptr)
+        {
+            // Nothing queued and nothing running that could release a waiting job.
+            if(m_pending.empty() && m_urgent.empty() && m_nofRunning == 0)
+                break;
+            // Every job left is waiting for a busy device or a prerequisite.
+            m_workAvailable.wait(&m_mutex);
+            continue;
+        }
+
+        for(size_t deviceId: pTask->m_devices)
+            ++m_deviceLoad[deviceId];
+        ++m_nofRunning;
+
+        locker.unlock();
+        pTask->m_job();
+        locker.relock();
+
+        for(size_t deviceId: pTask->m_devices)
+            --m_deviceLoad[deviceId];
+        --m_nofRunning;
+
+        for(Task* pDependent: pTask->m_dependents)
+        {
+            if(--pDependent->m_nofPrerequisites == 0 && !m_bStop)
+            {
+                pDependent->m_bQueued = true;
+                m_pending.push_back(pDependent);
+            }
+        }
+
+        m_done.push_back(pTask);
+        m_taskDone.wakeOne();
+        m_workAvailable.wakeAll();
+    }
+}
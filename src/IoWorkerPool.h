@@ -0,0 +1,105 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef IOWORKERPOOL_H
+#define IOWORKERPOOL_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+/*
+    Runs blocking file jobs on a bounded pool of worker threads.
+
+    Each job names the devices it reads from. No more than maxPerDevice jobs touch the same device
+    at a time, jobs for other devices move ahead of those that have to wait. When a job is finished
+    its done function is called on the thread that called run(), in completion order. That is where
+    results are handed back to non thread safe code such as the models and the progress dialog.
+
+    A job may name prerequisites, jobs added before it. It is not started before they are
+    finished, whatever their outcome. Jobs without prerequisites start in the order added.
+
+    run() blocks until all jobs are done. To keep working meanwhile call start() instead and
+    processDone() from time to time, e.g. from a timer.
+
+    Jobs must not use KIO, it needs the GUI event loop.
+*/
+class IoWorkerPool
+{
+  public:
+    // Runs on a worker thread.
+    using Job = std::function<void()>;
+    // Runs on the thread that called run(). Return false to stop early.
+    using DoneFunction = std::function<bool()>;
+
+    IoWorkerPool();
+    ~IoWorkerPool();
+
+    void setMaxThreads(qint32 maxThreads) { m_maxThreads = maxThreads; }
+    void setMaxPerDevice(qint32 maxPerDevice) { m_maxPerDevice = maxPerDevice; }
+
+    // An empty device list means the job is only limited by the number of threads. Returns the id of the job.
+    size_t add(const QByteArrayList& devices, Job job, DoneFunction done, const std::vector<size_t>& prerequisites = {});
+    [[nodiscard]] size_t count() const;
+
+    // Returns false if stopped by the user or a done function. Jobs that never ran are dropped.
+    bool run();
+
+    // Starts the workers and returns at once. No jobs may be added afterwards.
+    void start();
+    // Calls the done functions of finished jobs, waiting up to timeoutMs for one. Returns false once nothing is left to do.
+    bool processDone(qint32 timeoutMs);
+    // Jobs that haven't started yet are moved to the front of the queue.
+    void prioritize(size_t jobId);
+    [[nodiscard]] bool isDone(size_t jobId) const;
+    // Prioritizes the jobs and processes finished ones until they are done. Returns false if stopped first.
+    bool waitFor(const std::vector<size_t>& jobIds);
+    // Waits for running jobs, those that never ran are dropped.
+    void stop();
+
+  private:
+    struct Task;
+    class Worker;
+
+    void work();
+    [[nodiscard]] Task* takeTask();
+    [[nodiscard]] Task* takeTask(std::deque<Task*>& queue);
+
+    std::deque<Task> m_tasks;
+    std::map<QByteArray, size_t> m_deviceIds;
+
+    qint32 m_maxThreads = 0;
+    qint32 m_maxPerDevice = 8;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    size_t m_nofDone = 0;
+    bool m_bStopped = false;
+
+    QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_taskDone;
+    // Guarded by m_mutex
+    std::deque<Task*> m_pending;
+    std::deque<Task*> m_urgent;
+    std::deque<Task*> m_done;
+    std::vector<qint32> m_deviceLoad;
+    // Jobs that may still release others.
+    qint32 m_nofRunning = 0;
+    bool m_bStop = false;
+};
+
+#endif /* IOWORKERPOOL_H */
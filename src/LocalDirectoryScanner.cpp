@@ -0,0 +1,183 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "LocalDirectoryScanner.h"
+
+#include "fileaccess.h"
+#include "ProgressProxy.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#ifdef Q_OS_LINUX
+namespace {
+// Layout used by the getdents64 system call. glibc only wraps it from 2.30 on.
+struct LinuxDirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// Only what the folder comparison needs. Inode and ctime complete the key of the content hash cache.
+constexpr unsigned int statxMask = STATX_TYPE | STATX_SIZE | STATX_MTIME | STATX_INO | STATX_CTIME;
+constexpr size_t direntBufferSize = 64 * 1024;
+
+// Set once if the kernel predates statx (Linux 4.11). All later scans go straight to QDir.
+QAtomicInteger<bool> s_bStatxMissing = false;
+
+struct ScannedEntry
+{
+    QString name;
+    struct statx st = {};
+    struct statx targetSt = {};
+    bool bTargetValid = false;
+    QString linkTarget;
+
+    // QDir::DirsFirst follows symlinks.
+    [[nodiscard]] bool isDir() const
+    {
+        if(S_ISLNK(st.stx_mode))
+            return bTargetValid && S_ISDIR(targetSt.stx_mode);
+
+        return S_ISDIR(st.stx_mode);
+    }
+};
+
+class FileDescriptor
+{
+  public:
+    explicit FileDescriptor(int fd): m_fd(fd) {}
+    ~FileDescriptor()
+    {
+        if(m_fd >= 0)
+            close(m_fd);
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    [[nodiscard]] int get() const { return m_fd; }
+
+  private:
+    int m_fd;
+};
+} // namespace
+#endif
+
+std::optional<bool> LocalDirectoryScanner::scan(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden)
+{
+#ifdef Q_OS_LINUX
+    if(s_bStatxMissing.loadRelaxed())
+        return std::nullopt;
+
+    const QString dirPath = dirAccess.absoluteFilePath();
+    const FileDescriptor dirFd(open(QFile::encodeName(dirPath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if(dirFd.get() < 0)
+        return false;
+
+    std::vector<ScannedEntry> entries;
+    const std::unique_ptr<char[]> buffer = std::make_unique<char[]>(direntBufferSize);
+    for(;;)
+    {
+        const long nRead = syscall(SYS_getdents64, dirFd.get(), buffer.get(), direntBufferSize);
+        if(nRead == 0)
+            break;
+        if(nRead < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return false;
+        }
+
+        for(long pos = 0; pos < nRead;)
+        {
+            const LinuxDirent64* pDirent = reinterpret_cast<const LinuxDirent64*>(buffer.get() + pos);
+            const char* pName = buffer.get() + pos + offsetof(LinuxDirent64, d_name);
+            pos += pDirent->d_reclen;
+
+            if(pName[0] == '.' && (pName[1] == '\0' || (pName[1] == '.' && pName[2] == '\0')))
+                continue;
+            // Dropped before any stat. QDir stats every entry to decide if it is hidden.
+            if(!bFindHidden && pName[0] == '.')
+                continue;
+
+            ScannedEntry entry;
+            if(statx(dirFd.get(), pName, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, statxMask, &entry.st) != 0)
+            {
+                if(errno == ENOSYS)
+                {
+                    s_bStatxMissing.storeRelaxed(true);
+                    return std::nullopt;
+                }
+                continue; // Removed since it was listed. QDir would not report it either.
+            }
+
+            // Taken from the statx above, not d_type, so the type matches the rest of the entry if it was replaced meanwhile.
+            if(S_ISLNK(entry.st.stx_mode))
+            {
+                entry.bTargetValid = statx(dirFd.get(), pName, AT_NO_AUTOMOUNT, statxMask, &entry.targetSt) == 0;
+
+                char linkTarget[PATH_MAX + 1];
+                const ssize_t len = readlinkat(dirFd.get(), pName, linkTarget, PATH_MAX);
+                if(len > 0)
+                    entry.linkTarget = QFile::decodeName(QByteArray(linkTarget, (qsizetype)len));
+            }
+
+            entry.name = QFile::decodeName(pName);
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const ScannedEntry& a, const ScannedEntry& b) {
+        if(a.isDir() != b.isDir())
+            return a.isDir();
+
+        return a.name.compare(b.name) < 0;
+    });
+
+    // One copy of the folder's path for all of its entries.
+    const QString entryDirPath = dirPath.endsWith(u'/') ? dirPath : dirPath + u'/';
+    for(const ScannedEntry& entry: entries)
+    {
+        if(ProgressProxy::wasCancelled())
+            break;
+
+        FileAccess& fa = dirList.emplace_back();
+        fa.setFromStat(&dirAccess, entryDirPath, entry.name, entry.st,
+                       entry.bTargetValid ? &entry.targetSt : nullptr, entry.linkTarget);
+    }
+
+    return true;
+#else
+    Q_UNUSED(dirAccess);
+    Q_UNUSED(dirList);
+    Q_UNUSED(bFindHidden);
+    return std::nullopt;
+#endif
+}
@@ -0,0 +1,36 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef LOCALDIRECTORYSCANNER_H
+#define LOCALDIRECTORYSCANNER_H
+
+#include "DirectoryList.h"
+
+#include <optional>
+
+class FileAccess;
+
+/*
+    Lists a local folder with as few system calls as possible.
+
+    On Linux the entries are read with getdents64 and each one gets a single statx call asking
+    only for type, size, inode and the modification and status change times. Only symlinks need
+    a second statx and a readlink. Permissions are left to QFileInfo which looks them up lazily
+    if anyone asks.
+
+    The result is ordered like QDir::Name | QDir::DirsFirst. Thread safe.
+*/
+class LocalDirectoryScanner
+{
+  public:
+    // Returns std::nullopt if the native scanner is not usable here and QDir must be used instead.
+    [[nodiscard]] static std::optional<bool> scan(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden);
+};
+
+#endif /* LOCALDIRECTORYSCANNER_H */
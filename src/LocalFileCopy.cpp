@@ -0,0 +1,259 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "LocalFileCopy.h"
+
+#include "ProgressProxy.h"
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTemporaryFile>
+
+#include <KLocalizedString>
+
+namespace {
+// Between two checks for the cancel button.
+constexpr qint64 maxChunkSize = 64 * 1024 * 1024;
+// Unit of a delta copy, a changed byte costs one block.
+constexpr qint64 deltaBlockSize = 64 * 1024;
+constexpr qint64 deltaBufferSize = 1024 * 1024;
+
+#ifdef Q_OS_LINUX
+/*
+    Returns eReadWrite if the kernel can't copy between these files. Nothing was written then and
+    both file offsets are still at the start.
+*/
+LocalFileCopy::Method copyInKernel(const int srcFd, const int destFd, const qint64 size, const QString& destPath, QString& errorText)
+{
+    if(::ioctl(destFd, FICLONE, srcFd) == 0)
+        return LocalFileCopy::eClone;
+
+    LocalFileCopy::Method method = LocalFileCopy::eCopyFileRange;
+    qint64 copied = 0;
+    while(copied < size)
+    {
+        const size_t chunkSize = (size_t)std::min(size - copied, maxChunkSize);
+        const ssize_t result = method == LocalFileCopy::eCopyFileRange ? ::copy_file_range(srcFd, nullptr, destFd, nullptr, chunkSize, 0)
+                                                                         : ::sendfile(destFd, srcFd, nullptr, chunkSize);
+        if(result < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            // Not supported between these files, across file systems on older kernels for instance.
+            if(copied == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))
+            {
+                if(method == LocalFileCopy::eSendFile)
+                    return LocalFileCopy::eReadWrite;
+                method = LocalFileCopy::eSendFile;
+                continue;
+            }
+
+            errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", destPath, QString::fromLocal8Bit(::strerror(errno)));
+            return LocalFileCopy::eFailed;
+        }
+        // The file got shorter meanwhile.
+        if(result == 0)
+            break;
+
+        copied += result;
+        if(ProgressProxy::wasCancelled())
+        {
+            errorText = i18nc("@info:status", "User cancelled copy operation.");
+            return LocalFileCopy::eFailed;
+        }
+    }
+    return method;
+}
+#endif
+} // namespace
+
+LocalFileCopy::Method LocalFileCopy::copy(const QString& srcPath, const QString& destPath, QString& errorText)
+{
+    // Unbuffered, the kernel copy moves the file offsets behind QFile's back.
+    QFile srcFile(srcPath);
+    QFile destFile(destPath);
+    if(!srcFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", srcPath, srcFile.errorString());
+        return eFailed;
+    }
+    if(!destFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", destPath, destFile.errorString());
+        return eFailed;
+    }
+
+    Method method = eReadWrite;
+#ifdef Q_OS_LINUX
+    method = copyInKernel(srcFile.handle(), destFile.handle(), srcFile.size(), destPath, errorText);
+    if(method == eFailed)
+        return eFailed;
+#endif
+
+    if(method == eReadWrite)
+    {
+        QByteArray buffer(std::min(maxChunkSize, (qint64)1024 * 1024), Qt::Uninitialized);
+        for(;;)
+        {
+            const qint64 readSize = srcFile.read(buffer.data(), buffer.size());
+            if(readSize < 0)
+            {
+                errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", srcPath, srcFile.errorString());
+                return eFailed;
+            }
+            if(readSize == 0)
+                break;
+
+            if(destFile.write(buffer.constData(), readSize) != readSize)
+            {
+                errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", destPath, destFile.errorString());
+                return eFailed;
+            }
+
+            if(ProgressProxy::wasCancelled())
+            {
+                errorText = i18nc("@info:status", "User cancelled copy operation.");
+                return eFailed;
+            }
+        }
+    }
+
+    // Not being able to keep these is no reason to fail the copy.
+    destFile.setPermissions(srcFile.permissions());
+    destFile.setFileTime(srcFile.fileTime(QFileDevice::FileModificationTime), QFileDevice::FileModificationTime);
+    return method;
+}
+
+LocalFileCopy::Method LocalFileCopy::deltaCopy(const QString& srcPath, const QString& basePath, const QString& destPath, QString& errorText)
+{
+#ifdef Q_OS_LINUX
+    QFile srcFile(srcPath);
+    QFile baseFile(basePath);
+    if(!srcFile.open(QIODevice::ReadOnly))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", srcPath, srcFile.errorString());
+        return eFailed;
+    }
+    if(!baseFile.open(QIODevice::ReadOnly))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", basePath, baseFile.errorString());
+        return eFailed;
+    }
+
+    // Next to the destination, the final rename must stay on the same file system.
+    QTemporaryFile destFile(destPath + QStringLiteral(".XXXXXX"));
+    if(!destFile.open())
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", destFile.fileTemplate(), destFile.errorString());
+        return eFailed;
+    }
+
+    // Without a reflink the unchanged blocks would have to be copied as well.
+    if(::ioctl(destFile.handle(), FICLONE, baseFile.handle()) != 0)
+    {
+        destFile.remove();
+        return copy(srcPath, destPath, errorText);
+    }
+
+    const qint64 srcSize = srcFile.size();
+    const qint64 baseSize = baseFile.size();
+    QCryptographicHash srcHash(QCryptographicHash::Sha256);
+    QByteArray srcBuffer(deltaBufferSize, Qt::Uninitialized);
+    QByteArray baseBuffer(deltaBufferSize, Qt::Uninitialized);
+    for(qint64 offset = 0; offset < srcSize; offset += deltaBufferSize)
+    {
+        const qint64 len = std::min(deltaBufferSize, srcSize - offset);
+        const qint64 baseLen = std::clamp(baseSize - offset, (qint64)0, len);
+        if(srcFile.read(srcBuffer.data(), len) != len)
+        {
+            errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", srcPath, srcFile.errorString());
+            return eFailed;
+        }
+        if(baseFile.read(baseBuffer.data(), baseLen) != baseLen)
+        {
+            errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", basePath, baseFile.errorString());
+            return eFailed;
+        }
+        srcHash.addData(QByteArrayView(srcBuffer.constData(), len));
+
+        for(qint64 block = 0; block < len; block += deltaBlockSize)
+        {
+            const qint64 blockLen = std::min(deltaBlockSize, len - block);
+            if(block + blockLen <= baseLen && memcmp(srcBuffer.constData() + block, baseBuffer.constData() + block, (size_t)blockLen) == 0)
+                continue;
+
+            if(!destFile.seek(offset + block) || destFile.write(srcBuffer.constData() + block, blockLen) != blockLen)
+            {
+                errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", destPath, destFile.errorString());
+                return eFailed;
+            }
+        }
+
+        if(ProgressProxy::wasCancelled())
+        {
+            errorText = i18nc("@info:status", "User cancelled copy operation.");
+            return eFailed;
+        }
+    }
+
+    if(!destFile.resize(srcSize) || !destFile.seek(0))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", destPath, destFile.errorString());
+        return eFailed;
+    }
+
+    // Read back, what the reflink left must match the source as well as what was written.
+    QCryptographicHash destHash(QCryptographicHash::Sha256);
+    for(qint64 offset = 0; offset < srcSize; offset += deltaBufferSize)
+    {
+        const qint64 len = std::min(deltaBufferSize, srcSize - offset);
+        if(destFile.read(srcBuffer.data(), len) != len)
+        {
+            errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", destPath, destFile.errorString());
+            return eFailed;
+        }
+        destHash.addData(QByteArrayView(srcBuffer.constData(), len));
+    }
+    if(destHash.result() != srcHash.result())
+    {
+        errorText = i18nc("@info:status %1 is the path", "Verifying the copy to %1 failed.", destPath);
+        return eFailed;
+    }
+
+    destFile.setPermissions(srcFile.permissions());
+    destFile.setFileTime(srcFile.fileTime(QFileDevice::FileModificationTime), QFileDevice::FileModificationTime);
+    // Unlike QFile::rename this replaces the destination in one step.
+    if(!destFile.flush() || ::fdatasync(destFile.handle()) != 0 ||
+       ::rename(QFile::encodeName(destFile.fileName()).constData(), QFile::encodeName(destPath).constData()) != 0)
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", destPath, QString::fromLocal8Bit(::strerror(errno)));
+        return eFailed;
+    }
+    destFile.setAutoRemove(false);
+    return eDelta;
+#else
+    Q_UNUSED(basePath);
+    return copy(srcPath, destPath, errorText);
+#endif
+}
@@ -0,0 +1,50 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef LOCALFILECOPY_H
+#define LOCALFILECOPY_H
+
+#include <QString>
+
+/*
+    Copies a local file without KIO, on any thread.
+
+    On Linux the kernel does the work: a reflink first, which on btrfs, XFS and other copy on write
+    file systems only shares the data extents. Otherwise copy_file_range, which may offload the copy
+    to the storage, and sendfile for file systems or kernels without it. Everything else is read and
+    written in chunks. Like the KIO-slave the permissions and the modification time are kept.
+*/
+class LocalFileCopy
+{
+  public:
+    enum Method
+    {
+        eFailed,
+        eClone,         // FICLONE, no data copied
+        eCopyFileRange, // Copied by the kernel
+        eSendFile,      // Copied by the kernel
+        eReadWrite,     // Copied through a buffer
+        eDelta          // Only the changed blocks written, see deltaCopy
+    };
+
+    // An existing destination is overwritten. Returns eFailed and sets errorText if the copy failed.
+    [[nodiscard]] static Method copy(const QString& srcPath, const QString& destPath, QString& errorText);
+
+    /*
+        For large files of which an older version exists at basePath, destPath may be the same file.
+        A reflink of the old version is made next to destPath and only the blocks that differ from
+        the source are written into it. The result is checked against the SHA-256 of the source
+        and then renamed to destPath in one step, the old version stays intact until then.
+
+        Falls back to copy() where the file system can't make reflinks.
+    */
+    [[nodiscard]] static Method deltaCopy(const QString& srcPath, const QString& basePath, const QString& destPath, QString& errorText);
+};
+
+#endif /* LOCALFILECOPY_H */
@@ -251,6 +251,28 @@ void MergeBlockList::buildFromDiff3(const Diff3LineList &diff3List, bool isThree
         ++lineIdx;
     }
 }
+void MergeBlockList::countConflicts(TotalDiffStatus& totalDiffStatus) const
+{
+    qint32 nrOfSolvedConflicts = 0;
+    qint32 nrOfUnsolvedConflicts = 0;
+    qint32 nrOfWhiteSpaceConflicts = 0;
+
+    for(const MergeBlock& mb: *this)
+    {
+        if(mb.isConflict())
+            ++nrOfUnsolvedConflicts;
+        else if(mb.isDelta())
+            ++nrOfSolvedConflicts;
+
+        if(mb.isWhiteSpaceConflict())
+            ++nrOfWhiteSpaceConflicts;
+    }
+
+    totalDiffStatus.setUnsolvedConflicts(nrOfUnsolvedConflicts);
+    totalDiffStatus.setSolvedConflicts(nrOfSolvedConflicts);
+    totalDiffStatus.setWhitespaceConflicts(nrOfWhiteSpaceConflicts);
+}
+
 /*
     Changes default merge settings currently used when not in auto mode or if white space is being auto solved.
 */
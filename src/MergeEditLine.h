@@ -187,6 +187,8 @@ class MergeBlockList: public std::list<MergeBlock>
 
     void buildFromDiff3(const Diff3LineList& diff3List, bool isThreeway);
     void updateDefaults(const e_SrcSelector defaultSelector, const bool bConflictsOnly, const bool bWhiteSpaceOnly);
+    // Stores the number of solved, unsolved and white space conflicts.
+    void countConflicts(TotalDiffStatus& totalDiffStatus) const;
 
     MergeBlockList::iterator splitAtDiff3LineIdx(qint32 d3lLineIdx);
 };
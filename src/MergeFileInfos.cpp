@@ -10,17 +10,29 @@
 
 #include "MergeFileInfos.h"
 
+#include "AsyncFileReader.h"
+#include "ContentHashCache.h"
 #include "DirectoryInfo.h"
 #include "directorymergewindow.h"
 #include "fileaccess.h"
+#include "FileIdentity.h"
+#include "FullAnalysis.h"
 #include "Logging.h"
 #include "options.h"
 #include "progress.h"
 
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <memory>
+#include <optional>
+#include <random>
 #include <vector>
 
+#include <QByteArrayView>
+#include <QCryptographicHash>
 #include <QString>
+#include <QStringList>
 
 #include <KLocalizedString>
 
@@ -160,12 +172,17 @@ QString MergeFileInfos::fullNameC() const
     return gDirInfo->dirC().absoluteFilePath() + u'/' + subPath();
 }
 
-void MergeFileInfos::sort(Qt::SortOrder order)
+void MergeFileInfos::sortChildren(Qt::SortOrder order, quint64 generation)
 {
+    if(m_sortGeneration == generation)
+        return;
+
     std::sort(m_children.begin(), m_children.end(), MfiCompare(order));
 
     for(qint32 i = 0; i < m_children.count(); ++i)
-        m_children[i]->sort(order);
+        m_children[i]->m_row = i;
+
+    m_sortGeneration = generation;
 }
 
 QString MergeFileInfos::fullNameDest() const
@@ -178,31 +195,85 @@ QString MergeFileInfos::fullNameDest() const
         return gDirInfo->destDir().absoluteFilePath() + u'/' + subPath();
 }
 
-bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMergeWindow* pDMW)
+QString MergeFileInfos::identityStatus() const
 {
-    enum class FileIndex
-    {
-        a,
-        b,
-        c
+    const auto reason = [](const FileIdentity::Equality eIdentity) -> QString {
+        switch(eIdentity)
+        {
+            case FileIdentity::eSameFile:
+                return i18nc("Status column message", "same file");
+            case FileIdentity::eSharedExtents:
+                return i18nc("Status column message", "shared extents");
+            case FileIdentity::eUnknown:
+                break;
+        }
+        return QString();
     };
 
-    std::map<QDateTime, FileIndex> dateMap;
+    QStringList parts;
+    if(m_eIdentityAB != FileIdentity::eUnknown)
+        parts.append(i18nc("Status column message, %1 is why no data was read", "A = B: %1", reason(m_eIdentityAB)));
+    if(m_eIdentityAC != FileIdentity::eUnknown)
+        parts.append(i18nc("Status column message, %1 is why no data was read", "A = C: %1", reason(m_eIdentityAC)));
+    if(m_eIdentityBC != FileIdentity::eUnknown)
+        parts.append(i18nc("Status column message, %1 is why no data was read", "B = C: %1", reason(m_eIdentityBC)));
+    if(m_bInIdenticalSubtree)
+        parts.append(i18nc("Status column message", "in an identical folder"));
+    // Only parts of these files were read.
+    if(m_bSampledAB)
+        parts.append(i18nc("Status column message", "A = B: probably equal"));
+    if(m_bSampledAC)
+        parts.append(i18nc("Status column message", "A = C: probably equal"));
+    if(m_bSampledBC)
+        parts.append(i18nc("Status column message", "B = C: probably equal"));
+
+    return parts.join(QStringLiteral(", "));
+}
 
-    if(existsInA())
-    {
-        dateMap[getFileInfoA()->lastModified()] = FileIndex::a;
-    }
-    if(existsInB())
+void MergeFileInfos::pairRename(MergeFileInfos* pSource)
+{
+    assert(pSource != nullptr && pSource != this);
+    unpairRename();
+    pSource->unpairRename();
+
+    m_pRenameSource = pSource;
+    pSource->m_pRenameTarget = this;
+}
+
+MergeFileInfos* MergeFileInfos::unpairRename()
+{
+    MergeFileInfos* pPartner = renamePartner();
+    if(pPartner != nullptr)
     {
-        dateMap[getFileInfoB()->lastModified()] = FileIndex::b;
+        pPartner->m_pRenameSource = nullptr;
+        pPartner->m_pRenameTarget = nullptr;
     }
-    if(existsInC())
+    m_pRenameSource = nullptr;
+    m_pRenameTarget = nullptr;
+    return pPartner;
+}
+
+void MergeFileInfos::setInIdenticalSubtree()
+{
+    m_bInIdenticalSubtree = true;
+    m_bEqualAB = existsInA() && existsInB();
+    m_bEqualAC = existsInA() && existsInC();
+    m_bEqualBC = existsInB() && existsInC();
+    m_totalDiffStatus.setBinaryEqualAB(m_bEqualAB);
+    m_totalDiffStatus.setBinaryEqualAC(m_bEqualAC);
+    m_totalDiffStatus.setBinaryEqualBC(m_bEqualBC);
+}
+
+bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMergeWindow* pDMW)
+{
+    if(m_bInIdenticalSubtree)
     {
-        dateMap[getFileInfoC()->lastModified()] = FileIndex::c;
+        calcAges();
+        return true;
     }
 
-    if(gOptions->m_bDmFullAnalysis)
+    // A snapshot has no contents to analyse.
+    if(gOptions->m_bDmFullAnalysis && !hasSnapshot())
     {
         if((existsInA() && isDirA()) || (existsInB() && isDirB()) || (existsInC() && isDirC()))
         {
@@ -219,20 +290,7 @@ bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMerge
                 existsInC() ? getFileInfoC()->absoluteFilePath() : QString(""),
                 "",
                 "", "", "", &diffStatus());
-            qint32 nofNonwhiteConflicts = diffStatus().getNonWhitespaceConflicts();
-
-            if(gOptions->m_bDmWhiteSpaceEqual && nofNonwhiteConflicts == 0)
-            {
-                m_bEqualAB = existsInA() && existsInB();
-                m_bEqualAC = existsInA() && existsInC();
-                m_bEqualBC = existsInB() && existsInC();
-            }
-            else
-            {
-                m_bEqualAB = diffStatus().isBinaryEqualAB();
-                m_bEqualBC = diffStatus().isBinaryEqualBC();
-                m_bEqualAC = diffStatus().isBinaryEqualAC();
-            }
+            updateEqualFromDiffStatus();
 
             //Limit size of error list in memory.
             if(errors.size() >= 30)
@@ -244,32 +302,8 @@ bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMerge
     }
     else
     {
-        bool bError = false;
         QString eqStatus;
-        if(existsInA() && existsInB())
-        {
-            if(isDirA())
-                m_bEqualAB = true;
-            else
-                m_bEqualAB = fastFileComparison(*getFileInfoA(), *getFileInfoB(), bError, eqStatus);
-        }
-        if(existsInA() && existsInC())
-        {
-            if(isDirA())
-                m_bEqualAC = true;
-            else
-                m_bEqualAC = fastFileComparison(*getFileInfoA(), *getFileInfoC(), bError, eqStatus);
-        }
-        if(existsInB() && existsInC())
-        {
-            if((m_bEqualAB && m_bEqualAC) || isDirB())
-                m_bEqualBC = true;
-            else
-            {
-                m_bEqualBC = fastFileComparison(*getFileInfoB(), *getFileInfoC(), bError, eqStatus);
-            }
-        }
-        if(bError)
+        if(!compareContents(eqStatus, true))
         {
             //Limit size of error list in memory.
             if(errors.size() < 30)
@@ -278,6 +312,144 @@ bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMerge
         }
     }
 
+    calcAges();
+    return true;
+}
+
+void MergeFileInfos::updateEqualFromDiffStatus()
+{
+    qint32 nofNonwhiteConflicts = diffStatus().getNonWhitespaceConflicts();
+
+    if(gOptions->m_bDmWhiteSpaceEqual && nofNonwhiteConflicts == 0)
+    {
+        m_bEqualAB = existsInA() && existsInB();
+        m_bEqualAC = existsInA() && existsInC();
+        m_bEqualBC = existsInB() && existsInC();
+    }
+    else
+    {
+        m_bEqualAB = diffStatus().isBinaryEqualAB();
+        m_bEqualBC = diffStatus().isBinaryEqualBC();
+        m_bEqualAC = diffStatus().isBinaryEqualAC();
+    }
+}
+
+bool MergeFileInfos::canCompareConcurrently() const
+{
+    if(m_bInIdenticalSubtree || hasDir())
+        return false;
+
+    if(gOptions->m_bDmFullAnalysis)
+    {
+        if(!FullAnalysis::isSupported() || hasSnapshot())
+            return false;
+    }
+    else if(existsCount() < 2)
+        return false;
+
+    // Remote files are fetched through KIO which needs the GUI thread.
+    return (!existsInA() || getFileInfoA()->isLocal()) &&
+           (!existsInB() || getFileInfoB()->isLocal()) &&
+           (!existsInC() || getFileInfoC()->isLocal());
+}
+
+bool MergeFileInfos::compareContents(QString& status, bool bShowProgress)
+{
+    m_eIdentityAB = FileIdentity::eUnknown;
+    m_eIdentityAC = FileIdentity::eUnknown;
+    m_eIdentityBC = FileIdentity::eUnknown;
+    m_bSampledAB = false;
+    m_bSampledAC = false;
+    m_bSampledBC = false;
+
+    // Read each file once instead of once per pair.
+    if(existsInA() && existsInB() && existsInC() && !hasDir())
+        return threeWayFileComparison(status, bShowProgress);
+
+    bool bError = false;
+    if(existsInA() && existsInB())
+    {
+        if(isDirA())
+            m_bEqualAB = true;
+        else
+            m_bEqualAB = fastFileComparison(*getFileInfoA(), *getFileInfoB(), bError, status, m_eIdentityAB, m_bSampledAB, bShowProgress);
+    }
+    if(existsInA() && existsInC())
+    {
+        if(isDirA())
+            m_bEqualAC = true;
+        else
+            m_bEqualAC = fastFileComparison(*getFileInfoA(), *getFileInfoC(), bError, status, m_eIdentityAC, m_bSampledAC, bShowProgress);
+    }
+    if(existsInB() && existsInC())
+    {
+        if((m_bEqualAB && m_bEqualAC) || isDirB())
+            m_bEqualBC = true;
+        else
+        {
+            m_bEqualBC = fastFileComparison(*getFileInfoB(), *getFileInfoC(), bError, status, m_eIdentityBC, m_bSampledBC, bShowProgress);
+        }
+    }
+
+    return !bError;
+}
+
+void MergeFileInfos::analyzeContents(QStringList& errors)
+{
+    FullAnalysis::run(existsInA() ? getFileInfoA()->absoluteFilePath() : QString(),
+                      existsInB() ? getFileInfoB()->absoluteFilePath() : QString(),
+                      existsInC() ? getFileInfoC()->absoluteFilePath() : QString(),
+                      diffStatus(), errors);
+    updateEqualFromDiffStatus();
+}
+
+void MergeFileInfos::adoptComparison(const MergeFileInfos& other)
+{
+    m_bEqualAB = other.m_bEqualAB;
+    m_bEqualAC = other.m_bEqualAC;
+    m_bEqualBC = other.m_bEqualBC;
+    m_eIdentityAB = other.m_eIdentityAB;
+    m_eIdentityAC = other.m_eIdentityAC;
+    m_eIdentityBC = other.m_eIdentityBC;
+    m_bSampledAB = other.m_bSampledAB;
+    m_bSampledAC = other.m_bSampledAC;
+    m_bSampledBC = other.m_bSampledBC;
+    m_totalDiffStatus = other.m_totalDiffStatus;
+    m_bContentPending = false;
+
+    calcAges();
+}
+
+void MergeFileInfos::calcAges()
+{
+    enum class FileIndex
+    {
+        a,
+        b,
+        c
+    };
+
+    // Ages are worked out again once a pending comparison is done.
+    setAgeA(eNotThere);
+    setAgeB(eNotThere);
+    setAgeC(eNotThere);
+    m_bConflictingAges = false;
+
+    std::map<QDateTime, FileIndex> dateMap;
+
+    if(existsInA())
+    {
+        dateMap[getFileInfoA()->lastModified()] = FileIndex::a;
+    }
+    if(existsInB())
+    {
+        dateMap[getFileInfoB()->lastModified()] = FileIndex::b;
+    }
+    if(existsInC())
+    {
+        dateMap[getFileInfoC()->lastModified()] = FileIndex::c;
+    }
+
     if(isLinkA() != isLinkB()) m_bEqualAB = false;
     if(isLinkA() != isLinkC()) m_bEqualAC = false;
     if(isLinkB() != isLinkC()) m_bEqualBC = false;
@@ -371,21 +543,360 @@ bool MergeFileInfos::compareFilesAndCalcAges(QStringList& errors, DirectoryMerge
         if(getAgeB() == eMiddle) setAgeB(eOld);
         if(getAgeC() == eMiddle) setAgeC(eOld);
     }
+}
+
+namespace {
+// Large reads keep the disks streaming.
+constexpr qint64 comparisonChunkSize = 1024 * 1024;
+
+/*
+    One side of a binary comparison. Local files are read with several chunks in flight and are
+    dropped from the page cache behind the reads, a comparison of a whole tree shouldn't push out
+    everything else. Temporary copies of remote files are read in large chunks with a hint to the
+    OS that the file is read front to back.
+*/
+class ComparisonInput
+{
+  public:
+    explicit ComparisonInput(FileAccess& file): m_file(file) {}
+    ~ComparisonInput() { close(); }
+
+    ComparisonInput(const ComparisonInput&) = delete;
+    ComparisonInput& operator=(const ComparisonInput&) = delete;
+
+    [[nodiscard]] FileAccess& file() const { return m_file; }
+
+    // With bHash set the contents are hashed even if the hash can't be stored.
+    bool open(const bool bHash = false)
+    {
+        // Stat before reading, the hash is only stored if nothing changed while the file was read.
+        if(gContentHashCache != nullptr && m_file.isLocal())
+            m_key = ContentHashCache::keyFor(m_file.absoluteFilePath());
+
+        if(m_file.isLocal() && !m_file.isSnapshot())
+        {
+            m_pReader = std::make_unique<AsyncFileReader>(comparisonChunkSize);
+            if(!m_pReader->open(m_file.absoluteFilePath()))
+            {
+                m_errorText = m_pReader->errorString();
+                m_pReader.reset();
+                return false;
+            }
+            m_pReader->setDropCache(true);
+        }
+        else
+        {
+            if(!m_file.open(QIODevice::ReadOnly))
+                return false;
+            m_file.adviseSequentialRead();
+        }
+
+        if(m_key.has_value() || bHash)
+            m_hash.emplace(QCryptographicHash::Sha256);
+        m_bOpen = true;
+        return true;
+    }
+
+    // Returns the next len bytes or nullptr on a read error.
+    [[nodiscard]] const char* next(qint64 len)
+    {
+        if(m_pReader != nullptr)
+        {
+            qint64 readLen = 0;
+            const char* pData = m_pReader->next(readLen);
+            // The file shrunk since it was listed.
+            if(pData == nullptr || readLen != len)
+            {
+                m_errorText = m_pReader->errorString().isEmpty() ? i18n("Error reading from %1.", m_file.absoluteFilePath()) : m_pReader->errorString();
+                return nullptr;
+            }
+
+            m_offset += len;
+            addToHash(pData, len);
+            return pData;
+        }
+
+        if((qint64)m_buffer.size() < len)
+            m_buffer.resize((size_t)len);
+        if(m_file.read(m_buffer.data(), len) != len)
+            return nullptr;
+
+        m_offset += len;
+        addToHash(m_buffer.data(), len);
+        return m_buffer.data();
+    }
+
+    // Files that were read to the end have a complete hash, remember it for the next comparison.
+    void storeHash()
+    {
+        if(!m_hash.has_value() || !m_key.has_value() || m_offset != m_key->m_size)
+            return;
+
+        if(ContentHashCache::keyFor(m_file.absoluteFilePath()) == m_key)
+            gContentHashCache->insert(*m_key, m_hash->result());
+    }
+
+    // Only valid after open(true) and once the whole file was read.
+    [[nodiscard]] QByteArray hash() const { return m_hash->result(); }
+
+    [[nodiscard]] QString errorString() const
+    {
+        if(!m_errorText.isEmpty())
+            return m_errorText;
+        return m_file.errorString().isEmpty() ? i18n("Error reading from %1.", m_file.absoluteFilePath()) : m_file.errorString();
+    }
+
+    void close()
+    {
+        if(!m_bOpen)
+            return;
+
+        if(m_pReader != nullptr)
+            m_pReader.reset();
+        else
+            m_file.close();
+        m_bOpen = false;
+    }
+
+  private:
+    void addToHash(const char* pData, qint64 len)
+    {
+        if(m_hash.has_value())
+            m_hash->addData(QByteArrayView(pData, len));
+    }
+
+    FileAccess& m_file;
+    std::optional<ContentHashCache::Key> m_key;
+    std::optional<QCryptographicHash> m_hash;
+    bool m_bOpen = false;
+    std::unique_ptr<AsyncFileReader> m_pReader;
+    QString m_errorText;
+    qint64 m_offset = 0;
+    std::vector<char> m_buffer;
+};
+
+struct PairComparison
+{
+    FileAccess* m_pFile1;
+    FileAccess* m_pFile2;
+    bool* m_pEqual;
+};
+
+/*
+    Binary comparison of two or three files of the same size. Each file is read only once, in lockstep,
+    no matter in how many pairs it takes part. A pair drops out at its first difference and a file
+    is no longer read once all of its pairs are decided.
+
+    Returns false on a read error.
+*/
+bool lockstepComparison(const std::vector<PairComparison>& pairs, QString& status, bool bShowProgress)
+{
+    struct ActivePair
+    {
+        size_t m_input1;
+        size_t m_input2;
+        bool* m_pEqual;
+    };
+
+    std::vector<std::unique_ptr<ComparisonInput>> inputs;
+    const auto inputIndex = [&inputs](FileAccess* pFile) -> size_t {
+        for(size_t i = 0; i < inputs.size(); ++i)
+        {
+            if(&inputs[i]->file() == pFile)
+                return i;
+        }
+        inputs.push_back(std::make_unique<ComparisonInput>(*pFile));
+        return inputs.size() - 1;
+    };
+
+    std::vector<ActivePair> active;
+    for(const PairComparison& pair: pairs)
+    {
+        *pair.m_pEqual = false;
+        active.push_back({inputIndex(pair.m_pFile1), inputIndex(pair.m_pFile2), pair.m_pEqual});
+    }
+
+    for(const std::unique_ptr<ComparisonInput>& input: inputs)
+    {
+        if(!input->open())
+        {
+            status = input->errorString();
+            return false;
+        }
+    }
+
+    qCInfo(kdiffMergeFileInfo) << "Comparing files...";
+    // The size checks made sure that all files taking part have the same size.
+    const qint64 fullSize = inputs[0]->file().size();
+    if(bShowProgress)
+    {
+        ProgressProxy::setInformation(i18nc("Status message", "Comparing file..."), 0, false);
+        ProgressProxy::setMaxNofSteps(fullSize / comparisonChunkSize);
+    }
+
+    std::vector<const char*> chunks(inputs.size());
+    for(qint64 offset = 0; offset < fullSize && !active.empty() && !ProgressProxy::wasCancelled(); offset += comparisonChunkSize)
+    {
+        const qint64 len = std::min(comparisonChunkSize, fullSize - offset);
+
+        std::fill(chunks.begin(), chunks.end(), nullptr);
+        for(const ActivePair& pair: active)
+        {
+            for(const size_t i: {pair.m_input1, pair.m_input2})
+            {
+                if(chunks[i] != nullptr)
+                    continue;
+
+                chunks[i] = inputs[i]->next(len);
+                if(chunks[i] == nullptr)
+                {
+                    status = inputs[i]->errorString();
+                    return false;
+                }
+            }
+        }
+
+        std::vector<ActivePair> stillEqual;
+        for(size_t i = 0; i < active.size(); ++i)
+        {
+            const ActivePair& pair = active[i];
+            // With all three pairs still running A == B and A == C for this chunk implies B == C.
+            const bool bImplied = i == 2 && stillEqual.size() == 2;
+            if(bImplied || memcmp(chunks[pair.m_input1], chunks[pair.m_input2], len) == 0)
+                stillEqual.push_back(pair);
+        }
+        active.swap(stillEqual);
+
+        if(bShowProgress)
+            ProgressProxy::step();
+    }
+
+    // If the program really arrives here, then the remaining pairs are really equal.
+    for(const ActivePair& pair: active)
+        *pair.m_pEqual = true;
+
+    for(const std::unique_ptr<ComparisonInput>& input: inputs)
+        input->storeHash();
 
     return true;
 }
 
-bool MergeFileInfos::fastFileComparison(
+/*
+    Compares the first and the last sample and sampleCount samples in between. The offsets only
+    depend on the file size, so a rescan looks at the same places. Returns nullopt if the files
+    have to be compared completely: when they are small enough for that or can't be read.
+*/
+std::optional<bool> sampledComparison(FileAccess& fi1, FileAccess& fi2)
+{
+    const qint64 sampleSize = (qint64)gOptions->m_dmSampleSizeKB * 1024;
+    const qint64 sampleCount = gOptions->m_dmSampleCount;
+    const qint64 size = fi1.size();
+    // Below that the samples would be more than an eighth of the file.
+    if(size != fi2.size() || sampleSize <= 0 || size < (sampleCount + 2) * sampleSize * 8)
+        return std::nullopt;
+
+    std::vector<qint64> offsets{0, size - sampleSize};
+    std::mt19937_64 generator((quint64)size);
+    std::uniform_int_distribution<qint64> distribution(1, size / sampleSize - 2);
+    for(qint64 i = 0; i < sampleCount; ++i)
+        offsets.push_back(distribution(generator) * sampleSize);
+    std::sort(offsets.begin(), offsets.end());
+
+    if(!fi1.open(QIODevice::ReadOnly))
+        return std::nullopt;
+    if(!fi2.open(QIODevice::ReadOnly))
+    {
+        fi1.close();
+        return std::nullopt;
+    }
+
+    std::optional<bool> result = true;
+    std::vector<char> buffer1((size_t)sampleSize);
+    std::vector<char> buffer2((size_t)sampleSize);
+    for(const qint64 offset: offsets)
+    {
+        if(!fi1.seek(offset) || !fi2.seek(offset) || fi1.read(buffer1.data(), sampleSize) != sampleSize ||
+           fi2.read(buffer2.data(), sampleSize) != sampleSize || ProgressProxy::wasCancelled())
+        {
+            result = std::nullopt;
+            break;
+        }
+        if(memcmp(buffer1.data(), buffer2.data(), (size_t)sampleSize) != 0)
+        {
+            result = false;
+            break;
+        }
+    }
+
+    fi1.close();
+    fi2.close();
+    return result;
+}
+
+std::optional<QByteArray> cachedHash(const FileAccess& file)
+{
+    if(gContentHashCache == nullptr || !file.isLocal())
+        return std::nullopt;
+
+    const std::optional<ContentHashCache::Key> key = ContentHashCache::keyFor(file.absoluteFilePath());
+    if(!key.has_value())
+        return std::nullopt;
+
+    return gContentHashCache->find(*key);
+}
+} // namespace
+
+std::optional<QByteArray> MergeFileInfos::contentHash(FileAccess& file)
+{
+    if(file.isSnapshot())
+        return file.snapshotHash();
+
+    std::optional<QByteArray> hash = cachedHash(file);
+    if(hash.has_value())
+        return hash;
+
+    ComparisonInput input(file);
+    if(!input.open(true))
+        return std::nullopt;
+
+    const qint64 fullSize = file.size();
+    for(qint64 offset = 0; offset < fullSize; offset += comparisonChunkSize)
+    {
+        if(input.next(std::min(comparisonChunkSize, fullSize - offset)) == nullptr || ProgressProxy::wasCancelled())
+            return std::nullopt;
+    }
+
+    input.storeHash();
+    return input.hash();
+}
+
+bool MergeFileInfos::hashComparison(FileAccess& fi1, FileAccess& fi2, bool& bError, QString& status)
+{
+    const std::optional<QByteArray> hash1 = contentHash(fi1);
+    const std::optional<QByteArray> hash2 = hash1.has_value() ? contentHash(fi2) : std::nullopt;
+    if(!hash1.has_value() || !hash2.has_value())
+    {
+        status = i18n("No content hash for %1 and %2.", fi1.absoluteFilePath(), fi2.absoluteFilePath());
+        return false;
+    }
+
+    qCInfo(kdiffMergeFileInfo) << "Comparing by content hash.";
+    bError = false;
+    return *hash1 == *hash2;
+}
+
+std::optional<bool> MergeFileInfos::quickFileComparison(
     FileAccess& fi1, FileAccess& fi2,
-    bool& bError, QString& status)
+    bool& bError, QString& status, FileIdentity::Equality& eIdentity, bool& bSampled)
 {
-    ProgressScope pp;
     bool bEqual = false;
 
     status = "";
     bError = true;
+    eIdentity = FileIdentity::eUnknown;
+    bSampled = false;
 
-    qCDebug(kdiffMergeFileInfo) << "Entering MergeFileInfos::fastFileComparison";
+    qCDebug(kdiffMergeFileInfo) << "Entering MergeFileInfos::quickFileComparison";
     if(fi1.isNormal() != fi2.isNormal())
     {
         qCDebug(kdiffMergeFileInfo) << "Have: \'" << fi2.fileName() << "\' , isNormal = " << fi2.isNormal();
@@ -426,6 +937,10 @@ bool MergeFileInfos::fastFileComparison(
         }
     }
 
+    // A checksum manifest has neither sizes nor dates to go by.
+    if(!fi1.hasMetaData() || !fi2.hasMetaData())
+        return hashComparison(fi1, fi2, bError, status);
+
     if(fi1.size() != fi2.size())
     {
         qCInfo(kdiffMergeFileInfo) << "Sizes differ.";
@@ -462,65 +977,103 @@ bool MergeFileInfos::fastFileComparison(
         }
     }
 
-    std::vector<char> buf1(100000);
-    std::vector<char> buf2(buf1.size());
+    // Files in a snapshot can't be read, their hash is all there is.
+    if(fi1.isSnapshot() || fi2.isSnapshot())
+        return hashComparison(fi1, fi2, bError, status);
 
-    if(!fi1.open(QIODevice::ReadOnly))
+    // Hard links are equal without reading a byte.
+    const bool bLocal = fi1.isLocal() && fi2.isLocal();
+    if(bLocal && FileIdentity::isSameFile(fi1.absoluteFilePath(), fi2.absoluteFilePath()))
     {
-        status = fi1.errorString();
-        return bEqual;
+        eIdentity = FileIdentity::eSameFile;
+        qCInfo(kdiffMergeFileInfo) << "Equal by file identity:" << eIdentity;
+        bError = false;
+        return true;
     }
 
-    if(!fi2.open(QIODevice::ReadOnly))
+    // Both files unchanged since their hashes were stored, no need to read them again.
+    const std::optional<QByteArray> hash1 = cachedHash(fi1);
+    const std::optional<QByteArray> hash2 = hash1.has_value() ? cachedHash(fi2) : std::nullopt;
+    if(hash1.has_value() && hash2.has_value())
     {
-        fi1.close();
-        status = fi2.errorString();
+        qCInfo(kdiffMergeFileInfo) << "Using cached content hashes.";
+        bError = false;
+        bEqual = *hash1 == *hash2;
         return bEqual;
     }
-    qCInfo(kdiffMergeFileInfo) << "Comparing files...";
-    ProgressProxy::setInformation(i18nc("Status message", "Comparing file..."), 0, false);
-    typedef qint64 t_FileSize;
-    t_FileSize fullSize = fi1.size();
-    t_FileSize sizeLeft = fullSize;
 
-    ProgressProxy::setMaxNofSteps(fullSize / buf1.size());
+    // So are reflinked copies. Reading the extent maps flushes both files, so only after the cache.
+    if(bLocal && FileIdentity::hasSameExtents(fi1.absoluteFilePath(), fi2.absoluteFilePath()))
+    {
+        eIdentity = FileIdentity::eSharedExtents;
+        qCInfo(kdiffMergeFileInfo) << "Equal by file identity:" << eIdentity;
+        bError = false;
+        return true;
+    }
 
-    while(sizeLeft > 0 && !ProgressProxy::wasCancelled())
+    // A difference in a sample is certain, equal samples only make equal files likely.
+    if(gOptions->m_bDmSampledComparison && fi1.isLocal() && fi2.isLocal())
     {
-        qint64 len = std::min(sizeLeft, (t_FileSize)buf1.size());
-        if(len != fi1.read(&buf1[0], len))
+        const std::optional<bool> bSampledEqual = sampledComparison(fi1, fi2);
+        if(bSampledEqual.has_value())
         {
-            status = fi1.errorString();
-            fi1.close();
-            fi2.close();
-            return bEqual;
+            qCInfo(kdiffMergeFileInfo) << "Compared samples, equal:" << *bSampledEqual;
+            bError = false;
+            bSampled = *bSampledEqual;
+            return *bSampledEqual;
         }
+    }
 
-        if(len != fi2.read(&buf2[0], len))
-        {
-            status = fi2.errorString();
-            fi1.close();
-            fi2.close();
-            return bEqual;
-        }
+    return std::nullopt;
+}
+
+bool MergeFileInfos::fastFileComparison(
+    FileAccess& fi1, FileAccess& fi2,
+    bool& bError, QString& status, FileIdentity::Equality& eIdentity, bool& bSampled, bool bShowProgress)
+{
+    // The progress dialog may only be touched from the GUI thread.
+    std::optional<ProgressScope> pp;
+    if(bShowProgress)
+        pp.emplace();
+
+    const std::optional<bool> quickResult = quickFileComparison(fi1, fi2, bError, status, eIdentity, bSampled);
+    if(quickResult.has_value())
+        return *quickResult;
 
-        if(memcmp(&buf1[0], &buf2[0], len) != 0)
+    bool bEqual = false;
+    bError = !lockstepComparison({{&fi1, &fi2, &bEqual}}, status, bShowProgress);
+    return bEqual;
+}
+
+bool MergeFileInfos::threeWayFileComparison(QString& status, bool bShowProgress)
+{
+    std::optional<ProgressScope> pp;
+    if(bShowProgress)
+        pp.emplace();
+
+    bool bError = false;
+    std::vector<PairComparison> pairs;
+    const auto quickCheck = [this, &bError, &status, &pairs](FileAccess& fi1, FileAccess& fi2, bool& bEqual, FileIdentity::Equality& eIdentity, bool& bSampled) {
+        bool bPairError = false;
+        const std::optional<bool> quickResult = quickFileComparison(fi1, fi2, bPairError, status, eIdentity, bSampled);
+        if(quickResult.has_value())
         {
-            bError = false;
-            fi1.close();
-            fi2.close();
-            return bEqual;
+            bEqual = *quickResult;
+            bError = bError || bPairError;
         }
-        sizeLeft -= len;
-        ProgressProxy::step();
-    }
-    fi1.close();
-    fi2.close();
+        else
+            pairs.push_back({&fi1, &fi2, &bEqual});
+    };
 
-    // If the program really arrives here, then the files are really equal.
-    bError = false;
-    bEqual = true;
-    return bEqual;
+    // The order matters, lockstepComparison relies on it to skip B == C.
+    quickCheck(*getFileInfoA(), *getFileInfoB(), m_bEqualAB, m_eIdentityAB, m_bSampledAB);
+    quickCheck(*getFileInfoA(), *getFileInfoC(), m_bEqualAC, m_eIdentityAC, m_bSampledAC);
+    quickCheck(*getFileInfoB(), *getFileInfoC(), m_bEqualBC, m_eIdentityBC, m_bSampledBC);
+
+    if(!pairs.empty() && !lockstepComparison(pairs, status, bShowProgress))
+        bError = true;
+
+    return !bError;
 }
 
 void MergeFileInfos::updateAge()
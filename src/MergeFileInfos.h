@@ -13,7 +13,12 @@
 #include "DirectoryInfo.h"
 #include "diff.h"
 #include "fileaccess.h"
+#include "FileIdentity.h"
+#include "TypeUtils.h"
 
+#include <optional>
+
+#include <QByteArray>
 #include <QString>
 
 enum e_MergeOperation
@@ -83,18 +88,35 @@ class MergeFileInfos
     [[nodiscard]] bool isLinkC() const { return m_pFileInfoC != nullptr ? m_pFileInfoC->isSymLink() : false; }
     [[nodiscard]] bool hasLink() const { return isLinkA() || isLinkB() || isLinkC(); }
 
+    [[nodiscard]] bool hasSnapshot() const
+    {
+        return (m_pFileInfoA != nullptr && m_pFileInfoA->isSnapshot()) || (m_pFileInfoB != nullptr && m_pFileInfoB->isSnapshot()) ||
+               (m_pFileInfoC != nullptr && m_pFileInfoC->isSnapshot());
+    }
+
     [[nodiscard]] bool existsInA() const { return m_pFileInfoA != nullptr; }
     [[nodiscard]] bool existsInB() const { return m_pFileInfoB != nullptr; }
     [[nodiscard]] bool existsInC() const { return m_pFileInfoC != nullptr; }
 
     [[nodiscard]] bool conflictingFileTypes() const;
 
-    void sort(Qt::SortOrder order);
+    // Sorts the direct children unless that was already done for this generation of the sort order.
+    void sortChildren(Qt::SortOrder order, quint64 generation);
     [[nodiscard]] MergeFileInfos* parent() const { return m_pParent; }
     void setParent(MergeFileInfos* inParent) { m_pParent = inParent; }
     [[nodiscard]] const QList<MergeFileInfos*>& children() const { return m_children; }
-    void addChild(MergeFileInfos* child) { m_children.push_back(child); }
-    void clear() { m_children.clear(); }
+    void addChild(MergeFileInfos* child)
+    {
+        child->m_row = SafeInt<qint32>(m_children.size());
+        m_children.push_back(child);
+    }
+    // Position among the children of parent(), so the model doesn't have to search for it.
+    [[nodiscard]] qint32 row() const { return m_row; }
+    void clear()
+    {
+        m_children.clear();
+        m_sortGeneration = 0;
+    }
 
     [[nodiscard]] FileAccess* getFileInfoA() const { return m_pFileInfoA; }
     [[nodiscard]] FileAccess* getFileInfoB() const { return m_pFileInfoB; }
@@ -130,6 +152,22 @@ class MergeFileInfos
     [[nodiscard]] bool isEqualAC() const { return m_bEqualAC; }
     [[nodiscard]] bool isEqualBC() const { return m_bEqualBC; }
     bool compareFilesAndCalcAges(QStringList& errors, DirectoryMergeWindow* pDMW);
+    /*
+        compareFilesAndCalcAges split in two so the content comparison can run on a worker thread.
+        compareContents is thread safe when canCompareConcurrently() is true and bShowProgress is false.
+        With full analysis enabled analyzeContents takes its place, it is thread safe under the same condition.
+        calcAges must be called on the GUI thread once the comparison is done.
+    */
+    [[nodiscard]] bool canCompareConcurrently() const;
+    bool compareContents(QString& status, bool bShowProgress);
+    void analyzeContents(QStringList& errors);
+    void calcAges();
+
+    // Set while the contents are compared in the background, the item counts as different until then.
+    void setContentPending(const bool bPending) { m_bContentPending = bPending; }
+    [[nodiscard]] bool isContentPending() const { return m_bContentPending; }
+    // Takes the results of a background comparison that ran on a copy of this item.
+    void adoptComparison(const MergeFileInfos& other);
 
     void updateAge();
 
@@ -159,6 +197,27 @@ class MergeFileInfos
 
     [[nodiscard]] bool conflictingAges() const { return m_bConflictingAges; }
 
+    // Set when a subtree summary proved this item equal in all folders, its files are not compared.
+    void setInIdenticalSubtree();
+    [[nodiscard]] bool isInIdenticalSubtree() const { return m_bInIdenticalSubtree; }
+
+    // Names the pairs that were found equal from file system metadata or samples alone, for the status column.
+    [[nodiscard]] QString identityStatus() const;
+
+    /*
+        Rename detection pairs an item that is copied to one side with an equal file that is deleted there.
+        The target of the copy renames the file of its source instead, both keep their operations.
+    */
+    [[nodiscard]] MergeFileInfos* renameSource() const { return m_pRenameSource; }
+    [[nodiscard]] MergeFileInfos* renameTarget() const { return m_pRenameTarget; }
+    [[nodiscard]] MergeFileInfos* renamePartner() const { return m_pRenameSource != nullptr ? m_pRenameSource : m_pRenameTarget; }
+    void pairRename(MergeFileInfos* pSource);
+    // Dissolves the pair this item is part of, returns the former partner.
+    MergeFileInfos* unpairRename();
+
+    // Hash of the whole file, taken from the hash cache when possible. Thread safe, nullopt on a read error.
+    [[nodiscard]] static std::optional<QByteArray> contentHash(FileAccess& file);
+
   private:
     [[nodiscard]] e_Age nextAgeValue(e_Age age)
     {
@@ -178,13 +237,24 @@ class MergeFileInfos
         return age;
     }
 
-    bool fastFileComparison(FileAccess& fi1, FileAccess& fi2, bool& bError, QString& status);
+    // For snapshot entries, which have nothing but their hash. Hashes the other file if needed.
+    [[nodiscard]] static bool hashComparison(FileAccess& fi1, FileAccess& fi2, bool& bError, QString& status);
+    // Decides without reading the files where possible. Returns nullopt if the contents must be compared.
+    // bSampled is set if the files were only found equal by samples, see Options::m_bDmSampledComparison.
+    [[nodiscard]] std::optional<bool> quickFileComparison(FileAccess& fi1, FileAccess& fi2, bool& bError, QString& status, FileIdentity::Equality& eIdentity, bool& bSampled);
+    bool fastFileComparison(FileAccess& fi1, FileAccess& fi2, bool& bError, QString& status, FileIdentity::Equality& eIdentity, bool& bSampled, bool bShowProgress);
+    bool threeWayFileComparison(QString& status, bool bShowProgress);
+    void updateEqualFromDiffStatus();
     void setAgeA(const e_Age inAge) { m_ageA = inAge; }
     void setAgeB(const e_Age inAge) { m_ageB = inAge; }
     void setAgeC(const e_Age inAge) { m_ageC = inAge; }
 
     MergeFileInfos* m_pParent = nullptr;
+    MergeFileInfos* m_pRenameSource = nullptr;
+    MergeFileInfos* m_pRenameTarget = nullptr;
     QList<MergeFileInfos*> m_children;
+    qint32 m_row = 0;
+    quint64 m_sortGeneration = 0;
 
     FileAccess* m_pFileInfoA = nullptr;
     FileAccess* m_pFileInfoB = nullptr;
@@ -205,6 +275,16 @@ class MergeFileInfos
     bool m_bEqualAC = false;
     bool m_bEqualBC = false;
     bool m_bConflictingAges = false; // Equal age but files are not!
+    bool m_bContentPending = false;
+    bool m_bInIdenticalSubtree = false;
+
+    FileIdentity::Equality m_eIdentityAB = FileIdentity::eUnknown;
+    FileIdentity::Equality m_eIdentityAC = FileIdentity::eUnknown;
+    FileIdentity::Equality m_eIdentityBC = FileIdentity::eUnknown;
+    // Equal by samples only, the files weren't read completely.
+    bool m_bSampledAB = false;
+    bool m_bSampledAC = false;
+    bool m_bSampledBC = false;
 };
 
 QTextStream& operator<<(QTextStream& ts, MergeFileInfos& mfi);
@@ -0,0 +1,171 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "MergePrefetch.h"
+
+#include "IoWorkerPool.h"
+
+#include <algorithm>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include <QFileInfo>
+
+bool MergePrefetch::Files::operator<(const Files& other) const
+{
+    return std::tie(m_fileA, m_fileB, m_fileC) < std::tie(other.m_fileA, other.m_fileB, other.m_fileC);
+}
+
+bool MergePrefetch::Files::operator==(const Files& other) const
+{
+    return m_fileA == other.m_fileA && m_fileB == other.m_fileB && m_fileC == other.m_fileC;
+}
+
+MergePrefetch::MergePrefetch() = default;
+
+MergePrefetch::~MergePrefetch()
+{
+    stop();
+}
+
+std::vector<MergePrefetch::Stamp> MergePrefetch::stampsOf(const Files& files)
+{
+    std::vector<Stamp> stamps;
+    for(const QString* pFile: {&files.m_fileA, &files.m_fileB, &files.m_fileC})
+    {
+        Stamp stamp;
+        if(!pFile->isEmpty())
+        {
+            const QFileInfo fileInfo(*pFile);
+            stamp.m_size = fileInfo.exists() ? fileInfo.size() : -1;
+            stamp.m_lastModified = fileInfo.lastModified();
+        }
+        stamps.push_back(stamp);
+    }
+    return stamps;
+}
+
+qint64 MergePrefetch::memoryInUse() const
+{
+    qint64 memory = 0;
+    for(const auto& [files, entry]: m_entries)
+        memory += entry.m_memory;
+    return memory;
+}
+
+void MergePrefetch::prefetch(const std::vector<Files>& upcoming)
+{
+    const QByteArray optionsKey = FullAnalysis::optionsKey();
+    // The jobs of unfinished ones still write to them.
+    for(auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if(it->second.m_bFinished &&
+           (it->second.m_optionsKey != optionsKey || std::find(upcoming.begin(), upcoming.end(), it->first) == upcoming.end()))
+            it = m_entries.erase(it);
+        else
+            ++it;
+    }
+
+    if(m_pPool != nullptr)
+        return;
+
+    std::unique_ptr<IoWorkerPool> pPool = std::make_unique<IoWorkerPool>();
+    // Diffing keeps a core busy, leave the others to the user.
+    pPool->setMaxThreads(2);
+
+    qint64 memory = memoryInUse();
+    for(const Files& files: upcoming)
+    {
+        if(m_entries.count(files) != 0)
+            continue;
+
+        Entry entry;
+        // Taken before the files are read, a change meanwhile is noticed in take().
+        entry.m_stamps = stampsOf(files);
+        entry.m_optionsKey = optionsKey;
+        for(const Stamp& stamp: entry.m_stamps)
+            entry.m_memory += estimatedMemory(std::max(stamp.m_size, (qint64)0));
+        // Nearest first, a later merge doesn't get ahead of one that doesn't fit.
+        if(memory + entry.m_memory > m_maxMemory)
+            break;
+        memory += entry.m_memory;
+
+        entry.m_pResult = std::make_shared<Result>();
+        entry.m_jobId = pPool->add({}, [files, pResult = entry.m_pResult]() {
+            try
+            {
+                pResult->m_pComparison = FullAnalysis::compare(files.m_fileA, files.m_fileB, files.m_fileC);
+            }
+            catch(const std::bad_alloc&)
+            {
+                // Left to the merge window, it reports it.
+                pResult->m_pComparison.reset();
+            }
+        }, [this, files]() {
+            const auto it = m_entries.find(files);
+            if(it != m_entries.end())
+                it->second.m_bFinished = true;
+            return true;
+        });
+        m_entries.emplace(files, std::move(entry));
+    }
+
+    if(pPool->count() == 0)
+        return;
+
+    m_pPool = std::move(pPool);
+    m_pPool->start();
+}
+
+bool MergePrefetch::processDone()
+{
+    if(m_pPool == nullptr)
+        return false;
+    if(m_pPool->processDone(0))
+        return true;
+
+    m_pPool.reset();
+    return false;
+}
+
+std::unique_ptr<FullAnalysis::Comparison> MergePrefetch::take(const Files& files)
+{
+    auto it = m_entries.find(files);
+    if(it == m_entries.end())
+        return nullptr;
+
+    // Normally long finished. Otherwise the part that is done is still worth waiting for.
+    if(!it->second.m_bFinished && m_pPool != nullptr)
+        m_pPool->waitFor({it->second.m_jobId});
+
+    const Entry entry = std::move(it->second);
+    m_entries.erase(it);
+    if(!entry.m_bFinished || entry.m_pResult->m_pComparison == nullptr || !entry.m_pResult->m_pComparison->m_errors.isEmpty())
+        return nullptr;
+    if(stampsOf(files) != entry.m_stamps || FullAnalysis::optionsKey() != entry.m_optionsKey)
+        return nullptr;
+
+    return std::move(entry.m_pResult->m_pComparison);
+}
+
+void MergePrefetch::stop()
+{
+    if(m_pPool == nullptr)
+        return;
+
+    m_pPool->stop();
+    m_pPool.reset();
+}
+
+void MergePrefetch::clear()
+{
+    stop();
+    m_entries.clear();
+}
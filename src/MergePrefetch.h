@@ -0,0 +1,108 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef MERGEPREFETCH_H
+#define MERGEPREFETCH_H
+
+#include "FullAnalysis.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+class IoWorkerPool;
+
+/*
+    Loads and diffs the files of the next manual merges of a folder merge on worker threads,
+    while the user works on the current one. Moving on then shows the result at once.
+
+    Jobs run in rounds on an IoWorkerPool: prefetch() starts one for the upcoming merges that
+    aren't prepared yet, as far as the memory limit allows. Call processDone() from a timer and
+    prefetch() again when the round is over. Only local files, see FullAnalysis.
+
+    The jobs read the options, they must not change while a round runs: clear() first. Results
+    prepared with other values of the options that matter are dropped in any case.
+*/
+class MergePrefetch
+{
+  public:
+    struct Files
+    {
+        QString m_fileA;
+        QString m_fileB;
+        QString m_fileC;
+
+        bool operator<(const Files& other) const;
+        bool operator==(const Files& other) const;
+    };
+
+    MergePrefetch();
+    ~MergePrefetch();
+
+    MergePrefetch(const MergePrefetch&) = delete;
+    MergePrefetch& operator=(const MergePrefetch&) = delete;
+
+    void setMaxMemory(qint64 maxMemory) { m_maxMemory = maxMemory; }
+
+    // The merges coming next, nearest first. Prepared files not among them are dropped.
+    void prefetch(const std::vector<Files>& upcoming);
+    // Takes the results of finished jobs. Returns false once the round is over.
+    bool processDone();
+    [[nodiscard]] bool isRunning() const { return m_pPool != nullptr; }
+
+    /*
+        The prepared comparison, waits for it if it is still being prepared. Null if it never
+        was, if that failed or if one of the files changed since.
+    */
+    [[nodiscard]] std::unique_ptr<FullAnalysis::Comparison> take(const Files& files);
+    [[nodiscard]] bool contains(const Files& files) const { return m_entries.count(files) != 0; }
+
+    // Waits for running jobs and drops everything.
+    void clear();
+
+    // What the loaded files and their diff take, roughly.
+    [[nodiscard]] static qint64 estimatedMemory(qint64 fileSize) { return 6 * fileSize; }
+    [[nodiscard]] qint64 memoryInUse() const;
+
+  private:
+    struct Stamp
+    {
+        qint64 m_size = 0;
+        QDateTime m_lastModified;
+
+        bool operator==(const Stamp& other) const { return m_size == other.m_size && m_lastModified == other.m_lastModified; }
+    };
+    struct Result
+    {
+        std::unique_ptr<FullAnalysis::Comparison> m_pComparison;
+    };
+    struct Entry
+    {
+        size_t m_jobId = 0;
+        bool m_bFinished = false;
+        qint64 m_memory = 0;
+        std::vector<Stamp> m_stamps;
+        // See FullAnalysis::optionsKey.
+        QByteArray m_optionsKey;
+        std::shared_ptr<Result> m_pResult;
+    };
+
+    [[nodiscard]] static std::vector<Stamp> stampsOf(const Files& files);
+    void stop();
+
+    std::unique_ptr<IoWorkerPool> m_pPool;
+    std::map<Files, Entry> m_entries;
+    qint64 m_maxMemory = 512 * 1024 * 1024;
+};
+
+#endif /* MERGEPREFETCH_H */
@@ -33,6 +33,17 @@ ProgressScope::~ProgressScope()
     ProgressProxy::pop(false);
 }
 
+ProgressMute::ProgressMute():
+    m_bWasActive(s_bActive)
+{
+    s_bActive = true;
+}
+
+ProgressMute::~ProgressMute()
+{
+    s_bActive = m_bWasActive;
+}
+
 void ProgressProxy::setInformation(const QString& info, bool bRedrawUpdate)
 {
     setInformationSig(info, bRedrawUpdate);
@@ -31,6 +31,27 @@ class ProgressScope
     ~ProgressScope();
 };
 
+/*
+    Drops all progress reported from the current thread for as long as it lives. Lets worker threads
+    run code written for the GUI thread without disturbing the progress dialog. wasCancelled still works.
+*/
+class ProgressMute
+{
+  public:
+    ProgressMute();
+    ~ProgressMute();
+
+    ProgressMute(const ProgressMute&) = delete;
+    ProgressMute& operator=(const ProgressMute&) = delete;
+
+    [[nodiscard]] static bool isActive() { return s_bActive; }
+
+  private:
+    bool m_bWasActive;
+
+    inline static thread_local bool s_bActive = false;
+};
+
 class ProgressProxy
 {
   public:
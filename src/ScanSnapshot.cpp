@@ -0,0 +1,417 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "ScanSnapshot.h"
+
+#include "compat.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace {
+constexpr char snapshotMagic[8] = {'K', 'D', '3', 'S', 'N', 'A', 'P', '\0'};
+constexpr quint32 snapshotVersion = 1;
+constexpr qsizetype hashSize = 32;
+} // namespace
+
+// Little endian on disk, mapped as is.
+struct ScanSnapshot::Header
+{
+    char m_magic[8];
+    quint32_le m_version;
+    qint32_le m_count;
+    qint64_le m_created;
+    qint64_le m_stringsOffset;
+    quint32_le m_rootOffset;
+    quint32_le m_rootLength;
+};
+
+struct ScanSnapshot::Entry
+{
+    qint32_le m_parent;
+    quint32_le m_nameOffset;
+    quint32_le m_nameLength;
+    quint32_le m_flags;
+    qint64_le m_size;
+    qint64_le m_modified;
+    quint32_le m_linkOffset;
+    quint32_le m_linkLength;
+    uchar m_hash[hashSize];
+};
+
+std::optional<QByteArray> ScanSnapshot::serialize(const QString& rootPath, const std::vector<Record>& records, QString& errorText)
+{
+    static_assert(sizeof(Header) == 40, "The snapshot header must not have padding.");
+    static_assert(sizeof(Entry) == 72, "Snapshot entries must not have padding.");
+
+    if(records.size() > (size_t)std::numeric_limits<qint32>::max())
+    {
+        errorText = i18nc("@info:status", "Too many entries for a snapshot.");
+        return std::nullopt;
+    }
+
+    // All names go into one block after the entries, offsets are relative to its start.
+    QByteArray strings;
+    const auto addString = [&strings](const QString& text, quint32_le& offset, quint32_le& length) {
+        const QByteArray utf8 = text.toUtf8();
+        offset = (quint32)strings.size();
+        length = (quint32)utf8.size();
+        strings.append(utf8);
+    };
+
+    Header header;
+    std::memcpy(header.m_magic, snapshotMagic, sizeof(snapshotMagic));
+    header.m_version = snapshotVersion;
+    header.m_count = (qint32)records.size();
+    header.m_created = QDateTime::currentMSecsSinceEpoch();
+    header.m_stringsOffset = (qint64)sizeof(Header) + (qint64)records.size() * (qint64)sizeof(Entry);
+    addString(rootPath, header.m_rootOffset, header.m_rootLength);
+
+    std::vector<Entry> entries(records.size());
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        const Record& record = records[i];
+        Entry& entry = entries[i];
+        if(record.m_parent >= (qint32)i)
+        {
+            errorText = i18nc("@info:status", "A folder must be saved before its contents.");
+            return std::nullopt;
+        }
+
+        entry.m_parent = record.m_parent < 0 ? -1 : record.m_parent;
+        addString(record.m_name, entry.m_nameOffset, entry.m_nameLength);
+        entry.m_flags = record.m_flags & ~(quint32)eHasHash;
+        entry.m_size = record.m_size;
+        entry.m_modified = record.m_modified;
+        addString(record.m_linkTarget, entry.m_linkOffset, entry.m_linkLength);
+        std::memset(entry.m_hash, 0, hashSize);
+        if(record.m_hash.size() == hashSize)
+        {
+            std::memcpy(entry.m_hash, record.m_hash.constData(), hashSize);
+            entry.m_flags = entry.m_flags | eHasHash;
+        }
+
+        if(strings.size() > (qsizetype)std::numeric_limits<quint32>::max())
+        {
+            errorText = i18nc("@info:status", "Too many entries for a snapshot.");
+            return std::nullopt;
+        }
+    }
+
+    QByteArray data;
+    data.reserve(header.m_stringsOffset + strings.size());
+    data.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+    data.append(reinterpret_cast<const char*>(entries.data()), (qsizetype)(entries.size() * sizeof(Entry)));
+    data.append(strings);
+    return data;
+}
+
+bool ScanSnapshot::save(const QString& fileName, const QString& rootPath, const std::vector<Record>& records, QString& errorText)
+{
+    const std::optional<QByteArray> data = serialize(rootPath, records, errorText);
+    if(!data.has_value())
+        return false;
+
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", fileName, file.errorString());
+        return false;
+    }
+
+    file.write(*data);
+    if(!file.commit())
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error writing to %1. %2", fileName, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ScanSnapshot::isSnapshotFile(const QString& fileName)
+{
+    return fileName.endsWith(fileExtension()) || isManifestFile(fileName);
+}
+
+bool ScanSnapshot::isManifestFile(const QString& fileName)
+{
+    return fileName.endsWith(QStringLiteral(".sha256"), Qt::CaseInsensitive) || fileName.endsWith(QStringLiteral(".sha256sum"), Qt::CaseInsensitive) ||
+           fileName.endsWith(QStringLiteral("SHA256SUMS"), Qt::CaseInsensitive);
+}
+
+std::shared_ptr<const ScanSnapshot> ScanSnapshot::open(const QString& fileName, QString& errorText)
+{
+    if(isManifestFile(fileName))
+        return readManifest(fileName, errorText);
+
+    std::shared_ptr<ScanSnapshot> pSnapshot(new ScanSnapshot());
+    QFile& file = pSnapshot->m_file;
+    file.setFileName(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", fileName, file.errorString());
+        return nullptr;
+    }
+
+    const qint64 fileSize = file.size();
+    const uchar* pData = fileSize >= (qint64)sizeof(Header) ? file.map(0, fileSize) : nullptr;
+    if(fileSize >= (qint64)sizeof(Header) && pData == nullptr)
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", fileName, file.errorString());
+        return nullptr;
+    }
+
+    if(!pSnapshot->attach(pData, fileSize))
+    {
+        errorText = i18nc("@info:status %1 is the path", "%1 is no valid folder snapshot.", fileName);
+        return nullptr;
+    }
+    return pSnapshot;
+}
+
+std::shared_ptr<const ScanSnapshot> ScanSnapshot::readManifest(const QString& fileName, QString& errorText)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errorText = i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", fileName, file.errorString());
+        return nullptr;
+    }
+
+    std::vector<Record> records;
+    // Folders only appear as part of the paths, each is made once when first seen.
+    QHash<QString, qint32> indexOf;
+    const auto addRecord = [&records, &indexOf](const QString& path, qint32 parentIndex, quint32 flags) -> qint32 {
+        const auto it = indexOf.constFind(path);
+        if(it != indexOf.constEnd())
+            return it.value();
+
+        Record& record = records.emplace_back();
+        record.m_parent = parentIndex;
+        record.m_name = path.mid(path.lastIndexOf(u'/') + 1);
+        record.m_flags = flags | eNoMetaData | (record.m_name.startsWith(u'.') ? eHidden : 0);
+        const qint32 index = (qint32)records.size() - 1;
+        indexOf.insert(path, index);
+        return index;
+    };
+
+    while(!file.atEnd())
+    {
+        const std::optional<std::pair<QByteArray, QString>> line = parseManifestLine(file.readLine());
+        if(!line.has_value())
+            continue;
+
+        const auto& [hash, path] = *line;
+        // A file listed twice keeps its first hash, a path that is also a folder is left out.
+        if(indexOf.contains(path))
+            continue;
+
+        qint32 parentIndex = -1;
+        bool bBelowFile = false;
+        for(qsizetype slash = path.indexOf(u'/'); slash >= 0 && !bBelowFile; slash = path.indexOf(u'/', slash + 1))
+        {
+            parentIndex = addRecord(path.left(slash), parentIndex, eDir);
+            bBelowFile = (records[parentIndex].m_flags & eDir) == 0;
+        }
+        if(bBelowFile)
+            continue;
+
+        const qint32 fileIndex = addRecord(path, parentIndex, eFile);
+        records[fileIndex].m_hash = hash;
+    }
+
+    if(records.empty())
+    {
+        errorText = i18nc("@info:status %1 is the path", "%1 contains no SHA-256 checksums.", fileName);
+        return nullptr;
+    }
+
+    // Paths in the manifest are relative to where it was made, usually its own folder.
+    std::optional<QByteArray> data = serialize(QFileInfo(fileName).absolutePath(), records, errorText);
+    if(!data.has_value())
+        return nullptr;
+
+    std::shared_ptr<ScanSnapshot> pSnapshot(new ScanSnapshot());
+    pSnapshot->m_buffer = std::move(*data);
+    if(!pSnapshot->attach(reinterpret_cast<const uchar*>(pSnapshot->m_buffer.constData()), pSnapshot->m_buffer.size()))
+    {
+        errorText = i18nc("@info:status %1 is the path", "%1 is no valid folder snapshot.", fileName);
+        return nullptr;
+    }
+    return pSnapshot;
+}
+
+/*
+    Both formats sha256sum writes:
+        <hash>  <path>      text mode, or '*' instead of the second space in binary mode
+        SHA256 (<path>) = <hash>   with --tag
+    A line starting with '\' has '\\' and '\n' escaped in the path.
+*/
+std::optional<std::pair<QByteArray, QString>> ScanSnapshot::parseManifestLine(QByteArray line)
+{
+    while(line.endsWith('\n') || line.endsWith('\r'))
+        line.chop(1);
+
+    const bool bEscaped = line.startsWith('\\');
+    if(bEscaped)
+        line.remove(0, 1);
+
+    QByteArray hexHash;
+    QByteArray path;
+    if(line.startsWith("SHA256 ("))
+    {
+        const qsizetype end = line.lastIndexOf(") = ");
+        if(end < 0)
+            return std::nullopt;
+        path = line.mid(8, end - 8);
+        hexHash = line.mid(end + 4);
+    }
+    else
+    {
+        if(line.size() < 2 * hashSize + 2 || line[2 * hashSize] != ' ' || (line[2 * hashSize + 1] != ' ' && line[2 * hashSize + 1] != '*'))
+            return std::nullopt;
+        hexHash = line.left(2 * hashSize);
+        path = line.mid(2 * hashSize + 2);
+    }
+
+    if(hexHash.size() != 2 * hashSize)
+        return std::nullopt;
+    const QByteArray hash = QByteArray::fromHex(hexHash);
+    // fromHex skips anything that isn't a hex digit.
+    if(hash.size() != hashSize || hash.toHex() != hexHash.toLower())
+        return std::nullopt;
+
+    if(bEscaped)
+    {
+        QByteArray unescaped;
+        for(qsizetype i = 0; i < path.size(); ++i)
+        {
+            if(path[i] == '\\' && i + 1 < path.size())
+            {
+                ++i;
+                unescaped.append(path[i] == 'n' ? '\n' : path[i]);
+            }
+            else
+                unescaped.append(path[i]);
+        }
+        path = unescaped;
+    }
+
+    QString fileName = QFile::decodeName(path);
+    while(fileName.startsWith(QLatin1String("./")))
+        fileName.remove(0, 2);
+    // Absolute paths and paths out of the manifest's folder can't be placed in the tree.
+    if(fileName.startsWith(u'/') || fileName == QLatin1String("..") || fileName.startsWith(QLatin1String("../")) || fileName.contains(QLatin1String("/../")) ||
+       fileName.contains(QLatin1String("//")) || fileName.endsWith(u'/'))
+        return std::nullopt;
+
+    return std::make_pair(hash, fileName);
+}
+
+bool ScanSnapshot::attach(const uchar* pData, qint64 size)
+{
+    if(pData == nullptr || size < (qint64)sizeof(Header))
+        return false;
+
+    m_pData = pData;
+    const Header& h = header();
+    if(std::memcmp(h.m_magic, snapshotMagic, sizeof(snapshotMagic)) != 0 || h.m_version != snapshotVersion || h.m_count < 0 ||
+       h.m_stringsOffset != (qint64)sizeof(Header) + (qint64)h.m_count * (qint64)sizeof(Entry) || h.m_stringsOffset > size)
+        return false;
+
+    m_count = h.m_count;
+    m_stringsOffset = h.m_stringsOffset;
+    m_stringsSize = size - h.m_stringsOffset;
+
+    // Checked once here, so a damaged file can't make the accessors read outside the mapping.
+    bool bValid = isValidString(h.m_rootOffset, h.m_rootLength);
+    for(qint32 i = 0; bValid && i < m_count; ++i)
+    {
+        const Entry& e = entry(i);
+        bValid = e.m_parent >= -1 && e.m_parent < i && isValidString(e.m_nameOffset, e.m_nameLength) && isValidString(e.m_linkOffset, e.m_linkLength);
+    }
+    return bValid;
+}
+
+QString ScanSnapshot::rootPath() const
+{
+    return string(header().m_rootOffset, header().m_rootLength);
+}
+
+QDateTime ScanSnapshot::created() const
+{
+    return QDateTime::fromMSecsSinceEpoch(header().m_created);
+}
+
+qint32 ScanSnapshot::parent(qint32 index) const
+{
+    return entry(index).m_parent;
+}
+
+QString ScanSnapshot::name(qint32 index) const
+{
+    return string(entry(index).m_nameOffset, entry(index).m_nameLength);
+}
+
+quint32 ScanSnapshot::flags(qint32 index) const
+{
+    return entry(index).m_flags;
+}
+
+qint64 ScanSnapshot::size(qint32 index) const
+{
+    return entry(index).m_size;
+}
+
+QDateTime ScanSnapshot::modified(qint32 index) const
+{
+    return QDateTime::fromMSecsSinceEpoch(entry(index).m_modified);
+}
+
+QString ScanSnapshot::linkTarget(qint32 index) const
+{
+    return string(entry(index).m_linkOffset, entry(index).m_linkLength);
+}
+
+std::optional<QByteArray> ScanSnapshot::hash(qint32 index) const
+{
+    const Entry& e = entry(index);
+    if((e.m_flags & eHasHash) == 0)
+        return std::nullopt;
+
+    return QByteArray(reinterpret_cast<const char*>(e.m_hash), hashSize);
+}
+
+const ScanSnapshot::Header& ScanSnapshot::header() const
+{
+    return *reinterpret_cast<const Header*>(m_pData);
+}
+
+const ScanSnapshot::Entry& ScanSnapshot::entry(qint32 index) const
+{
+    assert(index >= 0 && index < m_count);
+    return reinterpret_cast<const Entry*>(m_pData + sizeof(Header))[index];
+}
+
+bool ScanSnapshot::isValidString(quint32 offset, quint32 length) const
+{
+    return (qint64)offset + (qint64)length <= m_stringsSize;
+}
+
+QString ScanSnapshot::string(quint32 offset, quint32 length) const
+{
+    return QString::fromUtf8(reinterpret_cast<const char*>(m_pData + m_stringsOffset + offset), length);
+}
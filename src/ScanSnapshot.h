@@ -0,0 +1,115 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef SCANSNAPSHOT_H
+#define SCANSNAPSHOT_H
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+
+/*
+    A folder scan saved to a file: names, types, sizes, dates and SHA-256 content hashes of all
+    entries, but no contents. The file is a table of fixed size entries followed by the names,
+    it is mapped into memory and names and dates are only decoded when asked for. Opening a
+    snapshot still goes over the whole table once to check the parent index and string offsets
+    of every entry, so a damaged file can't make the accessors read outside the mapping.
+
+    FileAccess opens files ending in fileExtension() as read-only folders, usable as A, B or C.
+    Their files are compared by hash, they can't be read, copied or merged.
+
+    A checksum manifest as written by sha256sum is read the same way, see isManifestFile. It
+    is parsed into memory instead of mapped, and it has only paths and hashes.
+*/
+class ScanSnapshot
+{
+  public:
+    enum Flag : quint32
+    {
+        eFile = 0x1,
+        eDir = 0x2,
+        eSymLink = 0x4,
+        eBrokenLink = 0x8,
+        eHidden = 0x10,
+        eHasHash = 0x20,
+        eNoMetaData = 0x40 // Size and date unknown, from a checksum manifest
+    };
+
+    // One entry for save(). A folder must come before its contents.
+    struct Record
+    {
+        qint32 m_parent = -1; // Index of the folder it is in, -1 for the top level
+        QString m_name;
+        quint32 m_flags = 0;
+        qint64 m_size = 0;
+        qint64 m_modified = 0; // Milliseconds since epoch
+        QString m_linkTarget;
+        QByteArray m_hash; // SHA-256, empty if unknown
+    };
+
+    [[nodiscard]] static QString fileExtension() { return QStringLiteral(".kd3snap"); }
+    // A snapshot or a manifest, by name only.
+    [[nodiscard]] static bool isSnapshotFile(const QString& fileName);
+    // *.sha256, *.sha256sum and SHA256SUMS
+    [[nodiscard]] static bool isManifestFile(const QString& fileName);
+
+    static bool save(const QString& fileName, const QString& rootPath, const std::vector<Record>& records, QString& errorText);
+    // Returns nullptr and sets errorText if the file is no valid snapshot. Manifests are passed to readManifest.
+    [[nodiscard]] static std::shared_ptr<const ScanSnapshot> open(const QString& fileName, QString& errorText);
+    /*
+        Lines that aren't SHA-256 checksums are skipped like sha256sum --check does, as are
+        paths leading out of the manifest's folder. Fails only if no line is left.
+    */
+    [[nodiscard]] static std::shared_ptr<const ScanSnapshot> readManifest(const QString& fileName, QString& errorText);
+    // Hash and relative path of one manifest line.
+    [[nodiscard]] static std::optional<std::pair<QByteArray, QString>> parseManifestLine(QByteArray line);
+
+    // The folder the snapshot was taken of.
+    [[nodiscard]] QString rootPath() const;
+    [[nodiscard]] QDateTime created() const;
+
+    [[nodiscard]] qint32 count() const { return m_count; }
+    [[nodiscard]] qint32 parent(qint32 index) const;
+    [[nodiscard]] QString name(qint32 index) const;
+    [[nodiscard]] quint32 flags(qint32 index) const;
+    [[nodiscard]] qint64 size(qint32 index) const;
+    [[nodiscard]] QDateTime modified(qint32 index) const;
+    [[nodiscard]] QString linkTarget(qint32 index) const;
+    [[nodiscard]] std::optional<QByteArray> hash(qint32 index) const;
+
+  private:
+    struct Header;
+    struct Entry;
+
+    ScanSnapshot() = default;
+
+    [[nodiscard]] static std::optional<QByteArray> serialize(const QString& rootPath, const std::vector<Record>& records, QString& errorText);
+    // Checks the data and uses it from then on, it must live as long as this object.
+    [[nodiscard]] bool attach(const uchar* pData, qint64 size);
+
+    [[nodiscard]] const Header& header() const;
+    [[nodiscard]] const Entry& entry(qint32 index) const;
+    [[nodiscard]] bool isValidString(quint32 offset, quint32 length) const;
+    [[nodiscard]] QString string(quint32 offset, quint32 length) const;
+
+    QFile m_file;        // Mapped snapshot
+    QByteArray m_buffer; // or parsed manifest
+    const uchar* m_pData = nullptr;
+    qint64 m_stringsOffset = 0;
+    qint64 m_stringsSize = 0;
+    qint32 m_count = 0;
+};
+
+#endif /* SCANSNAPSHOT_H */
@@ -44,6 +44,7 @@ Optimizations: Skip unneeded steps.
 #include <algorithm>         // for min
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>            // for vector
 
 #include <QtGlobal>
@@ -69,6 +70,15 @@ void SourceData::reset()
     mErrors.clear();
 }
 
+void SourceData::takeDataFrom(SourceData& other)
+{
+    // Swapped, a moved from FileData has no buffers left to reset.
+    std::swap(m_normalData, other.m_normalData);
+    std::swap(m_lmppData, other.m_lmppData);
+    mEncoding = other.mEncoding;
+    mErrors = other.mErrors;
+}
+
 void SourceData::setFilename(const QString& filename)
 {
     if(filename.isEmpty())
@@ -53,6 +53,8 @@ class SourceData
     [[nodiscard]] bool isBinaryEqualWith(const std::shared_ptr<SourceData>& other) const;
 
     void reset();
+    // Takes what readAndPreprocess read into other, e.g. on a worker thread. Name and alias stay.
+    void takeDataFrom(SourceData& other);
 
     [[nodiscard]] bool isDir() const { return m_fileAccess.isDir(); }
 
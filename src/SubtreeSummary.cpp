@@ -0,0 +1,123 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include "SubtreeSummary.h"
+
+#include "ContentHashCache.h"
+#include "fileaccess.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <QCryptographicHash>
+
+namespace {
+// The key ContentHashCache::keyFor would find, from what the scan saw.
+std::optional<ContentHashCache::Key> scanKey(const FileAccess& entry)
+{
+    const std::optional<FileAccess::ScanIdentity>& identity = entry.scanIdentity();
+    if(!identity.has_value())
+        return std::nullopt;
+
+    ContentHashCache::Key key;
+    key.m_device = identity->m_device;
+    key.m_inode = identity->m_inode;
+    key.m_size = entry.size();
+    key.m_mtimeNs = identity->m_mtimeNs;
+    key.m_ctimeNs = identity->m_ctimeNs;
+    return key;
+}
+
+qint32 depth(const FileAccess& entry)
+{
+    qint32 result = 0;
+    for(const FileAccess* pParent = entry.parent(); pParent != nullptr; pParent = pParent->parent())
+        ++result;
+    return result;
+}
+} // namespace
+
+SubtreeSummary::Summaries SubtreeSummary::compute(const FileAccess& rootDir, const DirectoryList& dirList, ContentHashCache* pCache)
+{
+    // The digests of the entries of each folder, in listing order.
+    std::unordered_map<const FileAccess*, std::vector<std::pair<QString, QByteArray>>> children;
+    // Folders that have an entry without a digest.
+    std::unordered_set<const FileAccess*> unknown;
+
+    // Children first, so a folder's own summary is done before its parent needs it.
+    std::vector<std::pair<qint32, const FileAccess*>> byDepth;
+    byDepth.reserve(dirList.size());
+    for(const FileAccess& entry: dirList)
+        byDepth.emplace_back(depth(entry), &entry);
+    std::stable_sort(byDepth.begin(), byDepth.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    Summaries summaries;
+    const auto summarize = [&children, &unknown, &summaries](const FileAccess* pDir) {
+        if(unknown.count(pDir) != 0)
+            return;
+
+        std::vector<std::pair<QString, QByteArray>>& digests = children[pDir];
+        std::sort(digests.begin(), digests.end());
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        for(const std::pair<QString, QByteArray>& digest: digests)
+        {
+            hash.addData(digest.first.toUtf8());
+            hash.addData(QByteArrayView("\0", 1));
+            hash.addData(digest.second);
+        }
+        summaries[pDir] = hash.result();
+        children.erase(pDir);
+    };
+
+    for(const auto& [entryDepth, pEntry]: byDepth)
+    {
+        const FileAccess* pParent = pEntry->parent();
+        if(pParent == nullptr || unknown.count(pParent) != 0)
+            continue;
+
+        std::optional<QByteArray> digest;
+        // isNormal() would follow links, a symlink has no digest anyway.
+        if(pEntry->isSymLink() || (!pEntry->isFile() && !pEntry->isDir()))
+            digest = std::nullopt;
+        else if(pEntry->isDir())
+        {
+            // An empty folder never showed up as a parent.
+            if(unknown.count(pEntry) == 0 && summaries.count(pEntry) == 0)
+                summarize(pEntry);
+
+            auto it = summaries.find(pEntry);
+            if(it != summaries.end())
+                digest = QByteArray("d") + it->second;
+        }
+        else if(pEntry->isFile())
+        {
+            // A snapshot brings its own hashes.
+            const std::optional<ContentHashCache::Key> key = pEntry->isSnapshot() || pCache == nullptr ? std::nullopt : scanKey(*pEntry);
+            const std::optional<QByteArray> contentHash = pEntry->isSnapshot() ? pEntry->snapshotHash() : (key.has_value() ? pCache->find(*key) : std::nullopt);
+            if(contentHash.has_value())
+                digest = QByteArray("f") + *contentHash;
+        }
+
+        if(!digest.has_value())
+        {
+            unknown.insert(pParent);
+            children.erase(pParent);
+            continue;
+        }
+
+        children[pParent].emplace_back(pEntry->fileName(), *digest);
+    }
+
+    summarize(&rootDir);
+    return summaries;
+}
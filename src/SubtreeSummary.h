@@ -0,0 +1,46 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef SUBTREESUMMARY_H
+#define SUBTREESUMMARY_H
+
+#include "DirectoryList.h"
+
+#include <unordered_map>
+
+#include <QByteArray>
+
+class ContentHashCache;
+class FileAccess;
+
+/*
+    Merkle style summaries of a scanned folder tree.
+
+    The summary of a folder is a hash over the names of its entries together with the content hash
+    of each file and the summary of each sub-folder. Two folders with the same summary hold the same
+    names and contents all the way down, so their subtrees don't need to be compared file by file.
+
+    File hashes come from the hash cache, looked up with the device, inode, size and times the folder
+    scan already got from statx, or from a snapshot. Nothing is stat'ed or read here, a summary says
+    what the tree looked like when it was listed. A folder only gets one if every file below it has
+    a hash that way. Symbolic links and special files are never summarized, their comparison depends
+    on the options. Entries listed without LocalDirectoryScanner have no scan data and no summary.
+
+    Thread safe, the three folders of a comparison can be summarized at the same time.
+*/
+class SubtreeSummary
+{
+  public:
+    using Summaries = std::unordered_map<const FileAccess*, QByteArray>;
+
+    // rootDir is the folder dirList was listed from, it is summarized too. pCache may be null for snapshots.
+    [[nodiscard]] static Summaries compute(const FileAccess& rootDir, const DirectoryList& dirList, ContentHashCache* pCache);
+};
+
+#endif /* SUBTREESUMMARY_H */
@@ -28,7 +28,6 @@ class Utils
       However if QUrl::isLocal returns false we get an empty string back.
     */
     static QString urlToString(const QUrl& url);
-    static bool wildcardMultiMatch(const QString& wildcard, const QString& testString, bool bCaseSensitive);
     static QString getArguments(QString cmd, QString& program, QStringList& args);
     static bool isEndOfLine(QChar c) { return c == u'\n'; } //interally all line endings are converted to '\n'
 
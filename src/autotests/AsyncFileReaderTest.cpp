@@ -0,0 +1,182 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QByteArray>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../AsyncFileReader.h"
+#include "TestUtils.h"
+
+Q_DECLARE_METATYPE(AsyncFileReader::Backend)
+
+class AsyncFileReaderTest: public QObject
+{
+    Q_OBJECT
+  private:
+    static constexpr qint64 chunkSize = 64 * 1024;
+
+    QTemporaryDir m_tempDir;
+
+  private Q_SLOTS:
+    void read_data()
+    {
+        QTest::addColumn<AsyncFileReader::Backend>("backend");
+        QTest::addColumn<qint32>("size");
+
+        // Where io_uring or threads aren't available the reader falls back, the data must be the same.
+        for(const AsyncFileReader::Backend backend: {AsyncFileReader::eAutomatic, AsyncFileReader::eIoUring, AsyncFileReader::eThreads, AsyncFileReader::eSynchronous})
+        {
+            QTest::addRow("backend %d, empty", backend) << backend << 0;
+            QTest::addRow("backend %d, one chunk", backend) << backend << 1000;
+            // More chunks than the queue is deep, the last one is short.
+            QTest::addRow("backend %d, many chunks", backend) << backend << (qint32)(11 * chunkSize + 17);
+        }
+    }
+
+    void read()
+    {
+        QFETCH(AsyncFileReader::Backend, backend);
+        QFETCH(qint32, size);
+
+        const QString path = m_tempDir.filePath(QStringLiteral("read%1_%2.bin").arg(backend).arg(size));
+        const QByteArray data = TestUtils::randomData(size);
+        QVERIFY(TestUtils::writeFile(path, data));
+
+        AsyncFileReader reader(chunkSize, 4, backend);
+        QVERIFY2(reader.open(path), qPrintable(reader.errorString()));
+        QCOMPARE(reader.size(), (qint64)size);
+        reader.setDropCache(true);
+
+        QByteArray result;
+        qint64 len = 0;
+        while(const char* pData = reader.next(len))
+        {
+            QVERIFY(len == chunkSize || result.size() + len == size);
+            result.append(pData, len);
+        }
+        QVERIFY2(reader.errorString().isEmpty(), qPrintable(reader.errorString()));
+        QCOMPARE(result, data);
+
+        QVERIFY(reader.open(path));
+        QByteArray all(size, '\0');
+        QVERIFY2(reader.readAll(all.data(), size), qPrintable(reader.errorString()));
+        QCOMPARE(all, data);
+    }
+
+    void smallFileIsReadSynchronously()
+    {
+        const QString path = m_tempDir.filePath("small.bin");
+        QVERIFY(TestUtils::writeFile(path, QByteArray(100, 'x')));
+
+        AsyncFileReader reader(chunkSize);
+        QVERIFY(reader.open(path));
+        QCOMPARE(reader.backend(), AsyncFileReader::eSynchronous);
+    }
+
+    void fileShorterThanExpected_data()
+    {
+        QTest::addColumn<AsyncFileReader::Backend>("backend");
+
+        QTest::newRow("automatic") << AsyncFileReader::eAutomatic;
+        QTest::newRow("threads") << AsyncFileReader::eThreads;
+        QTest::newRow("synchronous") << AsyncFileReader::eSynchronous;
+    }
+
+    void fileShorterThanExpected()
+    {
+        QFETCH(AsyncFileReader::Backend, backend);
+
+        const QString path = m_tempDir.filePath(QStringLiteral("short%1.bin").arg(backend));
+        const qint32 size = (qint32)(6 * chunkSize);
+        QVERIFY(TestUtils::writeFile(path, QByteArray(size, 'x')));
+
+        AsyncFileReader reader(chunkSize, 4, backend);
+        QVERIFY(reader.open(path));
+        QByteArray all(size + 10, '\0');
+        QVERIFY(!reader.readAll(all.data(), all.size()));
+        QVERIFY(!reader.errorString().isEmpty());
+
+        qint64 len = 0;
+        QVERIFY(reader.next(len) == nullptr);
+    }
+
+    void readersShareThread_data()
+    {
+        QTest::addColumn<AsyncFileReader::Backend>("backend");
+
+        QTest::newRow("io_uring") << AsyncFileReader::eIoUring;
+        QTest::newRow("threads") << AsyncFileReader::eThreads;
+    }
+
+    // Like a comparison, two files read in turns on one thread. Each must get its own chunks.
+    void readersShareThread()
+    {
+        QFETCH(AsyncFileReader::Backend, backend);
+
+        const QString pathA = m_tempDir.filePath(QStringLiteral("sharedA%1.bin").arg(backend));
+        const QString pathB = m_tempDir.filePath(QStringLiteral("sharedB%1.bin").arg(backend));
+        const QByteArray dataA = TestUtils::randomData((qint32)(9 * chunkSize + 5));
+        const QByteArray dataB = TestUtils::randomData((qint32)(7 * chunkSize));
+        QVERIFY(TestUtils::writeFile(pathA, dataA));
+        QVERIFY(TestUtils::writeFile(pathB, dataB));
+
+        AsyncFileReader readerA(chunkSize, 4, backend);
+        AsyncFileReader readerB(chunkSize, 4, backend);
+        QVERIFY(readerA.open(pathA));
+        QVERIFY(readerB.open(pathB));
+        // Closed while its reads run, the others go on.
+        {
+            AsyncFileReader readerC(chunkSize, 4, backend);
+            QVERIFY(readerC.open(pathA));
+            qint64 len = 0;
+            QVERIFY(readerC.next(len) != nullptr);
+        }
+
+        QByteArray resultA;
+        QByteArray resultB;
+        bool bDoneA = false;
+        bool bDoneB = false;
+        while(!bDoneA || !bDoneB)
+        {
+            qint64 len = 0;
+            if(!bDoneA)
+            {
+                const char* pData = readerA.next(len);
+                bDoneA = pData == nullptr;
+                resultA.append(pData, len);
+            }
+            if(!bDoneB)
+            {
+                const char* pData = readerB.next(len);
+                bDoneB = pData == nullptr;
+                resultB.append(pData, len);
+            }
+        }
+        QVERIFY2(readerA.errorString().isEmpty(), qPrintable(readerA.errorString()));
+        QVERIFY2(readerB.errorString().isEmpty(), qPrintable(readerB.errorString()));
+        QCOMPARE(resultA, dataA);
+        QCOMPARE(resultB, dataB);
+    }
+
+    void missingFile()
+    {
+        AsyncFileReader reader;
+        QVERIFY(!reader.open(m_tempDir.filePath("missing.bin")));
+        QVERIFY(!reader.errorString().isEmpty());
+
+        qint64 len = 0;
+        QVERIFY(reader.next(len) == nullptr);
+        QCOMPARE(len, 0);
+    }
+};
+
+QTEST_MAIN(AsyncFileReaderTest);
+
+#include "AsyncFileReaderTest.moc"
@@ -0,0 +1,168 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <limits>
+#include <optional>
+
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QtGlobal>
+
+#include "../ContentHashCache.h"
+#include "TestUtils.h"
+
+class ContentHashCacheTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    [[nodiscard]] QString cacheFile() const { return m_tempDir.filePath("contenthashes"); }
+
+    static ContentHashCache::Key key(quint64 inode)
+    {
+        ContentHashCache::Key key;
+        key.m_device = 1;
+        key.m_inode = inode;
+        key.m_size = 100;
+        key.m_mtimeNs = 1000;
+        key.m_ctimeNs = 2000;
+        return key;
+    }
+
+  private Q_SLOTS:
+    void init()
+    {
+        QFile::remove(cacheFile());
+    }
+
+    void roundTrip()
+    {
+        ContentHashCache cache(cacheFile());
+        cache.load();
+        QCOMPARE(cache.count(), (qint64)0);
+
+        cache.insert(key(1), "hash1");
+        cache.insert(key(2), "hash2");
+        QVERIFY(cache.save(100));
+
+        ContentHashCache reloaded(cacheFile());
+        reloaded.load();
+        QCOMPARE(reloaded.count(), (qint64)2);
+        QCOMPARE(reloaded.find(key(1)).value_or(QByteArray()), QByteArray("hash1"));
+        QCOMPARE(reloaded.find(key(2)).value_or(QByteArray()), QByteArray("hash2"));
+
+        // Any change in the metadata is a miss.
+        ContentHashCache::Key changed = key(1);
+        changed.m_ctimeNs += 1;
+        QVERIFY(!reloaded.find(changed).has_value());
+    }
+
+    void damagedFile()
+    {
+        QVERIFY(TestUtils::writeFile(cacheFile(), "not a hash cache"));
+
+        ContentHashCache cache(cacheFile());
+        cache.load();
+        QCOMPARE(cache.count(), (qint64)0);
+
+        cache.insert(key(1), "hash1");
+        QVERIFY(cache.save(100));
+        cache.load();
+        QCOMPARE(cache.count(), (qint64)1);
+    }
+
+    // A count the file can't hold must not be trusted.
+    void truncatedFile()
+    {
+        {
+            QFile file(cacheFile());
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            QDataStream stream(&file);
+            stream << (quint32)0x4b443348 << (quint32)1 << std::numeric_limits<qint64>::max();
+        }
+
+        ContentHashCache cache(cacheFile());
+        cache.load();
+        QCOMPARE(cache.count(), (qint64)0);
+    }
+
+    // Two processes working at the same time must not lose each others entries.
+    void concurrentWriters()
+    {
+        ContentHashCache first(cacheFile());
+        ContentHashCache second(cacheFile());
+        first.load();
+        second.load();
+
+        first.insert(key(1), "hash1");
+        second.insert(key(2), "hash2");
+        QVERIFY(first.save(100));
+        QVERIFY(second.save(100));
+
+        ContentHashCache reloaded(cacheFile());
+        reloaded.load();
+        QCOMPARE(reloaded.count(), (qint64)2);
+    }
+
+    void pruneLeastRecentlyUsed()
+    {
+        {
+            ContentHashCache cache(cacheFile());
+            cache.insert(key(1), "hash1");
+            cache.insert(key(2), "hash2");
+            QVERIFY(cache.save(100));
+        }
+
+        // Last use is tracked in seconds.
+        QThread::sleep(1);
+
+        ContentHashCache cache(cacheFile());
+        cache.load();
+        QVERIFY(cache.find(key(2)).has_value());
+        cache.insert(key(3), "hash3");
+        QVERIFY(cache.save(2));
+        QCOMPARE(cache.count(), (qint64)2);
+
+        ContentHashCache reloaded(cacheFile());
+        reloaded.load();
+        QVERIFY(!reloaded.find(key(1)).has_value());
+        QVERIFY(reloaded.find(key(2)).has_value());
+        QVERIFY(reloaded.find(key(3)).has_value());
+
+        QVERIFY(reloaded.save(0));
+        QCOMPARE(reloaded.count(), (qint64)0);
+    }
+
+    void keyFollowsFile()
+    {
+#ifdef Q_OS_WIN
+        QSKIP("No inode based keys on Windows.");
+#endif
+        const QString path = m_tempDir.filePath("data.txt");
+        QVERIFY(TestUtils::writeFile(path, "abc"));
+
+        const std::optional<ContentHashCache::Key> before = ContentHashCache::keyFor(path);
+        QVERIFY(before.has_value());
+        QCOMPARE(before->m_size, (qint64)3);
+        QVERIFY(ContentHashCache::keyFor(path) == before);
+
+        QVERIFY(TestUtils::writeFile(path, "abcd"));
+        QVERIFY(ContentHashCache::keyFor(path) != before);
+
+        QVERIFY(!ContentHashCache::keyFor(m_tempDir.filePath("missing.txt")).has_value());
+    }
+};
+
+QTEST_MAIN(ContentHashCacheTest);
+
+#include "ContentHashCacheTest.moc"
@@ -0,0 +1,117 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../DirectoryWalker.h"
+#include "../fileaccess.h"
+#include "../IgnoreList.h"
+
+class IgnoreListStub final: public IgnoreList
+{
+  public:
+    QString m_ignored;
+
+    void enterDir([[maybe_unused]] const QString& dir, [[maybe_unused]] const DirectoryList& directoryList) final {}
+    [[nodiscard]] bool matches([[maybe_unused]] const QString& dir, const QString& text, [[maybe_unused]] bool bCaseSensitive) const final
+    {
+        return text == m_ignored;
+    }
+};
+
+class DirectoryWalkerTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    static bool scan(FileAccess& dirAccess, DirectoryList& entries)
+    {
+        QDir dir(dirAccess.absoluteFilePath());
+        dir.setSorting(QDir::Name | QDir::DirsFirst);
+        dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+
+        const QFileInfoList fiList = dir.entryInfoList();
+        for(const QFileInfo& fi: fiList)
+        {
+            FileAccess fa;
+            fa.setFile(&dirAccess, fi);
+            entries.push_back(fa);
+        }
+        return dir.isReadable();
+    }
+
+    QStringList walk(qint32 maxThreads, const QString& fileAntiPattern, const QString& ignored)
+    {
+        FileAccess root(m_tempDir.path());
+        IgnoreListStub ignoreList;
+        ignoreList.m_ignored = ignored;
+
+        DirectoryWalker walker(&DirectoryWalkerTest::scan, ignoreList);
+        walker.setFilters("*", fileAntiPattern, "");
+        walker.setMaxThreads(maxThreads);
+
+        DirectoryList dirList;
+        if(!walker.walk(root, dirList))
+            return QStringList();
+
+        QStringList result;
+        for(const FileAccess& fa: dirList)
+            result.push_back(fa.fileRelPath());
+        return result;
+    }
+
+    void createFile(const QString& relPath)
+    {
+        QFile file(m_tempDir.filePath(relPath));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+  private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QDir root(m_tempDir.path());
+        QVERIFY(root.mkpath("b/c"));
+        QVERIFY(root.mkpath("d"));
+        createFile("a.txt");
+        createFile("e.cpp");
+        createFile("b/x.txt");
+        createFile("b/c/y.txt");
+        createFile("d/z.cpp");
+    }
+
+    void serialOrder()
+    {
+        const QStringList expected = {"b", "d", "a.txt", "e.cpp", "b/c", "b/x.txt", "b/c/y.txt", "d/z.cpp"};
+        QCOMPARE(walk(1, "", ""), expected);
+    }
+
+    void deterministic()
+    {
+        const QStringList expected = walk(1, "", "");
+        for(qint32 i = 0; i < 20; ++i)
+            QCOMPARE(walk(8, "", ""), expected);
+    }
+
+    void filters()
+    {
+        const QStringList expected = {"d", "a.txt"};
+        QCOMPARE(walk(4, "*.cpp", "b"), expected);
+    }
+};
+
+QTEST_MAIN(DirectoryWalkerTest);
+
+#include "DirectoryWalkerTest.moc"
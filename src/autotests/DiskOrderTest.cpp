@@ -0,0 +1,206 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../DiskOrder.h"
+#include "../IoWorkerPool.h"
+#include "TestUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class DiskOrderTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    static bool sameContents(const QString& path1, const QString& path2)
+    {
+        QFile file1(path1);
+        QFile file2(path2);
+        if(!file1.open(QIODevice::ReadOnly) || !file2.open(QIODevice::ReadOnly) || file1.size() != file2.size())
+            return false;
+
+        QByteArray buffer1(1024 * 1024, Qt::Uninitialized);
+        QByteArray buffer2(1024 * 1024, Qt::Uninitialized);
+        for(;;)
+        {
+            const qint64 len1 = file1.read(buffer1.data(), buffer1.size());
+            const qint64 len2 = file2.read(buffer2.data(), buffer2.size());
+            if(len1 != len2 || len1 < 0)
+                return false;
+            if(len1 == 0)
+                return true;
+            if(memcmp(buffer1.constData(), buffer2.constData(), (size_t)len1) != 0)
+                return false;
+        }
+    }
+
+    /*
+        Compares every file below A with the same file below B on an IoWorkerPool the way a folder
+        comparison schedules them, in tree order or in disk order. Returns the MiB read per second.
+    */
+    static double compareTrees(const QString& benchmarkDir, bool bDiskOrder)
+    {
+        const QDir dirA(benchmarkDir + QStringLiteral("/A"));
+        std::vector<QString> files;
+        QDirIterator it(dirA.path(), QDir::Files, QDirIterator::Subdirectories);
+        while(it.hasNext())
+            files.push_back(dirA.relativeFilePath(it.next()));
+        // The order of the tree as the folder view lists it.
+        std::sort(files.begin(), files.end());
+
+        IoWorkerPool pool;
+        if(bDiskOrder)
+        {
+            // Ordered and limited by the same code as a folder comparison with the option set.
+            std::vector<DiskOrder::File> diskFiles;
+            for(const QString& file: files)
+                diskFiles.push_back({dirA.filePath(file), QByteArrayLiteral("disk")});
+
+            const std::optional<std::vector<size_t>> order = DiskOrder::sorted(diskFiles);
+            if(order.has_value())
+            {
+                const std::vector<QString> treeOrder = files;
+                std::transform(order->begin(), order->end(), files.begin(), [&treeOrder](size_t index) { return treeOrder[index]; });
+            }
+            pool.setMaxPerDevice(DiskOrder::maxReadsPerDevice);
+        }
+
+        std::atomic<qint64> totalSize = 0;
+        std::atomic<qint32> nofDifferent = 0;
+        for(const QString& file: files)
+        {
+            const QString pathA = dirA.filePath(file);
+            const QString pathB = benchmarkDir + QStringLiteral("/B/") + file;
+            pool.add({QByteArrayLiteral("disk")}, [pathA, pathB, &totalSize, &nofDifferent]() {
+                totalSize += 2 * QFileInfo(pathA).size();
+                if(!sameContents(pathA, pathB))
+                    ++nofDifferent;
+            }, []() { return true; });
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        pool.run();
+        const qint64 elapsed = std::max(timer.elapsed(), (qint64)1);
+
+        qInfo() << "Files:" << files.size() << "Different:" << nofDifferent.load() << "MiB:" << totalSize.load() / (1024 * 1024) << "msecs:" << elapsed;
+        return (double)totalSize.load() / (1024 * 1024) / ((double)elapsed / 1000);
+    }
+
+  private Q_SLOTS:
+    void position()
+    {
+        const QString path = m_tempDir.filePath("data.bin");
+        QVERIFY(TestUtils::writeFile(path, QByteArray(64 * 1024, 'x')));
+
+#ifdef Q_OS_WIN
+        QVERIFY(!DiskOrder::of(path).has_value());
+#else
+        // Whether the file system reports extents is up to the file system, tmpfs doesn't.
+        const std::optional<DiskOrder::Position> position = DiskOrder::of(path);
+        QVERIFY(position.has_value());
+        QCOMPARE(DiskOrder::of(path)->m_offset, position->m_offset);
+#endif
+        QVERIFY(!DiskOrder::of(m_tempDir.filePath("missing.bin")).has_value());
+    }
+
+    void ordering()
+    {
+        const DiskOrder::Position physicalLow{1, true, 100};
+        const DiskOrder::Position physicalHigh{1, true, 5000};
+        const DiskOrder::Position inode{1, false, 2};
+        const DiskOrder::Position otherDevice{2, true, 0};
+
+        QVERIFY(physicalLow < physicalHigh);
+        QVERIFY(!(physicalHigh < physicalLow));
+        // Physical addresses first, inode numbers can't be compared with them.
+        QVERIFY(physicalHigh < inode);
+        QVERIFY(!(inode < physicalLow));
+        QVERIFY(inode < otherDevice);
+        QVERIFY(!(physicalLow < physicalLow));
+    }
+
+    void sorted()
+    {
+        std::vector<DiskOrder::File> files{{QString(), QByteArray()}, {m_tempDir.filePath("missing.bin"), QByteArray()}};
+        for(const QString& name: {QStringLiteral("1.bin"), QStringLiteral("2.bin"), QStringLiteral("3.bin")})
+        {
+            QVERIFY(TestUtils::writeFile(m_tempDir.filePath(name), TestUtils::randomData(16 * 1024)));
+            files.push_back({m_tempDir.filePath(name), QByteArrayLiteral("disk")});
+        }
+
+        const std::optional<std::vector<size_t>> order = DiskOrder::sorted(files);
+        QVERIFY(order.has_value());
+        QCOMPARE(order->size(), files.size());
+
+#ifdef Q_OS_WIN
+        // No positions at all, the order stays as it was.
+        for(size_t i = 0; i < files.size(); ++i)
+            QCOMPARE((*order)[i], i);
+#else
+        // Files without a position keep their order behind the others.
+        QCOMPARE((*order)[3], (size_t)0);
+        QCOMPARE((*order)[4], (size_t)1);
+        for(size_t i = 1; i < 3; ++i)
+            QVERIFY(!(*DiskOrder::of(files[(*order)[i]].m_localPath) < *DiskOrder::of(files[(*order)[i - 1]].m_localPath)));
+#endif
+    }
+
+    /*
+        Throughput on a tree with folders A and B holding the same files, see
+        test/disk_order_benchmark.sh which builds one on a loopback image. Skipped unless
+        KDIFF3_DISK_ORDER_BENCHMARK_DIR is set. Drop the page cache before each of them.
+    */
+    void benchmarkTreeOrder()
+    {
+        const QString benchmarkDir = qEnvironmentVariable("KDIFF3_DISK_ORDER_BENCHMARK_DIR");
+        if(benchmarkDir.isEmpty())
+            QSKIP("KDIFF3_DISK_ORDER_BENCHMARK_DIR not set.");
+
+        double throughput = 0;
+        QBENCHMARK_ONCE
+        {
+            throughput = compareTrees(benchmarkDir, false);
+        }
+        qInfo() << "MiB/s:" << throughput;
+    }
+
+    void benchmarkDiskOrder()
+    {
+        const QString benchmarkDir = qEnvironmentVariable("KDIFF3_DISK_ORDER_BENCHMARK_DIR");
+        if(benchmarkDir.isEmpty())
+            QSKIP("KDIFF3_DISK_ORDER_BENCHMARK_DIR not set.");
+
+        double throughput = 0;
+        QBENCHMARK_ONCE
+        {
+            throughput = compareTrees(benchmarkDir, true);
+        }
+        qInfo() << "MiB/s:" << throughput;
+    }
+};
+
+QTEST_MAIN(DiskOrderTest);
+
+#include "DiskOrderTest.moc"
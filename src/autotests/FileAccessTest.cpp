@@ -191,6 +191,11 @@ class FileAccessTest: public QObject
         r = fileData.open(QFile::ReadOnly);
         QVERIFY(r);
         QVERIFY(fileData.getStatusText().isEmpty());
+
+        QVERIFY(fileData.seek(2));
+        QCOMPARE(fileData.read(buf, 1), 1);
+        QCOMPARE(buf[0], '7');
+        fileData.close();
     }
 };
 
@@ -0,0 +1,93 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <memory>
+#include <vector>
+
+#include <QTest>
+#include <QThread>
+#include <QtGlobal>
+
+#include "../FileFilter.h"
+
+class FileFilterTest: public QObject
+{
+    Q_OBJECT
+  private Q_SLOTS:
+    void multiPatterns()
+    {
+        const FileFilter filter("*.cpp;*.h;Makefile", "moc_*;*_test.cpp", "CVS;.git;build*", true);
+
+        QVERIFY(filter.isFileIncluded("main.cpp"));
+        QVERIFY(filter.isFileIncluded("main.h"));
+        QVERIFY(filter.isFileIncluded("Makefile"));
+        QVERIFY(!filter.isFileIncluded("main.o"));
+        QVERIFY(!filter.isFileIncluded("moc_main.cpp"));
+        QVERIFY(!filter.isFileIncluded("main_test.cpp"));
+
+        QVERIFY(filter.isDirExcluded("CVS"));
+        QVERIFY(filter.isDirExcluded(".git"));
+        QVERIFY(filter.isDirExcluded("build-release"));
+        QVERIFY(!filter.isDirExcluded("src"));
+    }
+
+    // An empty list matches no name at all.
+    void emptyPatterns()
+    {
+        const FileFilter filter("*", "", "", true);
+
+        QVERIFY(filter.isFileIncluded("anything"));
+        QVERIFY(!filter.isDirExcluded("anything"));
+        QVERIFY(!FileFilter("", "", "", true).isFileIncluded("anything"));
+    }
+
+    void caseSensitivity()
+    {
+        const FileFilter caseSensitive("*.txt", "", "Build", true);
+        const FileFilter caseInsensitive("*.txt", "", "Build", false);
+
+        QVERIFY(caseSensitive.isCaseSensitive());
+        QVERIFY(!caseInsensitive.isCaseSensitive());
+        QVERIFY(!caseSensitive.isFileIncluded("README.TXT"));
+        QVERIFY(caseInsensitive.isFileIncluded("README.TXT"));
+        QVERIFY(!caseSensitive.isDirExcluded("build"));
+        QVERIFY(caseInsensitive.isDirExcluded("build"));
+    }
+
+    // The folder scan threads share one filter.
+    void concurrentUse()
+    {
+        const FileFilter filter("*.cpp;*.h", "*_test.cpp", "build", false);
+
+        constexpr qint32 nofThreads = 8;
+        std::vector<qint32> nofIncluded(nofThreads, 0);
+        std::vector<std::unique_ptr<QThread>> threads;
+        for(qint32 i = 0; i < nofThreads; ++i)
+        {
+            threads.emplace_back(QThread::create([&filter, &nofIncluded, i]() {
+                for(qint32 j = 0; j < 10000; ++j)
+                {
+                    if(filter.isFileIncluded(QStringLiteral("file%1.%2").arg(j).arg(j % 2 == 0 ? "CPP" : "o")))
+                        ++nofIncluded[i];
+                }
+            }));
+            threads.back()->start();
+        }
+
+        for(qint32 i = 0; i < nofThreads; ++i)
+        {
+            QVERIFY(threads[i]->wait());
+            QCOMPARE(nofIncluded[i], 5000);
+        }
+    }
+};
+
+QTEST_MAIN(FileFilterTest);
+
+#include "FileFilterTest.moc"
@@ -0,0 +1,92 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "../FileIdentity.h"
+#include "TestUtils.h"
+
+class FileIdentityTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+  private Q_SLOTS:
+    void copiesAreUnknown()
+    {
+        const QString path1 = m_tempDir.filePath("copy1.txt");
+        const QString path2 = m_tempDir.filePath("copy2.txt");
+        QVERIFY(TestUtils::writeFile(path1, "same contents"));
+        QVERIFY(TestUtils::writeFile(path2, "same contents"));
+
+        // Plain copies have to be read to be compared.
+        QCOMPARE(FileIdentity::check(path1, path2), FileIdentity::eUnknown);
+        QCOMPARE(FileIdentity::check(path1, m_tempDir.filePath("missing.txt")), FileIdentity::eUnknown);
+    }
+
+    void hardLink()
+    {
+#ifdef Q_OS_WIN
+        QSKIP("No inode based identity on Windows.");
+#else
+        const QString path = m_tempDir.filePath("original.txt");
+        const QString linkPath = m_tempDir.filePath("hardlink.txt");
+        QVERIFY(TestUtils::writeFile(path, "linked contents"));
+        QCOMPARE(::link(QFile::encodeName(path).constData(), QFile::encodeName(linkPath).constData()), 0);
+
+        QCOMPARE(FileIdentity::check(path, linkPath), FileIdentity::eSameFile);
+        QCOMPARE(FileIdentity::check(path, path), FileIdentity::eSameFile);
+#endif
+    }
+
+    void reflink()
+    {
+#ifndef Q_OS_LINUX
+        QSKIP("Extent maps are only read on Linux.");
+#else
+        const QString path = m_tempDir.filePath("source.bin");
+        const QString clonePath = m_tempDir.filePath("clone.bin");
+        QVERIFY(TestUtils::writeFile(path, QByteArray(256 * 1024, 'x')));
+
+        QFile source(path);
+        QFile clone(clonePath);
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QVERIFY(clone.open(QIODevice::WriteOnly));
+        if(::ioctl(clone.handle(), FICLONE, source.handle()) != 0)
+            QSKIP("The file system of the temporary folder can't reflink.");
+        clone.close();
+
+        QCOMPARE(FileIdentity::check(path, clonePath), FileIdentity::eSharedExtents);
+
+        // Changing one block unshares it.
+        QVERIFY(clone.open(QIODevice::ReadWrite));
+        QVERIFY(clone.seek(4096));
+        QCOMPARE(clone.write("y", 1), (qint64)1);
+        clone.close();
+        QCOMPARE(FileIdentity::check(path, clonePath), FileIdentity::eUnknown);
+#endif
+    }
+};
+
+QTEST_MAIN(FileIdentityTest);
+
+#include "FileIdentityTest.moc"
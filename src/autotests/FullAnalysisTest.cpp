@@ -0,0 +1,121 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <memory>
+#include <vector>
+
+#include <QDir>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QtGlobal>
+
+#include "../diff.h"
+#include "../FullAnalysis.h"
+#include "TestUtils.h"
+
+class FullAnalysisTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+  private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QVERIFY(TestUtils::writeMergeFiles(QDir(m_tempDir.path())));
+    }
+
+    void equalFiles()
+    {
+        TotalDiffStatus status;
+        QStringList errors;
+        FullAnalysis::run(m_tempDir.filePath("base.txt"), m_tempDir.filePath("copy.txt"), QString(), status, errors);
+
+        QVERIFY(errors.isEmpty());
+        QVERIFY(status.isBinaryEqualAB());
+        QCOMPARE(status.getUnsolvedConflicts(), 0);
+        QCOMPARE(status.getSolvedConflicts(), 0);
+    }
+
+    void twoFiles()
+    {
+        TotalDiffStatus status;
+        QStringList errors;
+        FullAnalysis::run(m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString(), status, errors);
+
+        // Without a base every difference is a conflict.
+        QVERIFY(errors.isEmpty());
+        QVERIFY(!status.isBinaryEqualAB());
+        QCOMPARE(status.getUnsolvedConflicts(), 1);
+        QCOMPARE(status.getSolvedConflicts(), 0);
+        QCOMPARE(status.getNonWhitespaceConflicts(), 1);
+    }
+
+    void threeFiles()
+    {
+        TotalDiffStatus status;
+        QStringList errors;
+        FullAnalysis::run(m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), m_tempDir.filePath("changed4.txt"), status, errors);
+
+        // B and C changed different lines, both changes are merged automatically.
+        QVERIFY(errors.isEmpty());
+        QVERIFY(!status.isBinaryEqualAB());
+        QVERIFY(!status.isBinaryEqualAC());
+        QVERIFY(!status.isBinaryEqualBC());
+        QCOMPARE(status.getUnsolvedConflicts(), 0);
+        QCOMPARE(status.getSolvedConflicts(), 2);
+    }
+
+    void missingFile()
+    {
+        TotalDiffStatus status;
+        QStringList errors;
+        FullAnalysis::run(QString(), m_tempDir.filePath("base.txt"), QString(), status, errors);
+
+        QVERIFY(errors.isEmpty());
+        QVERIFY(!status.isBinaryEqualAB());
+    }
+
+    // The diff code keeps no shared state, results don't depend on what other threads do.
+    void concurrentRuns()
+    {
+        TotalDiffStatus expected;
+        QStringList expectedErrors;
+        FullAnalysis::run(m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), m_tempDir.filePath("changed4.txt"), expected, expectedErrors);
+
+        constexpr qint32 nofThreads = 8;
+        std::vector<TotalDiffStatus> results(nofThreads);
+        std::vector<QStringList> errors(nofThreads);
+        std::vector<std::unique_ptr<QThread>> threads;
+        for(qint32 i = 0; i < nofThreads; ++i)
+        {
+            threads.emplace_back(QThread::create([this, &results, &errors, i]() {
+                for(qint32 j = 0; j < 20; ++j)
+                    FullAnalysis::run(m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), m_tempDir.filePath("changed4.txt"), results[i], errors[i]);
+            }));
+            threads.back()->start();
+        }
+
+        for(qint32 i = 0; i < nofThreads; ++i)
+        {
+            QVERIFY(threads[i]->wait());
+            QVERIFY(errors[i].isEmpty());
+            QCOMPARE(results[i].getUnsolvedConflicts(), expected.getUnsolvedConflicts());
+            QCOMPARE(results[i].getSolvedConflicts(), expected.getSolvedConflicts());
+            QCOMPARE(results[i].getWhitespaceConflicts(), expected.getWhitespaceConflicts());
+        }
+    }
+};
+
+QTEST_MAIN(FullAnalysisTest);
+
+#include "FullAnalysisTest.moc"
@@ -54,6 +54,7 @@ class GitIgnoreListTest : public QObject
         // Test that matches honors the directory and any subdirectories
         {
             const QString otherTestDir("other_dir");
+            const QString siblingTestDir("dir2");
             const QString testSubDir("dir/sub");
             FileAccess gitignoreFile(".gitignore");
             directoryList.push_back(gitignoreFile);
@@ -63,6 +64,23 @@ class GitIgnoreListTest : public QObject
             QVERIFY(testObject.matches(testDir, "foo", true) == true);
             QVERIFY(testObject.matches(testSubDir, "foo", true) == true);
             QVERIFY(testObject.matches(otherTestDir, "foo", true) == false);
+            QVERIFY(testObject.matches(siblingTestDir, "foo", true) == false);
+        }
+        // Patterns of all parent folders apply, the root's as well
+        {
+            GitIgnoreListStub testObject;
+            testObject.m_fileContents = QString("*.o");
+            testObject.enterDir("/", directoryList);
+            testObject.m_fileContents = QString("build");
+            testObject.enterDir("/src/lib", directoryList);
+            QVERIFY(testObject.matches("/src/lib/a/b", "x.o", true) == true);
+            QVERIFY(testObject.matches("/src/lib/a/b", "build", true) == true);
+            QVERIFY(testObject.matches("/src/lib/a/b", "x.txt", true) == false);
+            testObject.m_fileContents = QString("*.txt");
+            testObject.enterDir("/src/lib/a", directoryList);
+            QVERIFY(testObject.matches("/src/lib/a/b", "x.txt", true) == true);
+            QVERIFY(testObject.matches("/src/libs", "build", true) == false);
+            QVERIFY(testObject.matches("/src/libs", "x.o", true) == true);
         }
     }
 };
@@ -0,0 +1,152 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../GlobMatcher.h"
+
+class GlobMatcherTest: public QObject
+{
+    Q_OBJECT
+  private Q_SLOTS:
+    void globMatch_data()
+    {
+        QTest::addColumn<QString>("glob");
+        QTest::addColumn<QString>("name");
+
+        const QStringList globs = {"*", "*.cpp", "foo*", "f?o", "*.[ch]", "[!a-c]*", "[]x]y", "a*b*c", "*a*", "**", "x[", "[a-]", "*.tar.*", ""};
+        const QStringList names = {"", "foo", "f.o", "main.cpp", "main.c", "main.h", "main.o", "abc", "aXbYc", "acb", "]y", "xy", "x[", "-", "a.tar.gz", "cpp"};
+        for(const QString& glob: globs)
+        {
+            for(const QString& name: names)
+                QTest::addRow("'%s' '%s'", qPrintable(glob), qPrintable(name)) << glob << name;
+        }
+    }
+
+    // Same results as the regular expressions the ignore lists used before.
+    void globMatch()
+    {
+        QFETCH(QString, glob);
+        QFETCH(QString, name);
+
+        const QRegularExpression expression(QRegularExpression::wildcardToRegularExpression(glob));
+        if(!expression.isValid())
+            QSKIP("Not a valid pattern for QRegularExpression");
+
+        QCOMPARE(GlobMatcher::globMatch(glob, name), expression.match(name).hasMatch());
+
+        GlobMatcher matcher;
+        matcher.addPattern(glob);
+        QCOMPARE(matcher.matches(name), expression.match(name).hasMatch());
+    }
+
+    void caseSensitivity()
+    {
+        GlobMatcher caseSensitive(true);
+        GlobMatcher caseInsensitive(false);
+        for(GlobMatcher* pMatcher: {&caseSensitive, &caseInsensitive})
+            pMatcher->addPatterns({"Makefile", "*.BAK", "Build*", "?ore.[A-Z]"});
+
+        QVERIFY(caseSensitive.matches("Makefile"));
+        QVERIFY(!caseSensitive.matches("makefile"));
+        QVERIFY(caseInsensitive.matches("makefile"));
+        QVERIFY(!caseSensitive.matches("x.bak"));
+        QVERIFY(caseInsensitive.matches("x.bak"));
+        QVERIFY(!caseSensitive.matches("build-debug"));
+        QVERIFY(caseInsensitive.matches("build-debug"));
+        QVERIFY(!caseSensitive.matches("core.x"));
+        QVERIFY(caseInsensitive.matches("CORE.x"));
+        QVERIFY(!caseInsensitive.matches("core.xy"));
+    }
+
+    void classifiedPatterns()
+    {
+        GlobMatcher matcher;
+        QVERIFY(matcher.isEmpty());
+
+        // Taken literally, whatever they contain.
+        matcher.addName("a*b");
+        matcher.addPrefix("[x");
+        matcher.addSuffix("?");
+        QVERIFY(!matcher.isEmpty());
+
+        QVERIFY(matcher.matches("a*b"));
+        QVERIFY(!matcher.matches("axb"));
+        QVERIFY(matcher.matches("[xyz"));
+        QVERIFY(!matcher.matches("xyz"));
+        QVERIFY(matcher.matches("why?"));
+        QVERIFY(!matcher.matches("why"));
+    }
+
+    /*
+        Many patterns against many names, as in a large tree with large ignore files. Most
+        patterns are names and extensions, one in a hundred is a general wildcard.
+    */
+    void benchmark_data()
+    {
+        QTest::addColumn<qint32>("nofPatterns");
+        QTest::addColumn<qint32>("nofNames");
+
+        QTest::newRow("1k patterns x 10k names") << 1000 << 10000;
+        QTest::newRow("100k patterns x 1M names") << 100000 << 1000000;
+    }
+
+    void benchmark()
+    {
+        QFETCH(qint32, nofPatterns);
+        QFETCH(qint32, nofNames);
+
+        GlobMatcher matcher(false);
+        for(qint32 i = 0; i < nofPatterns; ++i)
+        {
+            switch(i % 4)
+            {
+                case 0:
+                    matcher.addPattern(QStringLiteral("generated_%1.dat").arg(i));
+                    break;
+                case 1:
+                    matcher.addPattern(QStringLiteral("*.ext%1").arg(i));
+                    break;
+                case 2:
+                    matcher.addPattern(QStringLiteral("tmp%1_*").arg(i));
+                    break;
+                default:
+                    if(i % 100 == 3)
+                        matcher.addPattern(QStringLiteral("cache%1_*.tmp").arg(i));
+                    else
+                        matcher.addPattern(QStringLiteral("build%1").arg(i));
+                    break;
+            }
+        }
+
+        QStringList names;
+        names.reserve(nofNames);
+        for(qint32 i = 0; i < nofNames; ++i)
+            names.append(QStringLiteral("file%1.ext%2").arg(i).arg(i % (2 * nofPatterns)));
+
+        qint64 nofMatches = 0;
+        QBENCHMARK_ONCE
+        {
+            for(const QString& name: names)
+            {
+                if(matcher.matches(name))
+                    ++nofMatches;
+            }
+        }
+        // Only the names with the extension of a "*.ext" pattern match.
+        QVERIFY(nofMatches > 0 && nofMatches < nofNames);
+    }
+};
+
+QTEST_MAIN(GlobMatcherTest);
+
+#include "GlobMatcherTest.moc"
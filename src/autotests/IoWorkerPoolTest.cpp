@@ -0,0 +1,193 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <algorithm>
+#include <vector>
+
+#include <QAtomicInteger>
+#include <QByteArrayList>
+#include <QTest>
+#include <QThread>
+#include <QtGlobal>
+
+#include "../IoWorkerPool.h"
+
+class IoWorkerPoolTest: public QObject
+{
+    Q_OBJECT
+  private:
+    // Tracks how many jobs are running on one device at the same time.
+    struct DeviceLoad
+    {
+        QAtomicInteger<qint32> m_current = 0;
+        QAtomicInteger<qint32> m_max = 0;
+
+        void enter()
+        {
+            const qint32 current = m_current.fetchAndAddOrdered(1) + 1;
+            qint32 max = m_max.loadAcquire();
+            while(current > max && !m_max.testAndSetOrdered(max, current))
+                max = m_max.loadAcquire();
+        }
+
+        void leave() { m_current.fetchAndSubOrdered(1); }
+    };
+
+  private Q_SLOTS:
+    void allJobsDone()
+    {
+        IoWorkerPool pool;
+        pool.setMaxThreads(4);
+
+        QAtomicInteger<qint32> nofJobs = 0;
+        qint32 nofDone = 0;
+        bool bDoneOnCaller = true;
+        for(qint32 i = 0; i < 200; ++i)
+        {
+            pool.add(
+                {}, [&nofJobs]() { nofJobs.fetchAndAddOrdered(1); },
+                [&nofDone, &bDoneOnCaller, this]() {
+                    bDoneOnCaller = bDoneOnCaller && QThread::currentThread() == thread();
+                    ++nofDone;
+                    return true;
+                });
+        }
+
+        QVERIFY(pool.run());
+        QCOMPARE(nofJobs.loadAcquire(), 200);
+        QCOMPARE(nofDone, 200);
+        QVERIFY(bDoneOnCaller);
+        QCOMPARE(pool.count(), (size_t)0);
+    }
+
+    void perDeviceLimit()
+    {
+        IoWorkerPool pool;
+        pool.setMaxThreads(8);
+        pool.setMaxPerDevice(2);
+
+        DeviceLoad loadA;
+        DeviceLoad loadB;
+        for(qint32 i = 0; i < 40; ++i)
+        {
+            // Every other job reads from both devices, like a compare of A against B.
+            const bool bBoth = i % 2 == 0;
+            const QByteArrayList devices = bBoth ? QByteArrayList{"devA", "devB"} : QByteArrayList{"devA"};
+            pool.add(
+                devices,
+                [&loadA, &loadB, bBoth]() {
+                    loadA.enter();
+                    if(bBoth) loadB.enter();
+                    QThread::msleep(2);
+                    if(bBoth) loadB.leave();
+                    loadA.leave();
+                },
+                []() { return true; });
+        }
+        // Not limited by either device.
+        for(qint32 i = 0; i < 40; ++i)
+            pool.add({"devC"}, []() { QThread::msleep(1); }, []() { return true; });
+
+        QVERIFY(pool.run());
+        QVERIFY(loadA.m_max.loadAcquire() <= 2);
+        QVERIFY(loadB.m_max.loadAcquire() <= 2);
+        QVERIFY(loadA.m_max.loadAcquire() >= 1);
+    }
+
+    void stopEarly()
+    {
+        IoWorkerPool pool;
+        pool.setMaxThreads(2);
+
+        QAtomicInteger<qint32> nofJobs = 0;
+        qint32 nofDone = 0;
+        for(qint32 i = 0; i < 1000; ++i)
+        {
+            pool.add(
+                {}, [&nofJobs]() { nofJobs.fetchAndAddOrdered(1); QThread::usleep(100); },
+                [&nofDone]() { return ++nofDone < 5; });
+        }
+
+        QVERIFY(!pool.run());
+        QCOMPARE(nofDone, 5);
+        QVERIFY(nofJobs.loadAcquire() < 1000);
+    }
+
+    // Each job of a chain may only start once the one before it is finished.
+    void prerequisites()
+    {
+        IoWorkerPool pool;
+        pool.setMaxThreads(8);
+
+        QAtomicInteger<qint32> nofOutOfOrder = 0;
+        std::vector<QAtomicInteger<qint32>> finished(200);
+        for(qint32 i = 0; i < 200; ++i)
+        {
+            // Ten chains side by side, plus a last job waiting for all of them.
+            const std::vector<size_t> prerequisites = i < 10 ? std::vector<size_t>{} : std::vector<size_t>{(size_t)i - 10};
+            pool.add(
+                {},
+                [&finished, &nofOutOfOrder, i]() {
+                    if(i >= 10 && finished[i - 10].loadAcquire() == 0)
+                        nofOutOfOrder.fetchAndAddOrdered(1);
+                    QThread::usleep(100);
+                    finished[i].storeRelease(1);
+                },
+                []() { return true; }, prerequisites);
+        }
+
+        bool bLastAfterAll = false;
+        pool.add(
+            {},
+            [&finished, &bLastAfterAll]() {
+                bLastAfterAll = std::all_of(finished.begin() + 190, finished.end(), [](const QAtomicInteger<qint32>& bFinished) { return bFinished.loadAcquire() != 0; });
+            },
+            []() { return true; }, {190, 191, 192, 193, 194, 195, 196, 197, 198, 199});
+
+        QVERIFY(pool.run());
+        QCOMPARE(nofOutOfOrder.loadAcquire(), 0);
+        QVERIFY(bLastAfterAll);
+    }
+
+    void background()
+    {
+        IoWorkerPool pool;
+        pool.setMaxThreads(1);
+
+        std::vector<size_t> doneOrder;
+        for(qint32 i = 0; i < 200; ++i)
+        {
+            const size_t jobId = pool.add(
+                {}, []() { QThread::usleep(500); },
+                [&doneOrder, i]() {
+                    doneOrder.push_back((size_t)i);
+                    return true;
+                });
+            QCOMPARE(jobId, (size_t)i);
+        }
+
+        pool.start();
+        QVERIFY(!pool.isDone(150));
+        QVERIFY(pool.waitFor({150, 160}));
+        QVERIFY(pool.isDone(150));
+        QVERIFY(pool.isDone(160));
+        // The single worker may have been busy with one other job for each of the two.
+        const auto pos150 = std::find(doneOrder.begin(), doneOrder.end(), (size_t)150) - doneOrder.begin();
+        const auto pos160 = std::find(doneOrder.begin(), doneOrder.end(), (size_t)160) - doneOrder.begin();
+        QVERIFY(pos150 < pos160);
+        QVERIFY(pos160 <= 3);
+
+        while(pool.processDone(50)) {}
+        QCOMPARE(doneOrder.size(), (size_t)200);
+    }
+};
+
+QTEST_MAIN(IoWorkerPoolTest);
+
+#include "IoWorkerPoolTest.moc"
@@ -0,0 +1,190 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../fileaccess.h"
+#include "../LocalDirectoryScanner.h"
+
+#include <optional>
+
+class LocalDirectoryScannerTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    // Mirrors the QDir fallback in DefaultFileAccessJobHandler::scanLocalDirectory.
+    static bool qDirScan(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden)
+    {
+        QDir dir(dirAccess.absoluteFilePath());
+
+        dir.setSorting(QDir::Name | QDir::DirsFirst);
+        if(bFindHidden)
+            dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+        else
+            dir.setFilter(QDir::Files | QDir::Dirs | QDir::System | QDir::NoDotAndDotDot);
+
+        const QFileInfoList fiList = dir.entryInfoList();
+        for(const QFileInfo& fi: fiList)
+        {
+            FileAccess fa;
+            fa.setFile(&dirAccess, fi);
+            dirList.push_back(fa);
+        }
+        return fiList.isEmpty() ? dir.isReadable() : true;
+    }
+
+    static std::optional<bool> nativeScan(FileAccess& dirAccess, DirectoryList& dirList, bool bFindHidden)
+    {
+        return LocalDirectoryScanner::scan(dirAccess, dirList, bFindHidden);
+    }
+
+    // Walks the tree the way a folder comparison does and touches the fields the comparison reads.
+    template<class ScanFunction>
+    static qint64 walk(FileAccess& dirAccess, ScanFunction scan, qint64& totalSize)
+    {
+        DirectoryList dirList;
+        scan(dirAccess, dirList, true);
+
+        qint64 nofEntries = 0;
+        for(FileAccess& fa: dirList)
+        {
+            ++nofEntries;
+            if(fa.exists() && fa.isNormal() && fa.isFile() && fa.lastModified().isValid())
+                totalSize += fa.size();
+            if(fa.isDir() && !fa.isSymLink())
+                nofEntries += walk(fa, scan, totalSize);
+        }
+        return nofEntries;
+    }
+
+    void createFile(const QString& relPath, const QByteArray& content)
+    {
+        QFile file(m_tempDir.filePath(relPath));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(content) == content.size());
+    }
+
+    void compareScans(bool bFindHidden)
+    {
+        FileAccess root(m_tempDir.path());
+        DirectoryList expected, actual;
+
+        QVERIFY(qDirScan(root, expected, bFindHidden));
+        const std::optional<bool> result = nativeScan(root, actual, bFindHidden);
+        if(!result.has_value())
+            QSKIP("No native scanner on this platform.");
+        QVERIFY(result.value());
+
+        QCOMPARE(actual.size(), expected.size());
+        auto expectedIt = expected.cbegin();
+        for(const FileAccess& fa: actual)
+        {
+            QCOMPARE(fa.fileName(), expectedIt->fileName());
+            QCOMPARE(fa.fileRelPath(), expectedIt->fileRelPath());
+            QCOMPARE(fa.isDir(), expectedIt->isDir());
+            QCOMPARE(fa.isFile(), expectedIt->isFile());
+            QCOMPARE(fa.isSymLink(), expectedIt->isSymLink());
+            QCOMPARE(fa.isBrokenLink(), expectedIt->isBrokenLink());
+            QCOMPARE(fa.exists(), expectedIt->exists());
+            QCOMPARE(fa.isHidden(), expectedIt->isHidden());
+            QCOMPARE(fa.readLink(), expectedIt->readLink());
+            if(!fa.isBrokenLink())
+            {
+                QCOMPARE(fa.size(), expectedIt->size());
+                QCOMPARE(fa.lastModified(), expectedIt->lastModified());
+            }
+            ++expectedIt;
+        }
+    }
+
+  private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QDir root(m_tempDir.path());
+        QVERIFY(root.mkpath("sub/deeper"));
+        QVERIFY(root.mkpath(".hiddenDir"));
+        createFile("b.txt", "bbb");
+        createFile("A.txt", "a");
+        createFile(".hidden", "hidden");
+        createFile("sub/x.cpp", "int x;");
+#ifndef Q_OS_WIN
+        QVERIFY(QFile::link("sub", m_tempDir.filePath("linkToDir")));
+        QVERIFY(QFile::link("b.txt", m_tempDir.filePath("linkToFile")));
+        QVERIFY(QFile::link("missing", m_tempDir.filePath("brokenLink")));
+#endif
+    }
+
+    void sameAsQDir()
+    {
+        compareScans(true);
+    }
+
+    void sameAsQDirWithoutHidden()
+    {
+        compareScans(false);
+    }
+
+    void unreadableFolder()
+    {
+        FileAccess missing(m_tempDir.filePath("doesNotExist"));
+        DirectoryList dirList;
+        const std::optional<bool> result = nativeScan(missing, dirList, true);
+        if(!result.has_value())
+            QSKIP("No native scanner on this platform.");
+        QVERIFY(!result.value());
+        QVERIFY(dirList.empty());
+    }
+
+    /*
+        Benchmarks on an existing tree, see test/scan_benchmark.sh which runs these under strace
+        to count system calls. Skipped unless KDIFF3_SCAN_BENCHMARK_DIR is set.
+    */
+    void benchmarkQDir()
+    {
+        const QString benchmarkDir = qEnvironmentVariable("KDIFF3_SCAN_BENCHMARK_DIR");
+        if(benchmarkDir.isEmpty())
+            QSKIP("KDIFF3_SCAN_BENCHMARK_DIR not set.");
+
+        FileAccess root(benchmarkDir);
+        qint64 nofEntries = 0;
+        qint64 totalSize = 0;
+        QBENCHMARK_ONCE
+        {
+            nofEntries = walk(root, [](FileAccess& dir, DirectoryList& dirList, bool bFindHidden) { return qDirScan(dir, dirList, bFindHidden); }, totalSize);
+        }
+        qInfo() << "Entries:" << nofEntries << "Bytes:" << totalSize;
+    }
+
+    void benchmarkNative()
+    {
+        const QString benchmarkDir = qEnvironmentVariable("KDIFF3_SCAN_BENCHMARK_DIR");
+        if(benchmarkDir.isEmpty())
+            QSKIP("KDIFF3_SCAN_BENCHMARK_DIR not set.");
+
+        FileAccess root(benchmarkDir);
+        qint64 nofEntries = 0;
+        qint64 totalSize = 0;
+        QBENCHMARK_ONCE
+        {
+            nofEntries = walk(root, [](FileAccess& dir, DirectoryList& dirList, bool bFindHidden) { return nativeScan(dir, dirList, bFindHidden).value_or(false); }, totalSize);
+        }
+        qInfo() << "Entries:" << nofEntries << "Bytes:" << totalSize;
+    }
+};
+
+QTEST_MAIN(LocalDirectoryScannerTest);
+
+#include "LocalDirectoryScannerTest.moc"
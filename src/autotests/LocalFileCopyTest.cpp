@@ -0,0 +1,139 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../LocalFileCopy.h"
+#include "TestUtils.h"
+
+class LocalFileCopyTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    QByteArray readFile(const QString& path)
+    {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    }
+
+  private Q_SLOTS:
+    void copy_data()
+    {
+        QTest::addColumn<qint32>("size");
+
+        QTest::newRow("empty") << 0;
+        QTest::newRow("small") << 100;
+        // More than one chunk of the buffered copy.
+        QTest::newRow("large") << 3 * 1024 * 1024 + 17;
+    }
+
+    void copy()
+    {
+        QFETCH(qint32, size);
+
+        const QByteArray data = TestUtils::randomData(size);
+
+        const QString srcPath = m_tempDir.filePath(QStringLiteral("src%1.bin").arg(size));
+        const QString destPath = m_tempDir.filePath(QStringLiteral("dest%1.bin").arg(size));
+        QVERIFY(TestUtils::writeFile(srcPath, data));
+        // Longer than the source, must be cut.
+        QVERIFY(TestUtils::writeFile(destPath, QByteArray(size + 1000, 'x')));
+
+        QString errorText;
+        const LocalFileCopy::Method method = LocalFileCopy::copy(srcPath, destPath, errorText);
+        QVERIFY2(method != LocalFileCopy::eFailed, qPrintable(errorText));
+#ifndef Q_OS_LINUX
+        QCOMPARE(method, LocalFileCopy::eReadWrite);
+#endif
+        QCOMPARE(readFile(destPath), data);
+    }
+
+    void keepsMetaData()
+    {
+        const QString srcPath = m_tempDir.filePath("script.sh");
+        const QString destPath = m_tempDir.filePath("script-copy.sh");
+        QVERIFY(TestUtils::writeFile(srcPath, "#!/bin/sh\n"));
+
+        const QDateTime modified = QDateTime::currentDateTime().addDays(-3).addMSecs(-QDateTime::currentDateTime().time().msec());
+        {
+            QFile srcFile(srcPath);
+            QVERIFY(srcFile.open(QIODevice::ReadWrite));
+            QVERIFY(srcFile.setFileTime(modified, QFileDevice::FileModificationTime));
+            QVERIFY(srcFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+        }
+
+        QString errorText;
+        QVERIFY2(LocalFileCopy::copy(srcPath, destPath, errorText) != LocalFileCopy::eFailed, qPrintable(errorText));
+
+        QFile destFile(destPath);
+        QCOMPARE(destFile.fileTime(QFileDevice::FileModificationTime), modified);
+#ifndef Q_OS_WIN
+        QVERIFY(destFile.permissions().testFlag(QFileDevice::ExeOwner));
+#endif
+    }
+
+    void deltaCopy_data()
+    {
+        QTest::addColumn<bool>("bKeepBase");
+        QTest::addColumn<qint32>("newSize");
+
+        QTest::newRow("in place") << false << 3 * 1024 * 1024;
+        QTest::newRow("in place, grown") << false << 3 * 1024 * 1024 + 100000;
+        QTest::newRow("in place, shrunk") << false << 2 * 1024 * 1024 + 17;
+        QTest::newRow("from backup") << true << 3 * 1024 * 1024;
+    }
+
+    // Where the file system has no reflinks this is a plain copy, the result must be the same.
+    void deltaCopy()
+    {
+        QFETCH(bool, bKeepBase);
+        QFETCH(qint32, newSize);
+
+        const QByteArray oldData = TestUtils::randomData(3 * 1024 * 1024);
+        QByteArray newData = oldData.left(newSize);
+        newData.append(QByteArray(newSize - newData.size(), 'n'));
+        // A few changed bytes in the middle and one at the very start.
+        newData[0] = (char)(newData[0] + 1);
+        for(qint32 i = 1000000; i < 1000100; ++i)
+            newData[i] = (char)(newData[i] ^ 0x55);
+
+        const QString tag = QString::number(newSize) + (bKeepBase ? "b" : "");
+        const QString srcPath = m_tempDir.filePath("new" + tag + ".img");
+        const QString destPath = m_tempDir.filePath("old" + tag + ".img");
+        const QString basePath = bKeepBase ? destPath + ".orig" : destPath;
+        QVERIFY(TestUtils::writeFile(srcPath, newData));
+        QVERIFY(TestUtils::writeFile(basePath, oldData));
+
+        QString errorText;
+        const LocalFileCopy::Method method = LocalFileCopy::deltaCopy(srcPath, basePath, destPath, errorText);
+        QVERIFY2(method != LocalFileCopy::eFailed, qPrintable(errorText));
+        QCOMPARE(readFile(destPath), newData);
+        if(bKeepBase)
+            QCOMPARE(readFile(basePath), oldData);
+    }
+
+    void missingSource()
+    {
+        QString errorText;
+        QCOMPARE(LocalFileCopy::copy(m_tempDir.filePath("missing.bin"), m_tempDir.filePath("never.bin"), errorText), LocalFileCopy::eFailed);
+        QVERIFY(!errorText.isEmpty());
+        QVERIFY(!QFile::exists(m_tempDir.filePath("never.bin")));
+    }
+};
+
+QTEST_MAIN(LocalFileCopyTest);
+
+#include "LocalFileCopyTest.moc"
@@ -0,0 +1,175 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <memory>
+#include <vector>
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../diff.h"
+#include "../MergePrefetch.h"
+#include "../options.h"
+#include "../SourceData.h"
+#include "TestUtils.h"
+
+class MergePrefetchTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    static void waitForRound(MergePrefetch& prefetch)
+    {
+        while(prefetch.processDone())
+            QTest::qWait(10);
+    }
+
+  private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QVERIFY(TestUtils::writeMergeFiles(QDir(m_tempDir.path())));
+    }
+
+    void take()
+    {
+        const MergePrefetch::Files twoFiles{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString()};
+        const MergePrefetch::Files threeFiles{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), m_tempDir.filePath("changed4.txt")};
+
+        MergePrefetch prefetch;
+        prefetch.prefetch({twoFiles, threeFiles});
+        QVERIFY(prefetch.isRunning());
+        QVERIFY(prefetch.contains(twoFiles));
+        QVERIFY(prefetch.contains(threeFiles));
+
+        // Waits for the job if it isn't done yet.
+        const std::unique_ptr<FullAnalysis::Comparison> pThree = prefetch.take(threeFiles);
+        QVERIFY(pThree != nullptr);
+        QVERIFY(pThree->m_errors.isEmpty());
+        QVERIFY(pThree->m_sdC->lineCount() > 0);
+        QVERIFY(!pThree->m_totalDiffStatus.isBinaryEqualAB());
+        QVERIFY(!pThree->m_diff3LineList.empty());
+        QVERIFY(!prefetch.contains(threeFiles));
+        QVERIFY(prefetch.take(threeFiles) == nullptr);
+
+        waitForRound(prefetch);
+        QVERIFY(!prefetch.isRunning());
+        const std::unique_ptr<FullAnalysis::Comparison> pTwo = prefetch.take(twoFiles);
+        QVERIFY(pTwo != nullptr);
+        QVERIFY(pTwo->m_sdC->isEmpty());
+        QVERIFY(!pTwo->m_diffList12.empty());
+        QVERIFY(pTwo->m_diffList13.empty());
+    }
+
+    void dropsWhatIsNoLongerUpcoming()
+    {
+        const MergePrefetch::Files first{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString()};
+        const MergePrefetch::Files second{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed4.txt"), QString()};
+
+        MergePrefetch prefetch;
+        prefetch.prefetch({first});
+        waitForRound(prefetch);
+
+        // The merge moved on, the first one was skipped.
+        prefetch.prefetch({second});
+        QVERIFY(!prefetch.contains(first));
+        QVERIFY(prefetch.contains(second));
+        waitForRound(prefetch);
+        QVERIFY(prefetch.take(second) != nullptr);
+    }
+
+    void memoryLimit()
+    {
+        const MergePrefetch::Files first{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString()};
+        const MergePrefetch::Files second{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed4.txt"), QString()};
+
+        MergePrefetch prefetch;
+        // Room for one pair of 10 byte files.
+        prefetch.setMaxMemory(MergePrefetch::estimatedMemory(20));
+        prefetch.prefetch({first, second});
+        QVERIFY(prefetch.contains(first));
+        QVERIFY(!prefetch.contains(second));
+        QCOMPARE(prefetch.memoryInUse(), MergePrefetch::estimatedMemory(20));
+        waitForRound(prefetch);
+
+        // Not before the first one was taken.
+        prefetch.prefetch({first, second});
+        QVERIFY(!prefetch.isRunning());
+        QVERIFY(prefetch.take(first) != nullptr);
+        prefetch.prefetch({second});
+        QVERIFY(prefetch.contains(second));
+        prefetch.clear();
+        QVERIFY(!prefetch.contains(second));
+        QCOMPARE(prefetch.memoryInUse(), (qint64)0);
+    }
+
+    void changedFile()
+    {
+        const QString fileB = m_tempDir.filePath("changing.txt");
+        QVERIFY(TestUtils::writeFile(fileB, "1\n2\n3\n"));
+        const MergePrefetch::Files files{m_tempDir.filePath("base.txt"), fileB, QString()};
+
+        MergePrefetch prefetch;
+        prefetch.prefetch({files});
+        waitForRound(prefetch);
+
+        // A different size is noticed whatever the resolution of the time stamps.
+        QVERIFY(TestUtils::writeFile(fileB, "1\n2\n3\n4\n"));
+        QVERIFY(prefetch.take(files) == nullptr);
+    }
+
+    void changedOptions()
+    {
+        const MergePrefetch::Files files{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString()};
+
+        MergePrefetch prefetch;
+        prefetch.prefetch({files});
+        waitForRound(prefetch);
+
+        // Diffed with the case still mattering.
+        gOptions->m_bIgnoreCase = !gOptions->m_bIgnoreCase;
+        QVERIFY(prefetch.take(files) == nullptr);
+
+        // Prepared again with the new value.
+        prefetch.prefetch({files});
+        waitForRound(prefetch);
+        gOptions->m_bIgnoreCase = !gOptions->m_bIgnoreCase;
+        prefetch.prefetch({files});
+        QVERIFY(prefetch.isRunning());
+        waitForRound(prefetch);
+        QVERIFY(prefetch.take(files) != nullptr);
+    }
+
+    void takeDataFrom()
+    {
+        MergePrefetch prefetch;
+        const MergePrefetch::Files files{m_tempDir.filePath("base.txt"), m_tempDir.filePath("changed2.txt"), QString()};
+        prefetch.prefetch({files});
+        const std::unique_ptr<FullAnalysis::Comparison> pComparison = prefetch.take(files);
+        QVERIFY(pComparison != nullptr);
+        const LineType lineCount = pComparison->m_sdB->lineCount();
+        QVERIFY(lineCount > 0);
+
+        SourceData sourceData;
+        sourceData.setFilename(files.m_fileB);
+        sourceData.takeDataFrom(*pComparison->m_sdB);
+        QCOMPARE(sourceData.lineCount(), lineCount);
+        QVERIFY(sourceData.isText());
+        QVERIFY(sourceData.getErrors().isEmpty());
+        // It got what sourceData had, nothing was read yet.
+        QCOMPARE(pComparison->m_sdB->lineCount(), (LineType)0);
+    }
+};
+
+QTEST_MAIN(MergePrefetchTest);
+
+#include "MergePrefetchTest.moc"
@@ -0,0 +1,221 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../ScanSnapshot.h"
+
+class ScanSnapshotTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    static std::vector<ScanSnapshot::Record> sampleRecords()
+    {
+        std::vector<ScanSnapshot::Record> records(4);
+        records[0].m_name = QStringLiteral("src");
+        records[0].m_flags = ScanSnapshot::eDir;
+
+        records[1].m_parent = 0;
+        records[1].m_name = QStringLiteral("main.cpp");
+        records[1].m_flags = ScanSnapshot::eFile;
+        records[1].m_size = 1234;
+        records[1].m_modified = 1700000000123;
+        records[1].m_hash = QByteArray(32, '\x5a');
+
+        records[2].m_parent = 0;
+        records[2].m_name = QStringLiteral("Ümlaut.txt");
+        records[2].m_flags = ScanSnapshot::eFile | ScanSnapshot::eHidden;
+
+        records[3].m_name = QStringLiteral("link");
+        records[3].m_flags = ScanSnapshot::eSymLink | ScanSnapshot::eBrokenLink;
+        records[3].m_linkTarget = QStringLiteral("../nowhere");
+        return records;
+    }
+
+  private Q_SLOTS:
+    void roundTrip()
+    {
+        const QString fileName = m_tempDir.filePath("roundtrip.kd3snap");
+        const std::vector<ScanSnapshot::Record> records = sampleRecords();
+        QString errorText;
+        QVERIFY2(ScanSnapshot::save(fileName, QStringLiteral("/home/user/project"), records, errorText), qPrintable(errorText));
+
+        const std::shared_ptr<const ScanSnapshot> pSnapshot = ScanSnapshot::open(fileName, errorText);
+        QVERIFY2(pSnapshot != nullptr, qPrintable(errorText));
+        QCOMPARE(pSnapshot->rootPath(), QStringLiteral("/home/user/project"));
+        QCOMPARE(pSnapshot->count(), 4);
+        for(qint32 i = 0; i < pSnapshot->count(); ++i)
+        {
+            QCOMPARE(pSnapshot->parent(i), records[i].m_parent);
+            QCOMPARE(pSnapshot->name(i), records[i].m_name);
+            QCOMPARE(pSnapshot->size(i), records[i].m_size);
+            QCOMPARE(pSnapshot->modified(i).toMSecsSinceEpoch(), records[i].m_modified);
+            QCOMPARE(pSnapshot->linkTarget(i), records[i].m_linkTarget);
+        }
+        QCOMPARE(pSnapshot->flags(1), (quint32)(ScanSnapshot::eFile | ScanSnapshot::eHasHash));
+        QCOMPARE(pSnapshot->hash(1), std::optional<QByteArray>(QByteArray(32, '\x5a')));
+        // Saved without a hash.
+        QCOMPARE(pSnapshot->flags(2), (quint32)(ScanSnapshot::eFile | ScanSnapshot::eHidden));
+        QVERIFY(!pSnapshot->hash(2).has_value());
+    }
+
+    void parentAfterChild()
+    {
+        std::vector<ScanSnapshot::Record> records = sampleRecords();
+        records[0].m_parent = 1;
+
+        QString errorText;
+        QVERIFY(!ScanSnapshot::save(m_tempDir.filePath("unordered.kd3snap"), QString(), records, errorText));
+        QVERIFY(!errorText.isEmpty());
+    }
+
+    void invalidFile_data()
+    {
+        QTest::addColumn<qint32>("truncateTo");
+        QTest::addColumn<qint32>("corruptOffset");
+
+        QTest::newRow("empty") << 0 << -1;
+        QTest::newRow("short header") << 20 << -1;
+        QTest::newRow("entries cut off") << 100 << -1;
+        QTest::newRow("bad magic") << -1 << 0;
+        QTest::newRow("bad version") << -1 << 8;
+        // The name length of the first entry, pointing past the end of the file.
+        QTest::newRow("bad name") << -1 << 40 + 4 + 4 + 3;
+    }
+
+    void invalidFile()
+    {
+        QFETCH(qint32, truncateTo);
+        QFETCH(qint32, corruptOffset);
+
+        const QString fileName = m_tempDir.filePath(QStringLiteral("invalid%1_%2.kd3snap").arg(truncateTo).arg(corruptOffset));
+        QString errorText;
+        QVERIFY2(ScanSnapshot::save(fileName, QStringLiteral("/root"), sampleRecords(), errorText), qPrintable(errorText));
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QByteArray data = file.readAll();
+        if(truncateTo >= 0)
+            data.truncate(truncateTo);
+        if(corruptOffset >= 0)
+            data[corruptOffset] = (char)0x7f;
+        QVERIFY(file.resize(0));
+        QVERIFY(file.seek(0));
+        QCOMPARE(file.write(data), data.size());
+        file.close();
+
+        errorText.clear();
+        QVERIFY(ScanSnapshot::open(fileName, errorText) == nullptr);
+        QVERIFY(!errorText.isEmpty());
+    }
+
+    void parseManifestLine_data()
+    {
+        QTest::addColumn<QByteArray>("line");
+        QTest::addColumn<bool>("bValid");
+        QTest::addColumn<QString>("path");
+
+        const QByteArray hash(64, 'a');
+        QTest::newRow("text mode") << hash + "  dir/file.txt\n" << true << "dir/file.txt";
+        QTest::newRow("binary mode") << hash + " *file.bin\r\n" << true << "file.bin";
+        QTest::newRow("upper case") << QByteArray(64, 'A') + "  file" << true << "file";
+        QTest::newRow("tag") << "SHA256 (a (1).txt) = " + hash << true << "a (1).txt";
+        QTest::newRow("dot slash") << hash + "  ./src/main.cpp" << true << "src/main.cpp";
+        QTest::newRow("escaped") << "\\" + hash + "  new\\nline\\\\x" << true << "new\nline\\x";
+        QTest::newRow("spaces kept") << hash + "   leading space" << true << " leading space";
+        QTest::newRow("md5") << QByteArray(32, 'a') + "  file" << false << QString();
+        QTest::newRow("not hex") << QByteArray(63, 'a') + "g  file" << false << QString();
+        QTest::newRow("one space") << hash + " file" << false << QString();
+        QTest::newRow("absolute") << hash + "  /etc/passwd" << false << QString();
+        QTest::newRow("parent") << hash + "  a/../../b" << false << QString();
+        QTest::newRow("empty") << QByteArray("\n") << false << QString();
+    }
+
+    void parseManifestLine()
+    {
+        QFETCH(QByteArray, line);
+        QFETCH(bool, bValid);
+        QFETCH(QString, path);
+
+        const std::optional<std::pair<QByteArray, QString>> result = ScanSnapshot::parseManifestLine(line);
+        QCOMPARE(result.has_value(), bValid);
+        if(bValid)
+        {
+            QCOMPARE(result->first, QByteArray(32, '\xaa'));
+            QCOMPARE(result->second, path);
+        }
+    }
+
+    void readManifest()
+    {
+        const QString fileName = m_tempDir.filePath("SHA256SUMS");
+        QVERIFY(ScanSnapshot::isManifestFile(fileName));
+        {
+            QFile file(fileName);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(64, '1') + "  b/c/deep.txt\n");
+            file.write(QByteArray(64, '2') + "  top.txt\n");
+            file.write("garbage line\n");
+            file.write(QByteArray(64, '3') + "  b/.hidden\n");
+            // Listed twice, the first one counts.
+            file.write(QByteArray(64, '4') + "  top.txt\n");
+        }
+
+        QString errorText;
+        const std::shared_ptr<const ScanSnapshot> pSnapshot = ScanSnapshot::open(fileName, errorText);
+        QVERIFY2(pSnapshot != nullptr, qPrintable(errorText));
+        QCOMPARE(pSnapshot->rootPath(), QFileInfo(fileName).absolutePath());
+        QCOMPARE(pSnapshot->count(), 5);
+
+        QCOMPARE(pSnapshot->name(0), QStringLiteral("b"));
+        QCOMPARE(pSnapshot->flags(0), (quint32)(ScanSnapshot::eDir | ScanSnapshot::eNoMetaData));
+        QCOMPARE(pSnapshot->name(1), QStringLiteral("c"));
+        QCOMPARE(pSnapshot->parent(1), 0);
+        QCOMPARE(pSnapshot->name(2), QStringLiteral("deep.txt"));
+        QCOMPARE(pSnapshot->parent(2), 1);
+        QCOMPARE(pSnapshot->hash(2), std::optional<QByteArray>(QByteArray(32, '\x11')));
+        QCOMPARE(pSnapshot->name(3), QStringLiteral("top.txt"));
+        QCOMPARE(pSnapshot->parent(3), -1);
+        QCOMPARE(pSnapshot->hash(3), std::optional<QByteArray>(QByteArray(32, '\x22')));
+        QCOMPARE(pSnapshot->name(4), QStringLiteral(".hidden"));
+        QCOMPARE(pSnapshot->parent(4), 0);
+        QVERIFY((pSnapshot->flags(4) & ScanSnapshot::eHidden) != 0);
+    }
+
+    void emptyManifest()
+    {
+        const QString fileName = m_tempDir.filePath("empty.sha256");
+        {
+            QFile file(fileName);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QByteArray(32, 'a') + "  md5-only.txt\n");
+        }
+
+        QString errorText;
+        QVERIFY(ScanSnapshot::open(fileName, errorText) == nullptr);
+        QVERIFY(!errorText.isEmpty());
+    }
+
+    void missingFile()
+    {
+        QString errorText;
+        QVERIFY(ScanSnapshot::open(m_tempDir.filePath("missing.kd3snap"), errorText) == nullptr);
+        QVERIFY(!errorText.isEmpty());
+    }
+};
+
+QTEST_MAIN(ScanSnapshotTest);
+
+#include "ScanSnapshotTest.moc"
@@ -0,0 +1,199 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#include <optional>
+#include <utility>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtGlobal>
+
+#include "../ContentHashCache.h"
+#include "../fileaccess.h"
+#include "../LocalDirectoryScanner.h"
+#include "../SubtreeSummary.h"
+#include "TestUtils.h"
+
+class SubtreeSummaryTest: public QObject
+{
+    Q_OBJECT
+  private:
+    QTemporaryDir m_tempDir;
+
+    static const QStringList& files()
+    {
+        static const QStringList result{QStringLiteral("/top.txt"), QStringLiteral("/sub/x.txt"), QStringLiteral("/sub/deeper/y.txt"), QStringLiteral("/other/z.txt")};
+        return result;
+    }
+
+    // Stands in for a binary comparison that read the file to the end.
+    void hashFile(ContentHashCache& cache, const QString& relPath)
+    {
+        const QString path = m_tempDir.filePath(relPath);
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        const std::optional<ContentHashCache::Key> key = ContentHashCache::keyFor(path);
+        QVERIFY(key.has_value());
+        cache.insert(*key, QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha256));
+    }
+
+    // Like a folder comparison, the native scanner is used where there is one.
+    static bool scan(FileAccess& dirAccess, DirectoryList& entries, bool bNative)
+    {
+        DirectoryList dirList;
+        if(bNative)
+        {
+            if(LocalDirectoryScanner::scan(dirAccess, dirList, true) != std::optional<bool>(true))
+                return false;
+        }
+        else
+        {
+            QDir dir(dirAccess.absoluteFilePath());
+            dir.setSorting(QDir::Name | QDir::DirsFirst);
+            dir.setFilter(QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+            const QFileInfoList fiList = dir.entryInfoList();
+            for(const QFileInfo& fi: fiList)
+                dirList.emplace_back().setFile(&dirAccess, fi);
+        }
+
+        for(FileAccess& fa: dirList)
+        {
+            FileAccess& entry = entries.emplace_back(std::move(fa));
+            if(entry.isDir() && !scan(entry, entries, bNative))
+                return false;
+        }
+        return true;
+    }
+
+    // Summary of the folder relPath in the tree rooted at rootRelPath.
+    std::optional<QByteArray> summary(ContentHashCache& cache, const QString& rootRelPath, const QString& relPath = QString(), bool bNative = true)
+    {
+        FileAccess root(m_tempDir.filePath(rootRelPath));
+        DirectoryList dirList;
+        if(!scan(root, dirList, bNative))
+            return std::nullopt;
+
+        const SubtreeSummary::Summaries summaries = SubtreeSummary::compute(root, dirList, &cache);
+        const FileAccess* pDir = &root;
+        if(!relPath.isEmpty())
+        {
+            pDir = nullptr;
+            for(const FileAccess& entry: dirList)
+            {
+                if(entry.fileRelPath() == relPath)
+                    pDir = &entry;
+            }
+        }
+
+        auto it = summaries.find(pDir);
+        if(it == summaries.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+  private Q_SLOTS:
+    void initTestCase()
+    {
+        FileAccess dir(QDir::tempPath());
+        DirectoryList dirList;
+        if(!LocalDirectoryScanner::scan(dir, dirList, false).has_value())
+            QSKIP("Summaries need the scan data of the native scanner.");
+    }
+
+    void init()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QDir root(m_tempDir.path());
+        for(const QString& side: {QStringLiteral("a"), QStringLiteral("b")})
+        {
+            QVERIFY(QDir(m_tempDir.filePath(side)).removeRecursively());
+            QVERIFY(root.mkpath(side + "/sub/deeper"));
+            QVERIFY(root.mkpath(side + "/other"));
+            QVERIFY(TestUtils::writeFile(m_tempDir.filePath(side + "/top.txt"), "top"));
+            QVERIFY(TestUtils::writeFile(m_tempDir.filePath(side + "/sub/x.txt"), "x"));
+            QVERIFY(TestUtils::writeFile(m_tempDir.filePath(side + "/sub/deeper/y.txt"), "y"));
+            QVERIFY(TestUtils::writeFile(m_tempDir.filePath(side + "/other/z.txt"), "z"));
+        }
+    }
+
+    void identicalTrees()
+    {
+        ContentHashCache cache(m_tempDir.filePath("cache"));
+        for(const QString& side: {QStringLiteral("a"), QStringLiteral("b")})
+        {
+            for(const QString& file: files())
+                hashFile(cache, side + file);
+        }
+
+        // The keys from the scan are the ones keyFor() stored the hashes with.
+        const std::optional<QByteArray> summaryA = summary(cache, "a");
+        QVERIFY(summaryA.has_value());
+        QVERIFY(summary(cache, "b") == summaryA);
+        QVERIFY(summary(cache, "b", "sub") == summary(cache, "a", "sub"));
+        QVERIFY(summary(cache, "a", "sub") != summary(cache, "a", "other"));
+    }
+
+    void changedFile()
+    {
+        QVERIFY(TestUtils::writeFile(m_tempDir.filePath("b/sub/deeper/y.txt"), "changed"));
+
+        ContentHashCache cache(m_tempDir.filePath("cache"));
+        for(const QString& side: {QStringLiteral("a"), QStringLiteral("b")})
+        {
+            for(const QString& file: files())
+                hashFile(cache, side + file);
+        }
+
+        // The change shows all the way up, untouched siblings still match.
+        QVERIFY(summary(cache, "a") != summary(cache, "b"));
+        QVERIFY(summary(cache, "a", "sub") != summary(cache, "b", "sub"));
+        QVERIFY(summary(cache, "b", "other") == summary(cache, "a", "other"));
+    }
+
+    void missingHash()
+    {
+        ContentHashCache cache(m_tempDir.filePath("cache"));
+        hashFile(cache, "a/other/z.txt");
+
+        // Without hashes for everything below it a folder has no summary.
+        QVERIFY(!summary(cache, "a").has_value());
+        QVERIFY(!summary(cache, "a", "sub").has_value());
+        QVERIFY(summary(cache, "a", "other").has_value());
+    }
+
+    void staleHash()
+    {
+        ContentHashCache cache(m_tempDir.filePath("cache"));
+        hashFile(cache, "a/other/z.txt");
+        // Same size, written after it was hashed. The key changes with the ctime.
+        QTest::qWait(10);
+        QVERIFY(TestUtils::writeFile(m_tempDir.filePath("a/other/z.txt"), "Z"));
+
+        QVERIFY(!summary(cache, "a", "other").has_value());
+    }
+
+    void withoutScanData()
+    {
+        ContentHashCache cache(m_tempDir.filePath("cache"));
+        for(const QString& file: files())
+            hashFile(cache, "a" + file);
+
+        // Entries listed by QDir would need a stat() each, they get no summary.
+        QVERIFY(summary(cache, "a", "other").has_value());
+        QVERIFY(!summary(cache, "a", "other", false).has_value());
+    }
+};
+
+QTEST_MAIN(SubtreeSummaryTest);
+
+#include "SubtreeSummaryTest.moc"
@@ -0,0 +1,51 @@
+// clang-format off
+/*
+ * KDiff3 - Text Diff And Merge Tool
+ *
+ * SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+// clang-format on
+
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QString>
+
+// Helpers shared by the autotests that work on real files.
+namespace TestUtils {
+
+// Returns false if the file couldn't be written completely.
+[[nodiscard]] inline bool writeFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+[[nodiscard]] inline QByteArray randomData(qint32 size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for(char& c: data)
+        c = (char)QRandomGenerator::global()->bounded(256);
+    return data;
+}
+
+/*
+    Three versions of a short text for diff and merge tests: base.txt, copy.txt with the same
+    contents, changed2.txt and changed4.txt with the second resp. fourth line changed.
+*/
+[[nodiscard]] inline bool writeMergeFiles(const QDir& dir)
+{
+    return writeFile(dir.filePath("base.txt"), "1\n2\n3\n4\n5\n") &&
+           writeFile(dir.filePath("copy.txt"), "1\n2\n3\n4\n5\n") &&
+           writeFile(dir.filePath("changed2.txt"), "1\nB\n3\n4\n5\n") &&
+           writeFile(dir.filePath("changed4.txt"), "1\n2\n3\nC\n5\n");
+}
+
+} // namespace TestUtils
+
+#endif /* TESTUTILS_H */
@@ -617,7 +617,7 @@ qint32 ManualDiffHelpEntry::calcManualDiffFirstDiff3LineIdx(const Diff3LineVecto
 void DiffList::runDiff(const std::shared_ptr<LineDataVector>& p1, const size_t index1, LineRef size1, const std::shared_ptr<LineDataVector>& p2, const size_t index2, LineRef size2)
 {
     ProgressScope pp;
-    static GnuDiff gnuDiff; // All values are initialized with zeros.
+    static thread_local GnuDiff gnuDiff; // All values are initialized with zeros.
 
     ProgressProxy::setCurrent(0);
 
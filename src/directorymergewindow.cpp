@@ -12,20 +12,38 @@
 
 #include "compat.h"
 #include "CompositeIgnoreList.h"
+#include "ContentHashCache.h"
 #include "defmac.h"
 #include "DirectoryInfo.h"
+#include "DiskOrder.h"
+#include "FileFilter.h"
 #include "guiutils.h"
+#include "IoWorkerPool.h"
 #include "kdiff3.h"
+#include "LocalFileCopy.h"
 #include "Logging.h"
 #include "MergeFileInfos.h"
+#include "MergePrefetch.h"
 #include "options.h"
 #include "PixMapUtils.h"
 #include "progress.h"
+#include "ScanSnapshot.h"
+#include "SubtreeSummary.h"
 #include "TypeUtils.h"
 #include "Utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <QAction>
 #include <QApplication>
@@ -33,15 +51,20 @@
 #include <QDir>
 #include <QElapsedTimer>
 #include <QFileDialog>
+#include <QHash>
+#include <QInputDialog>
 #include <QKeyEvent>
 #include <QLabel>
 #include <QLayout>
 #include <QMenu>
 #include <QPainter>
 #include <QSplitter>
+#include <QStorageInfo>
 #include <QStyledItemDelegate>
 #include <QTextEdit>
 #include <QTextStream>
+#include <QThread>
+#include <QTimer>
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -119,8 +142,6 @@ enum Columns
     s_WhiteCol = 9     // Number of white deltas (for 2 input files)
 };
 
-static Qt::CaseSensitivity s_eCaseSensitivity = Qt::CaseSensitive;
-
 class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemModel
 {
     friend class DirMergeItem;
@@ -132,9 +153,19 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
         mWindow = pDMW;
         m_pStatusInfo = new StatusInfo(mWindow);
         m_pStatusInfo->hide();
+
+        m_pendingTimer.setInterval(100);
+        chk_connect_a(&m_pendingTimer, &QTimer::timeout, this, &DirectoryMergeWindowPrivate::processPendingComparisons);
+        m_bulkTimer.setInterval(100);
+        chk_connect_a(&m_bulkTimer, &QTimer::timeout, this, &DirectoryMergeWindowPrivate::processBulkOperations);
+        m_prefetchTimer.setInterval(100);
+        chk_connect_a(&m_prefetchTimer, &QTimer::timeout, this, &DirectoryMergeWindowPrivate::processPrefetch);
     }
     ~DirectoryMergeWindowPrivate() override
     {
+        stopPrefetch();
+        stopBulkOperations();
+        stopPendingComparisons();
         delete m_pRoot;
     }
 
@@ -150,8 +181,8 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
         if(pMFI == nullptr || pMFI == m_pRoot || pMFI->parent() == m_pRoot)
             return QModelIndex();
 
-        MergeFileInfos* pParentsParent = pMFI->parent()->parent();
-        return createIndex(SafeInt<qint32>(pParentsParent->children().indexOf(pMFI->parent())), 0, pMFI->parent());
+        sortChildren(pMFI->parent()->parent());
+        return createIndex(pMFI->parent()->row(), 0, pMFI->parent());
     }
 
     [[nodiscard]] qint32 rowCount(const QModelIndex& parent = QModelIndex()) const override
@@ -172,9 +203,15 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
     {
         MergeFileInfos* pParentMFI = getMFI(parent);
         if(pParentMFI == nullptr && row < m_pRoot->children().count())
+        {
+            sortChildren(m_pRoot);
             return createIndex(row, column, m_pRoot->children()[row]);
+        }
         else if(pParentMFI != nullptr && row < pParentMFI->children().count())
+        {
+            sortChildren(pParentMFI);
             return createIndex(row, column, pParentMFI->children()[row]);
+        }
         else
             return QModelIndex();
     }
@@ -196,6 +233,32 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
 
     QModelIndex nextSibling(const QModelIndex& mi);
 
+    [[nodiscard]] QModelIndex indexOf(MergeFileInfos* pMFI) const
+    {
+        if(pMFI == nullptr || pMFI == m_pRoot || pMFI->parent() == nullptr)
+            return QModelIndex();
+
+        sortChildren(pMFI->parent());
+        return createIndex(pMFI->row(), 0, pMFI);
+    }
+
+    /*
+        A folder's children are put in order the first time one of their rows is asked for,
+        folders that are never expanded are never sorted. Row numbers are only handed out
+        after this, so reordering doesn't move rows the view already knows about.
+    */
+    void sortChildren(MergeFileInfos* pParentMFI) const
+    {
+        pParentMFI->sortChildren(m_sortOrder, m_sortGeneration);
+    }
+
+    void rowChanged(MergeFileInfos* pMFI)
+    {
+        const QModelIndex mi = indexOf(pMFI);
+        if(mi.isValid())
+            Q_EMIT dataChanged(mi, mi.siblingAtColumn(columnCount(mi.parent()) - 1));
+    }
+
     // private data and helper methods
     [[nodiscard]] MergeFileInfos* getMFI(const QModelIndex& mi) const
     {
@@ -224,22 +287,94 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
     void mergeContinue(bool bStart, bool bVerbose);
 
     void prepareListView();
+    // Hands the items to the view, see prepareListView.
+    void insertRows();
+    [[nodiscard]] static QByteArray deviceOf(const FileAccess& dir);
+    void markIdenticalSubtrees();
+    static void sortByDiskOrder(std::vector<MergeFileInfos*>& items);
+    bool compareFilesConcurrently(QStringList& errors, qint32& currentIdx);
+    void showErrors(const QStringList& errors);
+    void saveHashCache();
+
+    // Lazy comparison, see compareFilesConcurrently.
+    void processPendingComparisons();
+    void adoptPendingComparison(MergeFileInfos& mfi, const MergeFileInfos& result, const QStringList& errors);
+    bool waitForPendingComparisons(const QModelIndex& miBegin, const QModelIndex& miEnd);
+    void stopPendingComparisons();
     void calcSuggestedOperation(const QModelIndex& mi, e_MergeOperation eDefaultMergeOp);
     void setAllMergeOperations(e_MergeOperation eDefaultOperation);
 
+    // Rename detection, see detectRenames.
+    enum class RenameSide
+    {
+        eNone,
+        eSideA,
+        eSideB
+    };
+    [[nodiscard]] static RenameSide copiedToSide(const MergeFileInfos& mfi);
+    [[nodiscard]] static RenameSide deletedFromSide(const MergeFileInfos& mfi);
+    // Unpaired items are grouped by the side they are copied to or deleted from, and their size.
+    using RenameGroup = std::pair<RenameSide, qint64>;
+    [[nodiscard]] static std::optional<RenameGroup> renameGroupOf(const MergeFileInfos& mfi, bool& bTarget);
+    void detectRenames();
+    // Only looks for partners in the groups of changedItems, the other pairs stay.
+    void detectRenames(const std::vector<MergeFileInfos*>& changedItems);
+    void pairRenames(const std::set<RenameGroup>* pGroups);
+
+    // True for paths below a folder snapshot given as A, B or C, nothing is there to read.
+    [[nodiscard]] static bool isInSnapshot(const QString& name);
+    // Writes the listing and the content hashes of one side to a ScanSnapshot file.
+    bool saveSnapshot(const FileAccess& dir, const DirectoryList& dirList, const QString& fileName, QString& errorText);
+
     bool canContinue();
     QModelIndex treeIterator(QModelIndex mi, bool bVisitChildren = true, bool bFindInvisible = false);
     void prepareMergeStart(const QModelIndex& miBegin, const QModelIndex& miEnd, bool bVerbose);
-    bool executeMergeOperation(const MergeFileInfos& mfi, bool& bSingleFileMerge);
+
+    // What executeMergeOperation needs of an item, taken from it on the GUI thread.
+    struct MergeOperation
+    {
+        e_MergeOperation m_eOperation = eNoOperation;
+        QString m_nameA;
+        QString m_nameB;
+        QString m_nameC;
+        QString m_destName;
+        // The file to rename to m_destName instead of copying, found by detectRenames.
+        QString m_renameFrom;
+    };
+    [[nodiscard]] MergeOperation mergeOperationOf(const MergeFileInfos& mfi) const;
+    bool executeMergeOperation(const MergeOperation& operation, bool& bSingleFileMerge);
+
+    // Operations that need no user, run ahead on a worker pool. See startBulkOperations.
+    [[nodiscard]] static bool isBulkOperation(const MergeFileInfos& mfi);
+    [[nodiscard]] static bool isDeleteOperation(e_MergeOperation eOperation);
+    void runRenames(bool bIncludeCurrent);
+    void startBulkOperations(bool bIncludeCurrent);
+    bool runMergeOperation(const MergeFileInfos& mfi, bool& bSingleFileMerge);
+    void processBulkOperations();
+    void stopBulkOperations();
+
+    // The files of the next manual merges, loaded and diffed ahead. See startPrefetch.
+    [[nodiscard]] static bool isManualMerge(const MergeFileInfos& mfi);
+    void startPrefetch();
+    void processPrefetch();
+    void stopPrefetch();
+    [[nodiscard]] std::unique_ptr<FullAnalysis::Comparison> takePrefetched(const MergePrefetch::Files& files);
 
     void scanDirectory(const QString& dirName, DirectoryList& dirList);
     void scanLocalDirectory(const QString& dirName, DirectoryList& dirList);
 
     void setMergeOperation(const QModelIndex& mi, e_MergeOperation eMergeOp, bool bRecursive = true);
+    // For operations chosen by the user, renames are looked for again.
+    void changeMergeOperation(const QModelIndex& mi, e_MergeOperation eMergeOp);
     [[nodiscard]] bool isDir(const QModelIndex& mi) const;
     [[nodiscard]] QString getFileName(const QModelIndex& mi) const;
 
+    // Goes to the status dialog, or to the log of the operation when on a worker thread.
+    void addStatusText(const QString& text);
     bool copyFLD(const QString& srcName, const QString& destName);
+    bool renameOrCopyFLD(const QString& srcName, const QString& renameFrom, const QString& destName);
+    [[nodiscard]] static bool isDeltaCopy(const FileAccess& src, const FileAccess& dest);
+    bool deltaCopyFLD(const QString& srcName, const QString& destName);
     bool deleteFLD(const QString& name, bool bCreateBackup);
     bool makeDir(const QString& name, bool bQuiet = false);
     bool renameFLD(const QString& srcName, const QString& destName);
@@ -249,57 +384,77 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
     void buildMergeMap(const std::shared_ptr<DirectoryInfo>& dirInfo);
 
   private:
-    class FileKey
-    {
-      private:
-        const FileAccess* m_pFA;
+    MergeFileInfos* m_pRoot = new MergeFileInfos();
 
-      public:
-        explicit FileKey(const FileAccess& fa):
-            m_pFA(&fa) {}
+    // All items in the order of the folder listings, every folder before its contents.
+    std::deque<MergeFileInfos> m_fileMergeItems;
+    // Children are sorted when their rows are first needed, see sortChildren.
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    quint64 m_sortGeneration = 0;
+
+    struct PendingComparison
+    {
+        size_t m_jobId;
+        // What calcSuggestedOperation chose before the contents were known.
+        e_MergeOperation m_eDefaultMergeOp = eNoOperation;
+        e_MergeOperation m_eSuggestedOperation = eNoOperation;
+    };
 
-        quint32 getParents(const FileAccess* pFA, const FileAccess* v[], quint32 maxSize) const
+    // What a background comparison works on, see compareFilesConcurrently.
+    struct PendingCopy
+    {
+        explicit PendingCopy(const MergeFileInfos& mfi):
+            m_mfi(mfi)
         {
-            quint32 s = 0;
-            for(s = 0; pFA->parent() != nullptr; pFA = pFA->parent(), ++s)
+            if(mfi.existsInA())
             {
-                if(s == maxSize)
-                    break;
-                v[s] = pFA;
+                m_fileA = mfi.getFileInfoA()->threadCopy();
+                m_mfi.setFileInfoA(&m_fileA);
             }
-            return s;
-        }
-
-        // This is essentially the same as
-        // qint32 r = filePath().compare( fa.filePath() )
-        // if ( r<0 ) return true;
-        // if ( r==0 ) return m_col < fa.m_col;
-        // return false;
-        bool operator<(const FileKey& fk) const
-        {
-            const FileAccess* v1[100];
-            const FileAccess* v2[100];
-            quint32 v1Size = getParents(m_pFA, v1, 100);
-            quint32 v2Size = getParents(fk.m_pFA, v2, 100);
-
-            for(quint32 i = 0; i < v1Size && i < v2Size; ++i)
+            if(mfi.existsInB())
             {
-                qint32 r = v1[v1Size - i - 1]->fileName().compare(v2[v2Size - i - 1]->fileName(), s_eCaseSensitivity);
-                if(r < 0)
-                    return true;
-                else if(r > 0)
-                    return false;
+                m_fileB = mfi.getFileInfoB()->threadCopy();
+                m_mfi.setFileInfoB(&m_fileB);
+            }
+            if(mfi.existsInC())
+            {
+                m_fileC = mfi.getFileInfoC()->threadCopy();
+                m_mfi.setFileInfoC(&m_fileC);
             }
-
-            return v1Size < v2Size;
         }
+
+        // Points to the files below.
+        PendingCopy(const PendingCopy&) = delete;
+        PendingCopy& operator=(const PendingCopy&) = delete;
+
+        MergeFileInfos m_mfi;
+        FileAccess m_fileA;
+        FileAccess m_fileB;
+        FileAccess m_fileC;
     };
 
-    typedef QMap<FileKey, MergeFileInfos> t_fileMergeMap;
+    std::unique_ptr<IoWorkerPool> m_pPendingPool;
+    std::unordered_map<const MergeFileInfos*, PendingComparison> m_pendingComparisons;
+    QStringList m_pendingErrors;
+    QTimer m_pendingTimer;
 
-    MergeFileInfos* m_pRoot = new MergeFileInfos();
+    struct BulkOperation
+    {
+        size_t m_jobId;
+        // Set once the pool handed in the result. Renames are run before the pool starts, see runRenames.
+        bool m_bFinished = false;
+        bool m_bRan = false;
+        bool m_bSuccess = false;
+    };
 
-    t_fileMergeMap m_fileMergeMap;
+    std::unique_ptr<IoWorkerPool> m_pBulkPool;
+    std::unordered_map<const MergeFileInfos*, BulkOperation> m_bulkOperations;
+    QTimer m_bulkTimer;
+    // Set while a worker runs an operation, see addStatusText.
+    inline static thread_local QStringList* s_pOperationLog = nullptr;
+
+    MergePrefetch m_prefetch;
+    QTimer m_prefetchTimer;
 
   public:
     DirectoryMergeWindow* mWindow;
@@ -372,6 +527,7 @@ class DirectoryMergeWindow::DirectoryMergeWindowPrivate: public QAbstractItemMod
 
     QPointer<QAction> m_pDirSaveMergeState;
     QPointer<QAction> m_pDirLoadMergeState;
+    QPointer<QAction> m_pDirSaveSnapshot;
 };
 
 QVariant DirectoryMergeWindow::DirectoryMergeWindowPrivate::data(const QModelIndex& index, qint32 role) const
@@ -406,6 +562,11 @@ QVariant DirectoryMergeWindow::DirectoryMergeWindowPrivate::data(const QModelInd
 
             if(s_OpCol == index.column())
             {
+                if(const MergeFileInfos* pSource = pMFI->renameSource())
+                    return i18nc("Operation column message, %1 is a path", "Rename from %1", pSource->subPath());
+                if(const MergeFileInfos* pTarget = pMFI->renameTarget())
+                    return i18nc("Operation column message, %1 is a path", "Renamed to %1", pTarget->subPath());
+
                 bool bDir = pMFI->hasDir();
                 switch(pMFI->getOperation())
                 {
@@ -471,7 +632,7 @@ QVariant DirectoryMergeWindow::DirectoryMergeWindowPrivate::data(const QModelInd
                 switch(pMFI->getOpStatus())
                 {
                     case eOpStatusNone:
-                        return "";
+                        return pMFI->isContentPending() ? i18nc("Status column message", "Pending") : pMFI->identityStatus();
                     case eOpStatusDone:
                         return i18nc("Status column message", "Done");
                     case eOpStatusError:
@@ -673,6 +834,16 @@ bool DirectoryMergeWindow::isScanning()
     return d->m_bScanning;
 }
 
+std::unique_ptr<FullAnalysis::Comparison> DirectoryMergeWindow::takePrefetched(const QString& fn1, const QString& fn2, const QString& fn3)
+{
+    return d->takePrefetched({fn1, fn2, fn3});
+}
+
+void DirectoryMergeWindow::discardPrefetched()
+{
+    d->stopPrefetch();
+}
+
 qint32 DirectoryMergeWindow::totalColumnWidth()
 {
     qint32 w = 0;
@@ -733,15 +904,38 @@ bool DirectoryMergeWindow::init(
     return d->init(bDirectoryMerge, bReload);
 }
 
+/*
+    Pairs the entries of A, B and C. An entry is looked up by its parent item and its name, case
+    folded unless the comparison is case sensitive, so no paths are compared. The listings put
+    every folder before its contents, the parent item of an entry always exists already.
+*/
 void DirectoryMergeWindow::DirectoryMergeWindowPrivate::buildMergeMap(const std::shared_ptr<DirectoryInfo>& dirInfo)
 {
+    QHash<std::pair<const MergeFileInfos*, QString>, MergeFileInfos*> items;
+    std::unordered_map<const FileAccess*, MergeFileInfos*> dirItems;
+    items.reserve(SafeInt<qsizetype>(dirInfo->getDirListA().size() + dirInfo->getDirListB().size() + dirInfo->getDirListC().size()));
+
+    const auto findItem = [this, &items, &dirItems](FileAccess& fileRecord) -> MergeFileInfos& {
+        const auto parentIt = dirItems.find(fileRecord.parent());
+        MergeFileInfos* pParent = parentIt != dirItems.end() ? parentIt->second : m_pRoot; // Top level
+        const QString key = m_bCaseSensitive ? fileRecord.fileName() : fileRecord.fileName().toCaseFolded();
+
+        MergeFileInfos*& pMFI = items[{pParent, key}];
+        if(pMFI == nullptr)
+        {
+            pMFI = &m_fileMergeItems.emplace_back();
+            pMFI->setParent(pParent);
+        }
+        if(fileRecord.isDir())
+            dirItems[&fileRecord] = pMFI;
+        return *pMFI;
+    };
+
     if(dirInfo->dirA().isValid())
     {
         for(FileAccess& fileRecord: dirInfo->getDirListA())
         {
-            MergeFileInfos& mfi = m_fileMergeMap[FileKey(fileRecord)];
-
-            mfi.setFileInfoA(&fileRecord);
+            findItem(fileRecord).setFileInfoA(&fileRecord);
         }
     }
 
@@ -749,9 +943,7 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::buildMergeMap(const std:
     {
         for(FileAccess& fileRecord: dirInfo->getDirListB())
         {
-            MergeFileInfos& mfi = m_fileMergeMap[FileKey(fileRecord)];
-
-            mfi.setFileInfoB(&(fileRecord));
+            findItem(fileRecord).setFileInfoB(&fileRecord);
         }
     }
 
@@ -759,9 +951,7 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::buildMergeMap(const std:
     {
         for(FileAccess& fileRecord: dirInfo->getDirListC())
         {
-            MergeFileInfos& mfi = m_fileMergeMap[FileKey(fileRecord)];
-
-            mfi.setFileInfoC(&(fileRecord));
+            findItem(fileRecord).setFileInfoC(&fileRecord);
         }
     }
 }
@@ -780,6 +970,12 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
         Q_EMIT mWindow->startDiffMerge(errors, "", "", "", "", "", "", "", nullptr); // hide main window
     }
 
+    // The items the background comparisons write to are about to go away.
+    stopPendingComparisons();
+    stopBulkOperations();
+    stopPrefetch();
+    m_bulkOperations.clear();
+
     mWindow->show();
     mWindow->setUpdatesEnabled(true);
 
@@ -818,6 +1014,8 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
     beginResetModel();
     m_pRoot->clear();
     m_mergeItemList.clear();
+    // New rows are added in listing order until the view sorts them.
+    m_sortGeneration = 0;
     endResetModel();
 
     m_currentIndexForOperation = m_mergeItemList.end();
@@ -876,12 +1074,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
 
     m_bSyncMode = gOptions->m_bDmSyncMode && gDirInfo->allowSyncMode();
 
-    m_fileMergeMap.clear();
-    s_eCaseSensitivity = m_bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-    // calc how many directories will be read:
-    double nofScans = (dirA.isValid() ? 1 : 0) + (dirB.isValid() ? 1 : 0) + (dirC.isValid() ? 1 : 0);
-    qint32 currentScan = 0;
-
+    m_fileMergeItems.clear();
     mWindow->setColumnHidden(s_CCol, !dirC.isValid());
     mWindow->setColumnHidden(s_WhiteCol, !gOptions->m_bDmFullAnalysis);
     mWindow->setColumnHidden(s_NonWhiteCol, !gOptions->m_bDmFullAnalysis);
@@ -892,35 +1085,12 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
     bool bListDirSuccessB = true;
     bool bListDirSuccessC = true;
 
-    if(dirA.isValid())
-    {
-        ProgressProxy::setInformation(i18nc("Status message", "Reading Folder A"));
-        ProgressProxy::setSubRangeTransformation(currentScan / nofScans, (currentScan + 1) / nofScans);
-        ++currentScan;
-
-        bListDirSuccessA = gDirInfo->listDirA();
-    }
-
-    if(dirB.isValid())
-    {
-        ProgressProxy::setInformation(i18nc("Status message", "Reading Folder B"));
-        ProgressProxy::setSubRangeTransformation(currentScan / nofScans, (currentScan + 1) / nofScans);
-        ++currentScan;
-
-        bListDirSuccessB = gDirInfo->listDirB();
-    }
+    ProgressProxy::setInformation(i18nc("Status message", "Reading folders"));
+    gDirInfo->listDirs(bListDirSuccessA, bListDirSuccessB, bListDirSuccessC);
 
     e_MergeOperation eDefaultMergeOp;
     if(dirC.isValid())
-    {
-        ProgressProxy::setInformation(i18nc("Status message", "Reading Folder C"));
-        ProgressProxy::setSubRangeTransformation(currentScan / nofScans, (currentScan + 1) / nofScans);
-        ++currentScan;
-
-        bListDirSuccessC = gDirInfo->listDirC();
-
         eDefaultMergeOp = eMergeABCToDest;
-    }
     else
         eDefaultMergeOp = m_bSyncMode ? eMergeToAB : eMergeABToDest;
 
@@ -949,6 +1119,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
             QModelIndex mi = index(childIdx, 0, QModelIndex());
             calcSuggestedOperation(mi, eDefaultMergeOp);
         }
+        detectRenames();
     }
 
     mWindow->sortByColumn(0, Qt::AscendingOrder);
@@ -971,15 +1142,20 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::init(
             calcDirStatus(dirC.isValid(), index(childIdx, 0, QModelIndex()),
                           nofFiles, nofDirs, nofEqualFiles, nofManualMerges);
 
+        // Pending files are counted as different by calcDirStatus.
+        const qint32 nofPendingFiles = SafeInt<qint32>(m_pendingComparisons.size());
+
         QString s;
         s = i18n("Folder Comparison Status\n\n"
                  "Number of subfolders: %1\n"
                  "Number of equal files: %2\n"
                  "Number of different files: %3",
-                 nofDirs, nofEqualFiles, nofFiles - nofEqualFiles);
+                 nofDirs, nofEqualFiles, nofFiles - nofEqualFiles - nofPendingFiles);
 
         if(dirC.isValid())
             s += u'\n' + i18n("Number of manual merges: %1", nofManualMerges);
+        if(nofPendingFiles > 0)
+            s += u'\n' + i18n("Number of files still being compared: %1", nofPendingFiles);
         KMessageBox::information(mWindow, s);
         //
         //TODO
@@ -1083,72 +1259,72 @@ void DirectoryMergeWindow::slotUnfoldAllSubdirs()
 // Merge current item (merge mode)
 void DirectoryMergeWindow::slotCurrentDoNothing()
 {
-    d->setMergeOperation(currentIndex(), eNoOperation);
+    d->changeMergeOperation(currentIndex(), eNoOperation);
 }
 
 void DirectoryMergeWindow::slotCurrentChooseA()
 {
-    d->setMergeOperation(currentIndex(), d->m_bSyncMode ? eCopyAToB : eCopyAToDest);
+    d->changeMergeOperation(currentIndex(), d->m_bSyncMode ? eCopyAToB : eCopyAToDest);
 }
 
 void DirectoryMergeWindow::slotCurrentChooseB()
 {
-    d->setMergeOperation(currentIndex(), d->m_bSyncMode ? eCopyBToA : eCopyBToDest);
+    d->changeMergeOperation(currentIndex(), d->m_bSyncMode ? eCopyBToA : eCopyBToDest);
 }
 
 void DirectoryMergeWindow::slotCurrentChooseC()
 {
-    d->setMergeOperation(currentIndex(), eCopyCToDest);
+    d->changeMergeOperation(currentIndex(), eCopyCToDest);
 }
 
 void DirectoryMergeWindow::slotCurrentMerge()
 {
     bool bThreeDirs = d->isDirThreeWay();
-    d->setMergeOperation(currentIndex(), bThreeDirs ? eMergeABCToDest : eMergeABToDest);
+    d->changeMergeOperation(currentIndex(), bThreeDirs ? eMergeABCToDest : eMergeABToDest);
 }
 
 void DirectoryMergeWindow::slotCurrentDelete()
 {
-    d->setMergeOperation(currentIndex(), eDeleteFromDest);
+    d->changeMergeOperation(currentIndex(), eDeleteFromDest);
 }
 // Sync current item
 void DirectoryMergeWindow::slotCurrentCopyAToB()
 {
-    d->setMergeOperation(currentIndex(), eCopyAToB);
+    d->changeMergeOperation(currentIndex(), eCopyAToB);
 }
 
 void DirectoryMergeWindow::slotCurrentCopyBToA()
 {
-    d->setMergeOperation(currentIndex(), eCopyBToA);
+    d->changeMergeOperation(currentIndex(), eCopyBToA);
 }
 
 void DirectoryMergeWindow::slotCurrentDeleteA()
 {
-    d->setMergeOperation(currentIndex(), eDeleteA);
+    d->changeMergeOperation(currentIndex(), eDeleteA);
 }
 
 void DirectoryMergeWindow::slotCurrentDeleteB()
 {
-    d->setMergeOperation(currentIndex(), eDeleteB);
+    d->changeMergeOperation(currentIndex(), eDeleteB);
 }
 
 void DirectoryMergeWindow::slotCurrentDeleteAAndB()
 {
-    d->setMergeOperation(currentIndex(), eDeleteAB);
+    d->changeMergeOperation(currentIndex(), eDeleteAB);
 }
 
 void DirectoryMergeWindow::slotCurrentMergeToA()
 {
-    d->setMergeOperation(currentIndex(), eMergeToA);
+    d->changeMergeOperation(currentIndex(), eMergeToA);
 }
 void DirectoryMergeWindow::slotCurrentMergeToB()
 {
-    d->setMergeOperation(currentIndex(), eMergeToB);
+    d->changeMergeOperation(currentIndex(), eMergeToB);
 }
 
 void DirectoryMergeWindow::slotCurrentMergeToAAndB()
 {
-    d->setMergeOperation(currentIndex(), eMergeToAB);
+    d->changeMergeOperation(currentIndex(), eMergeToAB);
 }
 
 void DirectoryMergeWindow::keyPressEvent(QKeyEvent* keyEvent)
@@ -1256,9 +1432,294 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::setAllMergeOperations(e_
         {
             calcSuggestedOperation(index(i, 0, QModelIndex()), eDefaultOperation);
         }
+        detectRenames();
     }
 }
 
+// The side that a file existing only on the other side would be copied to.
+DirectoryMergeWindow::DirectoryMergeWindowPrivate::RenameSide DirectoryMergeWindow::DirectoryMergeWindowPrivate::copiedToSide(const MergeFileInfos& mfi)
+{
+    const QString destDir = gDirInfo->destDir().prettyAbsPath();
+    switch(mfi.getOperation())
+    {
+        case eCopyAToB:
+            return mfi.onlyInA() ? RenameSide::eSideB : RenameSide::eNone;
+        case eCopyBToA:
+            return mfi.onlyInB() ? RenameSide::eSideA : RenameSide::eNone;
+        case eCopyAToDest:
+            return mfi.onlyInA() && destDir == gDirInfo->dirB().prettyAbsPath() ? RenameSide::eSideB : RenameSide::eNone;
+        case eCopyBToDest:
+            return mfi.onlyInB() && destDir == gDirInfo->dirA().prettyAbsPath() ? RenameSide::eSideA : RenameSide::eNone;
+        default:
+            return RenameSide::eNone;
+    }
+}
+
+// The side that a file existing only there would be deleted from.
+DirectoryMergeWindow::DirectoryMergeWindowPrivate::RenameSide DirectoryMergeWindow::DirectoryMergeWindowPrivate::deletedFromSide(const MergeFileInfos& mfi)
+{
+    const QString destDir = gDirInfo->destDir().prettyAbsPath();
+    switch(mfi.getOperation())
+    {
+        case eDeleteA:
+            return mfi.onlyInA() ? RenameSide::eSideA : RenameSide::eNone;
+        case eDeleteB:
+            return mfi.onlyInB() ? RenameSide::eSideB : RenameSide::eNone;
+        case eDeleteFromDest:
+            if(mfi.onlyInA() && destDir == gDirInfo->dirA().prettyAbsPath())
+                return RenameSide::eSideA;
+            if(mfi.onlyInB() && destDir == gDirInfo->dirB().prettyAbsPath())
+                return RenameSide::eSideB;
+            return RenameSide::eNone;
+        default:
+            return RenameSide::eNone;
+    }
+}
+
+std::optional<DirectoryMergeWindow::DirectoryMergeWindowPrivate::RenameGroup> DirectoryMergeWindow::DirectoryMergeWindowPrivate::renameGroupOf(const MergeFileInfos& mfi, bool& bTarget)
+{
+    if(mfi.renamePartner() != nullptr || mfi.hasDir() || mfi.hasLink() || mfi.existsCount() != 1)
+        return std::nullopt;
+
+    const FileAccess* pFile = mfi.existsInA() ? mfi.getFileInfoA() : mfi.getFileInfoB();
+    if(pFile == nullptr || pFile->size() == 0)
+        return std::nullopt;
+
+    const RenameSide eCopiedTo = copiedToSide(mfi);
+    const RenameSide eDeletedFrom = deletedFromSide(mfi);
+    bTarget = eCopiedTo != RenameSide::eNone;
+    if(bTarget)
+        return RenameGroup{eCopiedTo, pFile->size()};
+    if(eDeletedFrom != RenameSide::eNone)
+        return RenameGroup{eDeletedFrom, pFile->size()};
+    return std::nullopt;
+}
+
+/*
+    Pairs each file that would be copied to one side with an equal file that would be deleted there,
+    see MergeFileInfos::renameSource. The merge then renames the file instead of copying a new one
+    and deleting the old one, and a moved folder costs no more than its folder entries.
+
+    Only for two local folders and if enabled in the options. Files are grouped by side and size,
+    only groups with candidates for both are hashed, on an I/O worker pool. Empty files, links
+    and folders are never paired.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::detectRenames()
+{
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        if(MergeFileInfos* pPartner = mfi.unpairRename())
+        {
+            rowChanged(&mfi);
+            rowChanged(pPartner);
+        }
+    }
+
+    pairRenames(nullptr);
+}
+
+/*
+    Changing the operation of an item unpairs it, see setMergeOperation. The item or its former
+    partner may now fit another one, but hashing everything again is not worth it for one item.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::detectRenames(const std::vector<MergeFileInfos*>& changedItems)
+{
+    std::set<RenameGroup> groups;
+    for(const MergeFileInfos* pMFI: changedItems)
+    {
+        bool bTarget = false;
+        if(const std::optional<RenameGroup> group = renameGroupOf(*pMFI, bTarget))
+            groups.insert(*group);
+    }
+
+    if(!groups.empty())
+        pairRenames(&groups);
+}
+
+// Pairs the unpaired items of all groups or only of those in pGroups.
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::pairRenames(const std::set<RenameGroup>* pGroups)
+{
+    if(!gOptions->m_bDmDetectRenames || isDirThreeWay() || !gDirInfo->dirA().isLocal() || !gDirInfo->dirB().isLocal())
+        return;
+
+    struct Candidate
+    {
+        MergeFileInfos* m_pMFI;
+        FileAccess* m_pFile;
+        std::optional<QByteArray> m_hash;
+    };
+    struct Group
+    {
+        std::vector<Candidate> m_targets;
+        std::vector<Candidate> m_sources;
+    };
+    std::map<RenameGroup, Group> groups;
+
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        bool bTarget = false;
+        const std::optional<RenameGroup> group = renameGroupOf(mfi, bTarget);
+        if(!group.has_value() || (pGroups != nullptr && pGroups->count(*group) == 0))
+            continue;
+
+        FileAccess* pFile = mfi.existsInA() ? mfi.getFileInfoA() : mfi.getFileInfoB();
+        if(bTarget)
+            groups[*group].m_targets.push_back({&mfi, pFile, std::nullopt});
+        else
+            groups[*group].m_sources.push_back({&mfi, pFile, std::nullopt});
+    }
+
+    std::vector<Candidate*> candidates;
+    for(auto& [key, group]: groups)
+    {
+        if(group.m_targets.empty() || group.m_sources.empty())
+            continue;
+
+        for(Candidate& candidate: group.m_targets)
+            candidates.push_back(&candidate);
+        for(Candidate& candidate: group.m_sources)
+            candidates.push_back(&candidate);
+    }
+
+    if(candidates.empty())
+        return;
+
+    ProgressScope pp;
+    ProgressProxy::setInformation(i18nc("Status message", "Looking for renamed files"), false);
+    ProgressProxy::setMaxNofSteps(candidates.size());
+
+    const QByteArray deviceA = deviceOf(gDirInfo->dirA());
+    const QByteArray deviceB = deviceOf(gDirInfo->dirB());
+
+    IoWorkerPool pool;
+    for(Candidate* pCandidate: candidates)
+    {
+        const QByteArray& device = pCandidate->m_pMFI->existsInA() ? deviceA : deviceB;
+        pool.add(
+            device.isEmpty() ? QByteArrayList() : QByteArrayList{device},
+            [pCandidate]() { pCandidate->m_hash = MergeFileInfos::contentHash(*pCandidate->m_pFile); },
+            []() {
+                ProgressProxy::step();
+                return !ProgressProxy::wasCancelled();
+            });
+    }
+    if(!pool.run())
+        return;
+
+    for(auto& [key, group]: groups)
+    {
+        std::map<QByteArray, std::vector<MergeFileInfos*>> sources;
+        // Reversed, so each target takes the first source in tree order with its contents.
+        for(auto it = group.m_sources.rbegin(); it != group.m_sources.rend(); ++it)
+        {
+            if(it->m_hash.has_value())
+                sources[*it->m_hash].push_back(it->m_pMFI);
+        }
+
+        for(const Candidate& target: group.m_targets)
+        {
+            if(!target.m_hash.has_value())
+                continue;
+
+            const auto it = sources.find(*target.m_hash);
+            if(it == sources.end() || it->second.empty())
+                continue;
+
+            MergeFileInfos* pSource = it->second.back();
+            it->second.pop_back();
+            target.m_pMFI->pairRename(pSource);
+            rowChanged(target.m_pMFI);
+            rowChanged(pSource);
+        }
+    }
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::isInSnapshot(const QString& name)
+{
+    for(const FileAccess* pDir: {&gDirInfo->dirA(), &gDirInfo->dirB(), &gDirInfo->dirC()})
+    {
+        if(pDir->isSnapshot() && name.startsWith(pDir->absoluteFilePath() + u'/'))
+            return true;
+    }
+    return false;
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::saveSnapshot(const FileAccess& dir, const DirectoryList& dirList, const QString& fileName, QString& errorText)
+{
+    // The listing is not in any particular order, a folder must be stored before its contents.
+    std::unordered_map<const FileAccess*, std::vector<const FileAccess*>> children;
+    for(const FileAccess& entry: dirList)
+        children[entry.parent()].push_back(&entry);
+
+    std::vector<ScanSnapshot::Record> records;
+    std::vector<const FileAccess*> entries;
+    records.reserve(dirList.size());
+    entries.reserve(dirList.size());
+    std::vector<std::pair<const FileAccess*, qint32>> stack{{&dir, -1}};
+    while(!stack.empty())
+    {
+        const auto [pDir, dirIndex] = stack.back();
+        stack.pop_back();
+
+        const auto it = children.find(pDir);
+        if(it == children.end())
+            continue;
+
+        for(const FileAccess* pEntry: it->second)
+        {
+            ScanSnapshot::Record& record = records.emplace_back();
+            record.m_parent = dirIndex;
+            record.m_name = pEntry->fileName();
+            record.m_flags = (pEntry->isFile() ? ScanSnapshot::eFile : 0) | (pEntry->isDir() ? ScanSnapshot::eDir : 0) |
+                             (pEntry->isSymLink() ? ScanSnapshot::eSymLink : 0) | (pEntry->isBrokenLink() ? ScanSnapshot::eBrokenLink : 0) |
+                             (pEntry->isHidden() ? ScanSnapshot::eHidden : 0);
+            record.m_size = pEntry->size();
+            record.m_modified = pEntry->lastModified().toMSecsSinceEpoch();
+            record.m_linkTarget = pEntry->readLink();
+            entries.push_back(pEntry);
+
+            if(pEntry->isDir())
+                stack.emplace_back(pEntry, SafeInt<qint32>(records.size() - 1));
+        }
+    }
+
+    ProgressScope pp;
+    ProgressProxy::setInformation(i18nc("Status message", "Saving folder snapshot: %1", fileName), false);
+    ProgressProxy::setMaxNofSteps(records.size());
+
+    const QByteArray device = deviceOf(dir);
+    IoWorkerPool pool;
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        if(!entries[i]->isFile())
+        {
+            ProgressProxy::step();
+            continue;
+        }
+
+        ScanSnapshot::Record* pRecord = &records[i];
+        // Pending background comparisons may be reading the listed entry, the job opens its own.
+        const QString filePath = entries[i]->absoluteFilePath();
+        pool.add(
+            device.isEmpty() ? QByteArrayList() : QByteArrayList{device},
+            [pRecord, filePath]() {
+                FileAccess file(filePath);
+                pRecord->m_hash = MergeFileInfos::contentHash(file).value_or(QByteArray());
+            },
+            []() {
+                ProgressProxy::step();
+                return !ProgressProxy::wasCancelled();
+            });
+    }
+    if(!pool.run())
+    {
+        errorText = i18nc("@info:status", "Saving the folder snapshot was cancelled.");
+        return false;
+    }
+
+    return ScanSnapshot::save(fileName, dir.prettyAbsPath(), records, errorText);
+}
+
 QModelIndex DirectoryMergeWindow::DirectoryMergeWindowPrivate::nextSibling(const QModelIndex& mi)
 {
     QModelIndex miParent = mi.parent();
@@ -1314,75 +1775,427 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::prepareListView()
 
     mWindow->setRootIsDecorated(true);
 
-    qsizetype nrOfFiles = m_fileMergeMap.size();
+    qsizetype nrOfFiles = SafeInt<qsizetype>(m_fileMergeItems.size());
     qint32 currentIdx = 1;
     QElapsedTimer t;
     t.start();
     ProgressProxy::setMaxNofSteps(nrOfFiles);
 
-    for(MergeFileInfos& mfi: m_fileMergeMap)
+    if(gOptions->m_bDmUseHashCache && gOptions->m_bDmBinaryComparison)
     {
-        const QString& fileName = mfi.subPath();
+        gContentHashCache = std::make_unique<ContentHashCache>();
+        gContentHashCache->load();
+    }
+    if(gContentHashCache != nullptr || gDirInfo->dirA().isSnapshot() || gDirInfo->dirB().isSnapshot() || gDirInfo->dirC().isSnapshot())
+        markIdenticalSubtrees();
 
-        ProgressProxy::setInformation(
-            i18n("Processing %1 / %2\n%3", currentIdx, nrOfFiles, fileName), currentIdx, false);
-        if(ProgressProxy::wasCancelled()) break;
-        ++currentIdx;
+    /*
+        With lazy comparison the rows are shown at once and filled in as the results come in, the
+        workers only change copies. Otherwise the workers change the items themselves while the pool
+        keeps the event loop going, so the view gets the rows once they are done.
+    */
+    const bool bLazy = gOptions->m_bDmLazyCompare;
+    if(bLazy)
+        insertRows();
+    const bool bConcurrent = compareFilesConcurrently(errors, currentIdx);
+    if(!bLazy)
+        insertRows();
+
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        const bool bCompared = bConcurrent && mfi.canCompareConcurrently();
+
+        if(!bCompared)
+        {
+            ProgressProxy::setInformation(
+                i18n("Processing %1 / %2\n%3", currentIdx, nrOfFiles, mfi.subPath()), currentIdx, false);
+            ++currentIdx;
+        }
+        if(ProgressProxy::wasCancelled() || errors.size() >= 30) break;
 
         // The comparisons and calculations for each file take place here.
-        if(!mfi.compareFilesAndCalcAges(errors, mWindow) && errors.size() >= 30)
+        if(!bCompared && !mfi.compareFilesAndCalcAges(errors, mWindow) && errors.size() >= 30)
             break;
 
-        // Get dirname from fileName: Search for "/" from end:
-        qsizetype pos = fileName.lastIndexOf(u'/');
-        QString dirPart;
-        QString filePart;
-        if(pos == -1)
+        mfi.updateAge();
+        if(!bCompared)
+            rowChanged(&mfi);
+    }
+
+    // Background comparisons still use the cache.
+    if(m_pPendingPool == nullptr)
+        saveHashCache();
+
+    showErrors(errors);
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::insertRows()
+{
+    // The children of each folder in the order of m_fileMergeItems. A folder comes before its contents.
+    std::vector<std::pair<MergeFileInfos*, QList<MergeFileInfos*>>> newRows;
+    std::map<MergeFileInfos*, size_t> newRowGroups;
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        // Equality for parent dirs is set in updateFileVisibilities()
+        MergeFileInfos* pParent = mfi.parent();
+
+        const auto [it, bNewGroup] = newRowGroups.emplace(pParent, newRows.size());
+        if(bNewGroup)
+            newRows.emplace_back(pParent, QList<MergeFileInfos*>());
+        newRows[it->second].second.push_back(&mfi);
+    }
+
+    // So each folder's own group comes first and it is in the model by now.
+    for(const auto& [pParent, children]: newRows)
+    {
+        const qint32 firstRow = SafeInt<qint32>(pParent->children().count());
+        beginInsertRows(indexOf(pParent), firstRow, firstRow + SafeInt<qint32>(children.count()) - 1);
+        for(MergeFileInfos* pChild: children)
+            pParent->addChild(pChild);
+        endInsertRows();
+    }
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::showErrors(const QStringList& errors)
+{
+    if(errors.size() > 0)
+    {
+        if(errors.size() < 15)
         {
-            // Top dir
-            filePart = fileName;
+            KMessageBox::errorList(mWindow, i18n("Some files could not be processed."), errors);
         }
-        else
+        else if(errors.size() < 30)
         {
-            dirPart = fileName.left(pos);
-            filePart = fileName.mid(pos + 1);
+            KMessageBox::error(mWindow, i18n("Some files could not be processed."));
         }
+        else
+            KMessageBox::error(mWindow, i18n("Aborting due to too many errors."));
+    }
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::saveHashCache()
+{
+    if(gContentHashCache != nullptr)
+    {
+        if(!gContentHashCache->save(gOptions->m_dmHashCacheMaxEntries))
+            qCWarning(kdiffMain) << "Could not save the hash cache" << gContentHashCache->fileName();
+        gContentHashCache.reset();
+    }
+}
+
+/*
+    Folders with the same subtree summary in A, B and C hold the same files with the same contents,
+    so everything below them is equal without comparing a single file. The summaries are built on a
+    worker pool from what the scan and the hash cache already know.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::markIdenticalSubtrees()
+{
+    const bool bThreeWay = gDirInfo->dirC().isValid();
+
+    ProgressScope pp;
+    ProgressProxy::setInformation(i18nc("Status message", "Looking for identical folders"), false);
+
+    SubtreeSummary::Summaries summariesA;
+    SubtreeSummary::Summaries summariesB;
+    SubtreeSummary::Summaries summariesC;
+    IoWorkerPool pool;
+    pool.add({}, [&summariesA]() { summariesA = SubtreeSummary::compute(gDirInfo->dirA(), gDirInfo->getDirListA(), gContentHashCache.get()); }, nullptr);
+    pool.add({}, [&summariesB]() { summariesB = SubtreeSummary::compute(gDirInfo->dirB(), gDirInfo->getDirListB(), gContentHashCache.get()); }, nullptr);
+    if(bThreeWay)
+        pool.add({}, [&summariesC]() { summariesC = SubtreeSummary::compute(gDirInfo->dirC(), gDirInfo->getDirListC(), gContentHashCache.get()); }, nullptr);
+    if(!pool.run())
+        return;
+
+    const auto summary = [](const SubtreeSummary::Summaries& summaries, const FileAccess* pDir) -> const QByteArray* {
+        auto it = summaries.find(pDir);
+        return it != summaries.end() ? &it->second : nullptr;
+    };
+
+    // Folders of A whose whole subtree is identical everywhere.
+    std::unordered_set<const FileAccess*> identicalDirs;
+    for(const MergeFileInfos& mfi: std::as_const(m_fileMergeItems))
+    {
+        if(!mfi.existsEveryWhere() || !mfi.isDirA() || !mfi.isDirB() || (bThreeWay && !mfi.isDirC()))
+            continue;
+
+        const QByteArray* pSummaryA = summary(summariesA, mfi.getFileInfoA());
+        const QByteArray* pSummaryB = summary(summariesB, mfi.getFileInfoB());
+        const QByteArray* pSummaryC = bThreeWay ? summary(summariesC, mfi.getFileInfoC()) : pSummaryA;
+        if(pSummaryA != nullptr && pSummaryB != nullptr && pSummaryC != nullptr && *pSummaryA == *pSummaryB && *pSummaryA == *pSummaryC)
+            identicalDirs.insert(mfi.getFileInfoA());
+    }
+
+    if(identicalDirs.empty())
+        return;
+
+    qCInfo(kdiffMain) << "Found" << identicalDirs.size() << "identical folders.";
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        if(!mfi.existsInA())
+            continue;
 
-        if(dirPart.isEmpty()) // Top level
+        for(const FileAccess* pDir = mfi.getFileInfoA()->parent(); pDir != nullptr; pDir = pDir->parent())
         {
-            m_pRoot->addChild(&mfi); // new DirMergeItem( this, filePart, &mfi );
-            mfi.setParent(m_pRoot);
+            if(identicalDirs.count(pDir) != 0)
+            {
+                mfi.setInIdenticalSubtree();
+                break;
+            }
         }
-        else
-        {
-            const FileAccess* pFA = mfi.getFileInfoA() ? mfi.getFileInfoA() : mfi.getFileInfoB() ? mfi.getFileInfoB() :
-                                                                                                   mfi.getFileInfoC();
-            MergeFileInfos& dirMfi = pFA->parent() ? m_fileMergeMap[FileKey(*pFA->parent())] : *m_pRoot; // parent
+    }
+}
+
+/*
+    Orders the items by where the data of their first file is on its disk. Items on different
+    devices are still read in parallel by the worker pool, it moves jobs for an idle device ahead.
+    If the user cancels the lookup the items are left in the order of the tree.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::sortByDiskOrder(std::vector<MergeFileInfos*>& items)
+{
+    const QByteArray deviceA = deviceOf(gDirInfo->dirA());
+    const QByteArray deviceB = deviceOf(gDirInfo->dirB());
+    const QByteArray deviceC = deviceOf(gDirInfo->dirC());
+
+    std::vector<DiskOrder::File> files;
+    files.reserve(items.size());
+    for(const MergeFileInfos* pMFI: items)
+    {
+        DiskOrder::File& file = files.emplace_back();
+        const FileAccess* pFile = pMFI->existsInA() ? pMFI->getFileInfoA() : pMFI->existsInB() ? pMFI->getFileInfoB() : pMFI->getFileInfoC();
+        if(pFile == nullptr || !pFile->isLocal() || pFile->isSnapshot())
+            continue;
+
+        file.m_localPath = pFile->absoluteFilePath();
+        file.m_device = pMFI->existsInA() ? deviceA : pMFI->existsInB() ? deviceB : deviceC;
+    }
+
+    const std::optional<std::vector<size_t>> order = DiskOrder::sorted(files);
+    if(!order.has_value())
+        return;
+
+    const std::vector<MergeFileInfos*> treeOrder = items;
+    std::transform(order->begin(), order->end(), items.begin(), [&treeOrder](size_t index) { return treeOrder[index]; });
+}
+
+/*
+    Compares the contents of all local files on an I/O worker pool. Reads on one device are limited
+    so a spinning disk isn't thrashed, different devices are read in parallel. Results are collected
+    on the GUI thread as they come in.
 
-            dirMfi.addChild(&mfi); // new DirMergeItem( dirMfi.m_pDMI, filePart, &mfi );
-            mfi.setParent(&dirMfi);
-            //   // Equality for parent dirs is set in updateFileVisibilities()
+    With full analysis the files are diffed by FullAnalysis instead of going through the main window
+    one at a time.
+
+    With lazy comparison the pool is left running in the background and the files are marked as
+    pending. processPendingComparisons picks up the results, files on screen go first.
+
+    In disk order fewer files are compared at a time on each device, only neighbours on the disk.
+
+    Returns false if nothing was compared, prepareListView then does all the work itself.
+*/
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::compareFilesConcurrently(QStringList& errors, qint32& currentIdx)
+{
+    const bool bFullAnalysis = gOptions->m_bDmFullAnalysis;
+    const bool bLazy = gOptions->m_bDmLazyCompare;
+
+    const QByteArray deviceA = deviceOf(gDirInfo->dirA());
+    const QByteArray deviceB = deviceOf(gDirInfo->dirB());
+    const QByteArray deviceC = deviceOf(gDirInfo->dirC());
+
+    const qsizetype nrOfFiles = SafeInt<qsizetype>(m_fileMergeItems.size());
+    std::unique_ptr<IoWorkerPool> pPool = std::make_unique<IoWorkerPool>();
+    // Diffing is bound by the CPU rather than the disks.
+    if(bFullAnalysis)
+        pPool->setMaxThreads(QThread::idealThreadCount());
+
+    std::vector<MergeFileInfos*> items;
+    for(MergeFileInfos& mfi: m_fileMergeItems)
+    {
+        if(mfi.canCompareConcurrently())
+            items.push_back(&mfi);
+    }
+    if(gOptions->m_bDmDiskOrder)
+    {
+        pPool->setMaxPerDevice(DiskOrder::maxReadsPerDevice);
+        sortByDiskOrder(items);
+    }
+
+    for(MergeFileInfos* pMFI: items)
+    {
+        MergeFileInfos& mfi = *pMFI;
+        QByteArrayList devices;
+        if(mfi.existsInA() && !deviceA.isEmpty()) devices.append(deviceA);
+        if(mfi.existsInB() && !deviceB.isEmpty()) devices.append(deviceB);
+        if(mfi.existsInC() && !deviceC.isEmpty()) devices.append(deviceC);
+
+        /*
+            In the background the GUI thread uses the item meanwhile, so the worker fills in a copy.
+            Reading a file changes its FileAccess, the copy gets its own ones as well.
+        */
+        std::shared_ptr<PendingCopy> pCopy = bLazy ? std::make_shared<PendingCopy>(mfi) : nullptr;
+        MergeFileInfos& target = bLazy ? pCopy->m_mfi : mfi;
+        auto pErrors = std::make_shared<QStringList>();
+        IoWorkerPool::Job job = [&target, pCopy, pErrors, bFullAnalysis]() {
+            if(bFullAnalysis)
+            {
+                target.analyzeContents(*pErrors);
+                return;
+            }
+
+            QString status;
+            if(!target.compareContents(status, false))
+                pErrors->append(status);
+        };
+
+        if(bLazy)
+        {
+            mfi.setContentPending(true);
+            mfi.calcAges();
+            const size_t jobId = pPool->add(devices, std::move(job), [this, &mfi, pCopy, pErrors]() {
+                adoptPendingComparison(mfi, pCopy->m_mfi, *pErrors);
+                return true;
+            });
+            m_pendingComparisons[&mfi] = {jobId};
+            continue;
         }
 
-        mfi.updateAge();
+        pPool->add(
+            devices, std::move(job),
+            [this, &mfi, pErrors, bFullAnalysis, &errors, &currentIdx, nrOfFiles]() {
+                ProgressProxy::setInformation(
+                    i18n("Processing %1 / %2\n%3", currentIdx, nrOfFiles, mfi.subPath()), currentIdx, false);
+                ++currentIdx;
+
+                //Limit size of error list in memory.
+                for(const QString& error: std::as_const(*pErrors))
+                {
+                    if(errors.size() < 30)
+                        errors.append(error);
+                }
+
+                // Same as compareFilesAndCalcAges: a failed comparison has no ages, a failed analysis still does.
+                if(!pErrors->isEmpty() && (!bFullAnalysis || errors.size() >= 30))
+                    return errors.size() < 30;
+
+                // Not in the view yet, see prepareListView.
+                mfi.calcAges();
+                return true;
+            });
+    }
+
+    if(pPool->count() == 0)
+        return false;
+
+    if(bLazy)
+    {
+        m_pendingErrors.clear();
+        m_pPendingPool = std::move(pPool);
+        m_pPendingPool->start();
+        m_pendingTimer.start();
+        return true;
     }
 
-    if(errors.size() > 0)
+    pPool->run();
+    return true;
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::processPendingComparisons()
+{
+    if(m_pPendingPool == nullptr)
+        return;
+
+    // Rows on screen are compared first, the rest in the order of the tree.
+    const QRect viewRect = mWindow->viewport()->rect();
+    for(QModelIndex mi = mWindow->indexAt(viewRect.topLeft()); mi.isValid(); mi = mWindow->indexBelow(mi))
+    {
+        if(mWindow->visualRect(mi).top() > viewRect.bottom())
+            break;
+
+        const auto it = m_pendingComparisons.find(getMFI(mi));
+        if(it != m_pendingComparisons.end())
+            m_pPendingPool->prioritize(it->second.m_jobId);
+    }
+
+    if(m_pPendingPool->processDone(0))
+        return;
+
+    stopPendingComparisons();
+
+    // Folder equality and the visibility of equal files depend on all files below.
+    const QModelIndex selection1Index = m_selection1Index;
+    const QModelIndex selection2Index = m_selection2Index;
+    const QModelIndex selection3Index = m_selection3Index;
+    mWindow->updateFileVisibilities();
+    m_selection1Index = selection1Index;
+    m_selection2Index = selection2Index;
+    m_selection3Index = selection3Index;
+
+    Q_EMIT mWindow->statusBarMessage(i18nc("Status message", "All files compared."));
+    showErrors(m_pendingErrors);
+    m_pendingErrors.clear();
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::adoptPendingComparison(MergeFileInfos& mfi, const MergeFileInfos& result, const QStringList& errors)
+{
+    mfi.adoptComparison(result);
+
+    //Limit size of error list in memory.
+    for(const QString& error: errors)
+    {
+        if(m_pendingErrors.size() < 30)
+            m_pendingErrors.append(error);
+    }
+
+    const auto it = m_pendingComparisons.find(&mfi);
+    if(it == m_pendingComparisons.end())
+        return;
+    const PendingComparison pending = it->second;
+    m_pendingComparisons.erase(it);
+
+    // Unless the user chose something else meanwhile.
+    const QModelIndex mi = indexOf(&mfi);
+    if(mi.isValid() && mfi.getOperation() == pending.m_eSuggestedOperation)
+        calcSuggestedOperation(mi, pending.m_eDefaultMergeOp);
+
+    rowChanged(&mfi);
+}
+
+// Returns false if the user cancelled the wait.
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::waitForPendingComparisons(const QModelIndex& miBegin, const QModelIndex& miEnd)
+{
+    if(m_pPendingPool == nullptr || !miBegin.isValid())
+        return true;
+
+    std::vector<size_t> jobIds;
+    for(QModelIndex mi = miBegin; mi != miEnd; mi = treeIterator(mi))
     {
-        if(errors.size() < 15)
-        {
-            KMessageBox::errorList(mWindow, i18n("Some files could not be processed."), errors);
-        }
-        else if(errors.size() < 30)
-        {
-            KMessageBox::error(mWindow, i18n("Some files could not be processed."));
-        }
-        else
-            KMessageBox::error(mWindow, i18n("Aborting due to too many errors."));
+        const auto it = m_pendingComparisons.find(getMFI(mi));
+        if(it != m_pendingComparisons.end())
+            jobIds.push_back(it->second.m_jobId);
     }
 
-    beginResetModel();
-    endResetModel();
+    if(jobIds.empty())
+        return true;
+
+    ProgressScope pp;
+    ProgressProxy::setInformation(i18nc("Status message", "Waiting for the file comparisons"), false);
+    const bool bDone = m_pPendingPool->waitFor(jobIds);
+    // Finishes up if these were the last ones.
+    processPendingComparisons();
+    return bDone;
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::stopPendingComparisons()
+{
+    m_pendingTimer.stop();
+    if(m_pPendingPool == nullptr)
+        return;
+
+    // Waits for the workers, nothing touches the items or the hash cache after this.
+    m_pPendingPool->stop();
+    m_pPendingPool.reset();
+    m_pendingComparisons.clear();
+
+    saveHashCache();
 }
 
 void DirectoryMergeWindow::DirectoryMergeWindowPrivate::calcSuggestedOperation(const QModelIndex& mi, e_MergeOperation eDefaultMergeOp)
@@ -1580,6 +2393,14 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::calcSuggestedOperation(c
         }
         setMergeOperation(mi, eMO);
     }
+
+    // Worked out again once the contents are known.
+    const auto it = m_pendingComparisons.find(pMFI);
+    if(it != m_pendingComparisons.end())
+    {
+        it->second.m_eDefaultMergeOp = eDefaultMergeOp;
+        it->second.m_eSuggestedOperation = pMFI->getOperation();
+    }
 }
 
 void DirectoryMergeWindow::onDoubleClick(const QModelIndex& mi)
@@ -1830,7 +2651,8 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::selectItemAndColumn(cons
 void DirectoryMergeWindow::DirectoryMergeWindowPrivate::sort([[maybe_unused]] qint32 column, Qt::SortOrder order)
 {
     beginResetModel();
-    m_pRoot->sort(order);
+    m_sortOrder = order;
+    ++m_sortGeneration;
     endResetModel();
 }
 
@@ -1844,6 +2666,10 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::setMergeOperation(const
     {
         pMFI->startOperation();
         setOpStatus(mi, eOpStatusNone);
+
+        // The pair only holds for the operations it was found for.
+        if(MergeFileInfos* pPartner = pMFI->unpairRename())
+            rowChanged(pPartner);
     }
 
     pMFI->setOperation(eMergeOp);
@@ -1860,6 +2686,31 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::setMergeOperation(const
     }
 }
 
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::changeMergeOperation(const QModelIndex& mi, e_MergeOperation eMergeOp)
+{
+    MergeFileInfos* pMFI = getMFI(mi);
+    if(pMFI == nullptr)
+        return;
+
+    // The operations of the item and its children may change, as may their pairs.
+    std::vector<MergeFileInfos*> changedItems;
+    std::vector<MergeFileInfos*> stack{pMFI};
+    while(!stack.empty())
+    {
+        MergeFileInfos* pItem = stack.back();
+        stack.pop_back();
+        changedItems.push_back(pItem);
+        if(pItem->renamePartner() != nullptr)
+            changedItems.push_back(pItem->renamePartner());
+        stack.insert(stack.end(), pItem->children().begin(), pItem->children().end());
+    }
+
+    setMergeOperation(mi, eMergeOp);
+    // Renames were run at the start of the merge, see runRenames.
+    if(!m_bRealMergeStarted)
+        detectRenames(changedItems);
+}
+
 void DirectoryMergeWindow::compareCurrentFile()
 {
     if(!d->canContinue()) return;
@@ -2008,11 +2859,14 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::canContinue()
     return false;
 }
 
-bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(const MergeFileInfos& mfi, bool& bSingleFileMerge)
+DirectoryMergeWindow::DirectoryMergeWindowPrivate::MergeOperation DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeOperationOf(const MergeFileInfos& mfi) const
 {
-    bool bCreateBackups = gOptions->m_bDmCreateBakFiles;
+    MergeOperation operation;
+    operation.m_eOperation = mfi.getOperation();
+    operation.m_nameA = mfi.fullNameA();
+    operation.m_nameB = mfi.fullNameB();
+    operation.m_nameC = mfi.fullNameC();
     // First decide destname
-    QString destName;
     switch(mfi.getOperation())
     {
         case eNoOperation:
@@ -2022,15 +2876,19 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(co
         case eMergeToB:
         case eDeleteB:
         case eCopyAToB:
-            destName = mfi.fullNameB();
+            operation.m_destName = mfi.fullNameB();
             break;
         case eMergeToA:
         case eDeleteA:
         case eCopyBToA:
-            destName = mfi.fullNameA();
+            operation.m_destName = mfi.fullNameA();
             break;
-        case eMergeABToDest:
         case eMergeABCToDest:
+            if(!mfi.existsInA()) operation.m_nameA = QString("");
+            if(!mfi.existsInB()) operation.m_nameB = QString("");
+            if(!mfi.existsInC()) operation.m_nameC = QString("");
+            [[fallthrough]];
+        case eMergeABToDest:
         case eCopyAToDest:
         case eCopyBToDest:
         case eCopyCToDest:
@@ -2039,29 +2897,39 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(co
                 Do not replace with code that ignores gDirInfo->destDir().
                 Any such patch will be rejected. KDiff3 intentionally supports custom destination directories.
             */
-            destName = mfi.fullNameDest();
+            operation.m_destName = mfi.fullNameDest();
             break;
         default:
             KMessageBox::error(mWindow, i18n("Unknown merge operation. (This must never happen!)"));
     }
 
+    if(const MergeFileInfos* pSource = mfi.renameSource())
+        operation.m_renameFrom = deletedFromSide(*pSource) == RenameSide::eSideA ? pSource->fullNameA() : pSource->fullNameB();
+    return operation;
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(const MergeOperation& operation, bool& bSingleFileMerge)
+{
+    bool bCreateBackups = gOptions->m_bDmCreateBakFiles;
+    const QString& destName = operation.m_destName;
+
     bool bSuccess = false;
     bSingleFileMerge = false;
-    switch(mfi.getOperation())
+    switch(operation.m_eOperation)
     {
         case eNoOperation:
             bSuccess = true;
             break;
         case eCopyAToDest:
         case eCopyAToB:
-            bSuccess = copyFLD(mfi.fullNameA(), destName);
+            bSuccess = renameOrCopyFLD(operation.m_nameA, operation.m_renameFrom, destName);
             break;
         case eCopyBToDest:
         case eCopyBToA:
-            bSuccess = copyFLD(mfi.fullNameB(), destName);
+            bSuccess = renameOrCopyFLD(operation.m_nameB, operation.m_renameFrom, destName);
             break;
         case eCopyCToDest:
-            bSuccess = copyFLD(mfi.fullNameC(), destName);
+            bSuccess = copyFLD(operation.m_nameC, destName);
             break;
         case eDeleteFromDest:
         case eDeleteA:
@@ -2069,22 +2937,19 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(co
             bSuccess = deleteFLD(destName, bCreateBackups);
             break;
         case eDeleteAB:
-            bSuccess = deleteFLD(mfi.fullNameA(), bCreateBackups) &&
-                       deleteFLD(mfi.fullNameB(), bCreateBackups);
+            bSuccess = deleteFLD(operation.m_nameA, bCreateBackups) &&
+                       deleteFLD(operation.m_nameB, bCreateBackups);
             break;
         case eMergeABToDest:
         case eMergeToA:
         case eMergeToAB:
         case eMergeToB:
-            bSuccess = mergeFLD(mfi.fullNameA(), mfi.fullNameB(), "",
+            bSuccess = mergeFLD(operation.m_nameA, operation.m_nameB, "",
                                 destName, bSingleFileMerge);
             break;
         case eMergeABCToDest:
-            bSuccess = mergeFLD(
-                mfi.existsInA() ? mfi.fullNameA() : QString(""),
-                mfi.existsInB() ? mfi.fullNameB() : QString(""),
-                mfi.existsInC() ? mfi.fullNameC() : QString(""),
-                destName, bSingleFileMerge);
+            bSuccess = mergeFLD(operation.m_nameA, operation.m_nameB, operation.m_nameC,
+                                destName, bSingleFileMerge);
             break;
         default:
             KMessageBox::error(mWindow, i18n("Unknown merge operation."));
@@ -2093,10 +2958,371 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::executeMergeOperation(co
     return bSuccess;
 }
 
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::isBulkOperation(const MergeFileInfos& mfi)
+{
+    switch(mfi.getOperation())
+    {
+        case eCopyAToDest:
+        case eCopyAToB:
+        case eCopyBToDest:
+        case eCopyBToA:
+        case eCopyCToDest:
+        case eDeleteFromDest:
+        case eDeleteA:
+        case eDeleteB:
+        case eDeleteAB:
+            return true;
+        case eMergeABToDest:
+        case eMergeToA:
+        case eMergeToAB:
+        case eMergeToB:
+        case eMergeABCToDest:
+            // Merging folders only creates the destination.
+            return mfi.isDirA();
+        default:
+            return false;
+    }
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::isDeleteOperation(const e_MergeOperation eOperation)
+{
+    return eOperation == eDeleteFromDest || eOperation == eDeleteA || eOperation == eDeleteB || eOperation == eDeleteAB;
+}
+
+/*
+    Renames found by detectRenames come before all other operations. Otherwise the pool could
+    delete the file to be renamed, or the folder it is in, first. They are quick and run here,
+    the results are taken by runMergeOperation like those from the pool.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::runRenames(bool bIncludeCurrent)
+{
+    if(m_currentIndexForOperation == m_mergeItemList.end())
+        return;
+
+    const bool bSim = m_bSimulatedMergeStarted;
+    const auto first = bIncludeCurrent ? m_currentIndexForOperation : std::next(m_currentIndexForOperation);
+    for(auto it = first; it != m_mergeItemList.end(); ++it)
+    {
+        MergeFileInfos* pMFI = getMFI(*it);
+        if(pMFI == nullptr || pMFI->renameSource() == nullptr || (!bSim && !pMFI->isOperationRunning()) ||
+           m_bulkOperations.count(pMFI) != 0)
+            continue;
+
+        bool bSingleFileMerge = false;
+        const bool bSuccess = executeMergeOperation(mergeOperationOf(*pMFI), bSingleFileMerge);
+        m_bulkOperations[pMFI] = {0, true, true, bSuccess};
+
+        // A simulation leaves the file where it is, its delete would show up as well.
+        if(bSim && bSuccess)
+            m_bulkOperations[pMFI->renameSource()] = {0, true, true, true};
+    }
+}
+
+/*
+    Runs the copies, deletes and new folders of a real merge on a worker pool, ahead of
+    mergeContinue. That still visits every item in order and takes the result from here.
+
+    Only a batch of the next items is handed to the pool, it ends before the next manual merge.
+    runMergeOperation starts the next batch once mergeContinue gets past this one. So the pool
+    never works far ahead of the loop, nor past an item that needs the user.
+
+    An item waits for the nearest item above it in the tree, so folders exist before their
+    contents are copied into them. A run of deletes waits for all operations before it and the
+    other operations wait for all deletes before them, a copy never races a delete of the same
+    name in another case.
+
+    After the first failure no further item is started. The ones already running at that time
+    still finish, at most one per thread. Everything not run here is left to mergeContinue,
+    which stops at the failed item and lets the user decide as before.
+
+    Remote folders need KIO and stay on the GUI thread.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::startBulkOperations(bool bIncludeCurrent)
+{
+    // Items of one batch.
+    constexpr size_t maxBulkOperations = 256;
+
+    if(m_pBulkPool != nullptr || m_bSimulatedMergeStarted || m_currentIndexForOperation == m_mergeItemList.end())
+        return;
+
+    for(const FileAccess* pDir: {&gDirInfo->dirA(), &gDirInfo->dirB(), &gDirInfo->dirC(), &gDirInfo->destDir()})
+    {
+        if(pDir->isValid() && !pDir->isLocal())
+            return;
+    }
+
+    struct BulkResult
+    {
+        bool m_bRan = false;
+        bool m_bSuccess = false;
+        QStringList m_log;
+    };
+
+    std::unique_ptr<IoWorkerPool> pPool = std::make_unique<IoWorkerPool>();
+    std::unordered_map<const MergeFileInfos*, size_t> added;
+    // Set by the first operation that fails.
+    const auto pFailed = std::make_shared<std::atomic<bool>>(false);
+
+    const auto add = [this, &pPool, &added, pFailed](MergeFileInfos* pMFI, const std::vector<size_t>& prerequisites) {
+        auto pResult = std::make_shared<BulkResult>();
+        IoWorkerPool::Job job = [this, operation = mergeOperationOf(*pMFI), pResult, pFailed]() {
+            if(*pFailed)
+                return;
+
+            const ProgressMute mute;
+            s_pOperationLog = &pResult->m_log;
+            bool bSingleFileMerge = false;
+            pResult->m_bSuccess = executeMergeOperation(operation, bSingleFileMerge);
+            pResult->m_bRan = true;
+            s_pOperationLog = nullptr;
+            if(!pResult->m_bSuccess)
+                *pFailed = true;
+        };
+
+        const size_t jobId = pPool->add({}, std::move(job), [this, pMFI, pResult]() {
+            for(const QString& text: std::as_const(pResult->m_log))
+                m_pStatusInfo->addText(text);
+
+            const auto it = m_bulkOperations.find(pMFI);
+            if(it == m_bulkOperations.end())
+                return true;
+            it->second.m_bFinished = true;
+            it->second.m_bRan = pResult->m_bRan;
+            it->second.m_bSuccess = pResult->m_bSuccess;
+
+            // Folders are done with their contents, mergeContinue takes care of them.
+            const QModelIndex mi = indexOf(pMFI);
+            if(pResult->m_bSuccess && mi.isValid() && rowCount(mi) == 0)
+                setOpStatus(mi, eOpStatusDone);
+            return true;
+        }, prerequisites);
+
+        m_bulkOperations[pMFI] = {jobId};
+        added[pMFI] = jobId;
+    };
+
+    // The nearest item above in the tree that is run here.
+    const auto prerequisiteOf = [&added](const MergeFileInfos* pMFI) -> std::optional<size_t> {
+        for(const MergeFileInfos* pParent = pMFI->parent(); pParent != nullptr; pParent = pParent->parent())
+        {
+            const auto it = added.find(pParent);
+            if(it != added.end())
+                return it->second;
+        }
+        return std::nullopt;
+    };
+
+    // The jobs of the current run of deletes or of other operations.
+    std::vector<size_t> run;
+    bool bDeleteRun = false;
+    // Stands in for all jobs of the runs before, so the next run only needs to wait for this.
+    std::optional<size_t> barrierId;
+
+    const auto first = bIncludeCurrent ? m_currentIndexForOperation : std::next(m_currentIndexForOperation);
+    for(auto it = first; it != m_mergeItemList.end() && added.size() < maxBulkOperations; ++it)
+    {
+        MergeFileInfos* pMFI = getMFI(*it);
+        if(pMFI == nullptr || !pMFI->isOperationRunning())
+            continue;
+        // The batch ends here, mergeContinue stops for the user anyway.
+        if(isManualMerge(*pMFI))
+            break;
+        if(!isBulkOperation(*pMFI) || m_bulkOperations.count(pMFI) != 0)
+            continue;
+
+        const bool bDelete = isDeleteOperation(pMFI->getOperation());
+        if(!run.empty() && bDelete != bDeleteRun)
+        {
+            if(barrierId.has_value())
+                run.push_back(barrierId.value());
+            barrierId = pPool->add({}, []() {}, nullptr, run);
+            run.clear();
+        }
+        bDeleteRun = bDelete;
+
+        std::vector<size_t> prerequisites;
+        if(barrierId.has_value())
+            prerequisites.push_back(barrierId.value());
+        if(const std::optional<size_t> parentId = prerequisiteOf(pMFI))
+            prerequisites.push_back(parentId.value());
+
+        add(pMFI, prerequisites);
+        run.push_back(added.at(pMFI));
+    }
+
+    if(pPool->count() == 0)
+        return;
+
+    m_pBulkPool = std::move(pPool);
+    m_pBulkPool->start();
+    m_bulkTimer.start();
+}
+
+// The result of an item from the worker pool if it ran there, otherwise runs it here.
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::runMergeOperation(const MergeFileInfos& mfi, bool& bSingleFileMerge)
+{
+    auto it = m_bulkOperations.find(&mfi);
+    if(it == m_bulkOperations.end() && isBulkOperation(mfi) && !m_bSimulatedMergeStarted)
+    {
+        // Past the last batch, start the next one here.
+        stopBulkOperations();
+        startBulkOperations(true);
+        it = m_bulkOperations.find(&mfi);
+    }
+    if(it != m_bulkOperations.end() && !it->second.m_bFinished)
+    {
+        // Normally long finished, the pool works ahead.
+        if(!m_pBulkPool->waitFor({it->second.m_jobId}))
+            stopBulkOperations();
+        it = m_bulkOperations.find(&mfi);
+    }
+
+    if(it == m_bulkOperations.end())
+        return executeMergeOperation(mergeOperationOf(mfi), bSingleFileMerge);
+
+    const BulkOperation operation = it->second;
+    m_bulkOperations.erase(it);
+    // A prerequisite failed.
+    if(!operation.m_bRan)
+        return executeMergeOperation(mergeOperationOf(mfi), bSingleFileMerge);
+
+    bSingleFileMerge = false;
+    return operation.m_bSuccess;
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::processBulkOperations()
+{
+    if(m_pBulkPool != nullptr && !m_pBulkPool->processDone(0))
+        stopBulkOperations();
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::stopBulkOperations()
+{
+    m_bulkTimer.stop();
+    if(m_pBulkPool == nullptr)
+        return;
+
+    // Waits for the running operations and takes the results of all finished ones.
+    m_pBulkPool->stop();
+    m_pBulkPool->processDone(0);
+    m_pBulkPool.reset();
+
+    // The rest is left to mergeContinue or the next batch.
+    for(auto it = m_bulkOperations.begin(); it != m_bulkOperations.end();)
+    {
+        if(it->second.m_bFinished && it->second.m_bRan)
+            ++it;
+        else
+            it = m_bulkOperations.erase(it);
+    }
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::isManualMerge(const MergeFileInfos& mfi)
+{
+    switch(mfi.getOperation())
+    {
+        case eMergeABToDest:
+        case eMergeToA:
+        case eMergeToAB:
+        case eMergeToB:
+        case eMergeABCToDest:
+            return !mfi.hasDir();
+        default:
+            return false;
+    }
+}
+
+/*
+    While the user works on a manual merge, the files of the next ones are loaded and diffed on
+    worker threads, see MergePrefetch. When mergeFLD gets to them KDiff3App::slotFileOpen2 takes
+    the result instead of starting over. How many and how much memory is up to the options.
+
+    Called when a manual merge was shown and again when a round of jobs is over, to top up.
+    Remote files need KIO and are left alone, as are files of snapshots.
+*/
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::startPrefetch()
+{
+    if(m_bSimulatedMergeStarted || m_currentIndexForOperation == m_mergeItemList.end() || gOptions->m_dmPrefetchCount <= 0 ||
+       !FullAnalysis::isSupported())
+        return;
+
+    for(const FileAccess* pDir: {&gDirInfo->dirA(), &gDirInfo->dirB(), &gDirInfo->dirC()})
+    {
+        if(pDir->isValid() && !pDir->isLocal())
+            return;
+    }
+
+    std::vector<MergePrefetch::Files> upcoming;
+    for(auto it = std::next(m_currentIndexForOperation); it != m_mergeItemList.end() && (qint32)upcoming.size() < gOptions->m_dmPrefetchCount; ++it)
+    {
+        const MergeFileInfos* pMFI = getMFI(*it);
+        if(pMFI == nullptr || !pMFI->isOperationRunning() || !isManualMerge(*pMFI))
+            continue;
+
+        // The names mergeFLD passes on.
+        const MergeOperation operation = mergeOperationOf(*pMFI);
+        const MergePrefetch::Files files{operation.m_nameA, operation.m_nameB,
+                                         operation.m_eOperation == eMergeABCToDest ? operation.m_nameC : QString()};
+        if(isInSnapshot(files.m_fileA) || isInSnapshot(files.m_fileB) || isInSnapshot(files.m_fileC))
+            continue;
+
+        upcoming.push_back(files);
+    }
+
+    m_prefetch.setMaxMemory((qint64)gOptions->m_dmPrefetchMemoryMB * 1024 * 1024);
+    m_prefetch.prefetch(upcoming);
+    if(m_prefetch.isRunning())
+        m_prefetchTimer.start();
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::processPrefetch()
+{
+    if(m_prefetch.processDone())
+        return;
+
+    m_prefetchTimer.stop();
+    startPrefetch();
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::stopPrefetch()
+{
+    m_prefetchTimer.stop();
+    // Waits for the running jobs.
+    m_prefetch.clear();
+}
+
+std::unique_ptr<FullAnalysis::Comparison> DirectoryMergeWindow::DirectoryMergeWindowPrivate::takePrefetched(const MergePrefetch::Files& files)
+{
+    if(!m_prefetch.contains(files))
+        return nullptr;
+
+    std::unique_ptr<FullAnalysis::Comparison> pComparison = m_prefetch.take(files);
+    qCDebug(kdiffMain) << "Prefetched merge" << files.m_fileB << (pComparison != nullptr ? "used" : "discarded");
+    return pComparison;
+}
+
+void DirectoryMergeWindow::DirectoryMergeWindowPrivate::addStatusText(const QString& text)
+{
+    if(s_pOperationLog != nullptr)
+        s_pOperationLog->append(text);
+    else
+        m_pStatusInfo->addText(text);
+}
+
 // Check if the merge can start, and prepare the m_mergeItemList which then contains all
 // items that must be merged.
 void DirectoryMergeWindow::DirectoryMergeWindowPrivate::prepareMergeStart(const QModelIndex& miBegin, const QModelIndex& miEnd, bool bVerbose)
 {
+    // The operations of pending files aren't known yet.
+    if(!waitForPendingComparisons(miBegin, miEnd))
+        return;
+
+    if(gDirInfo->destDir().isSnapshot() || (m_bSyncMode && (gDirInfo->dirA().isSnapshot() || gDirInfo->dirB().isSnapshot())))
+    {
+        KMessageBox::error(mWindow, i18n("A folder snapshot is read-only. Choose a real folder as destination to merge."));
+        return;
+    }
+
     if(bVerbose)
     {
         KMessageBox::ButtonCode status = Compat::warningTwoActionsCancel(mWindow,
@@ -2120,6 +3346,7 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::prepareMergeStart(const
         m_bRealMergeStarted = true;
     }
 
+    stopPrefetch();
     m_mergeItemList.clear();
     if(!miBegin.isValid())
         return;
@@ -2273,6 +3500,9 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
     bool bSuccess = true;
     bool bSingleFileMerge = false;
     bool bSim = m_bSimulatedMergeStarted;
+    runRenames(bContinueWithCurrentItem);
+    if(!bSim)
+        startBulkOperations(bContinueWithCurrentItem);
     while(bSuccess)
     {
         MergeFileInfos* pMFI = getMFI(miCurrent);
@@ -2368,6 +3598,9 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
                 m_pStatusInfo->setWindowTitle(i18n("Simulated merge complete: Check if you agree with the proposed operations."));
                 m_pStatusInfo->exec();
             }
+            stopBulkOperations();
+            m_bulkOperations.clear();
+            stopPrefetch();
             m_mergeItemList.clear();
             m_bRealMergeStarted = false;
             return;
@@ -2380,7 +3613,7 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
                                       false // bRedrawUpdate
         );
 
-        bSuccess = executeMergeOperation(*pMFI, bSingleFileMerge); // Here the real operation happens.
+        bSuccess = runMergeOperation(*pMFI, bSingleFileMerge); // Here the real operation happens.
 
         if(bSuccess)
         {
@@ -2392,7 +3625,10 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
         }
 
         if(ProgressProxy::wasCancelled())
+        {
+            stopBulkOperations();
             break;
+        }
     } // end while
 
     //g_pProgressDialog->hide();
@@ -2401,6 +3637,8 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
     mWindow->scrollTo(miCurrent, EnsureVisible);
     if(!bSuccess && !bSingleFileMerge)
     {
+        // Nothing else is started until the user decided how to go on.
+        stopBulkOperations();
         KMessageBox::error(mWindow, i18n("An error occurred. Press OK to see detailed information."));
         m_pStatusInfo->setWindowTitle(i18n("Merge Error"));
         m_pStatusInfo->exec();
@@ -2418,11 +3656,82 @@ void DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeContinue(bool bStar
 
     if(m_currentIndexForOperation == m_mergeItemList.end())
     {
+        stopBulkOperations();
+        m_bulkOperations.clear();
+        stopPrefetch();
         m_mergeItemList.clear();
         m_bRealMergeStarted = false;
     }
 }
 
+// Large local files that replace an older version of themselves, see LocalFileCopy::deltaCopy.
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::isDeltaCopy(const FileAccess& src, const FileAccess& dest)
+{
+    if(!gOptions->m_bDmDeltaCopy || !src.isLocal() || !dest.isLocal() || !dest.exists())
+        return false;
+    if(!src.isNormal() || src.isDir() || src.isSymLink() || !dest.isNormal() || dest.isDir() || dest.isSymLink())
+        return false;
+
+    return src.size() >= (qint64)gOptions->m_dmDeltaCopyMinSizeMB * 1024 * 1024;
+}
+
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deltaCopyFLD(const QString& srcName, const QString& destName)
+{
+    // The backup is the older version the blocks are compared with.
+    QString baseName = destName;
+    if(gOptions->m_bDmCreateBakFiles)
+    {
+        baseName = destName + ".orig";
+        if(!renameFLD(destName, baseName))
+        {
+            addStatusText(i18n("Error: copy( %1 -> %2 ) failed."
+                               "Creating backup failed.",
+                               srcName, destName));
+            return false;
+        }
+    }
+
+    addStatusText(i18n("deltaCopy( %1 -> %2 )", srcName, destName));
+
+    if(m_bSimulatedMergeStarted)
+    {
+        return true;
+    }
+
+    QString errorText;
+    if(LocalFileCopy::deltaCopy(srcName, baseName, destName, errorText) == LocalFileCopy::eFailed)
+    {
+        addStatusText(errorText);
+        return false;
+    }
+    return true;
+}
+
+/*
+    Renames renameFrom to destName if it still has the contents of srcName, copies srcName otherwise.
+    The files may have changed since detectRenames compared them.
+*/
+bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::renameOrCopyFLD(const QString& srcName, const QString& renameFrom, const QString& destName)
+{
+    if(renameFrom.isEmpty())
+        return copyFLD(srcName, destName);
+
+    FileAccess faSrc(srcName);
+    FileAccess faRenameFrom(renameFrom);
+    if(faRenameFrom.exists() && faRenameFrom.size() == faSrc.size())
+    {
+        const std::optional<QByteArray> srcHash = MergeFileInfos::contentHash(faSrc);
+        const std::optional<QByteArray> renameFromHash = srcHash.has_value() ? MergeFileInfos::contentHash(faRenameFrom) : std::nullopt;
+        const qsizetype pos = destName.lastIndexOf(u'/');
+        if(srcHash.has_value() && srcHash == renameFromHash && (pos <= 0 || makeDir(destName.left(pos), true /*quiet*/)) &&
+           renameFLD(renameFrom, destName))
+            return true;
+    }
+
+    addStatusText(i18n("Cannot rename %1 to %2, copying instead.", renameFrom, destName));
+    return copyFLD(srcName, destName);
+}
+
 bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deleteFLD(const QString& name, bool bCreateBackup)
 {
     FileAccess fi(name, true);
@@ -2434,16 +3743,16 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deleteFLD(const QString&
         bool bSuccess = renameFLD(name, name + ".orig");
         if(!bSuccess)
         {
-            m_pStatusInfo->addText(i18n("Error: While deleting %1: Creating backup failed.", name));
+            addStatusText(i18n("Error: While deleting %1: Creating backup failed.", name));
             return false;
         }
     }
     else
     {
         if(fi.isDir() && !fi.isSymLink())
-            m_pStatusInfo->addText(i18n("delete folder recursively( %1 )", name));
+            addStatusText(i18n("delete folder recursively( %1 )", name));
         else
-            m_pStatusInfo->addText(i18n("delete( %1 )", name));
+            addStatusText(i18n("delete( %1 )", name));
 
         if(m_bSimulatedMergeStarted)
         {
@@ -2459,7 +3768,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deleteFLD(const QString&
             if(!bSuccess)
             {
                 // No Permission to read directory or other error.
-                m_pStatusInfo->addText(i18n("Error: delete folder operation failed while trying to read the folder."));
+                addStatusText(i18n("Error: delete folder operation failed while trying to read the folder."));
                 return false;
             }
 
@@ -2475,7 +3784,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deleteFLD(const QString&
                 bSuccess = FileAccess::removeDir(name);
                 if(!bSuccess)
                 {
-                    m_pStatusInfo->addText(i18n("Error: rmdir( %1 ) operation failed.", name)); // krazy:exclude=syscalls
+                    addStatusText(i18n("Error: rmdir( %1 ) operation failed.", name)); // krazy:exclude=syscalls
                     return false;
                 }
             }
@@ -2485,7 +3794,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::deleteFLD(const QString&
             bool bSuccess = fi.removeFile();
             if(!bSuccess)
             {
-                m_pStatusInfo->addText(i18n("Error: delete operation failed."));
+                addStatusText(i18n("Error: delete operation failed."));
                 return false;
             }
         }
@@ -2512,10 +3821,10 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeFLD(const QString&
             return false;
     }
 
-    m_pStatusInfo->addText(i18n("manual merge( %1, %2, %3 -> %4)", nameA, nameB, nameC, nameDest));
+    addStatusText(i18n("manual merge( %1, %2, %3 -> %4)", nameA, nameB, nameC, nameDest));
     if(m_bSimulatedMergeStarted)
     {
-        m_pStatusInfo->addText(i18n("     Note: After a manual merge the user should continue by pressing F7."));
+        addStatusText(i18n("     Note: After a manual merge the user should continue by pressing F7."));
         return true;
     }
 
@@ -2524,6 +3833,8 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::mergeFLD(const QString&
     mWindow->scrollTo(*m_currentIndexForOperation, EnsureVisible);
 
     Q_EMIT mWindow->startDiffMerge(errors, nameA, nameB, nameC, nameDest, "", "", "", nullptr);
+    // Meanwhile the next ones are prepared.
+    startPrefetch();
 
     return false;
 }
@@ -2537,21 +3848,31 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::copyFLD(const QString& s
 
     FileAccess fi(srcName);
     FileAccess faDest(destName, true);
+    if(isInSnapshot(srcName))
+    {
+        addStatusText(i18n("Error: copy( %1 -> %2 ) failed."
+                           "The source is part of a folder snapshot.",
+                           srcName, destName));
+        return false;
+    }
+    if(isDeltaCopy(fi, faDest))
+        return deltaCopyFLD(srcName, destName);
+
     if(faDest.exists() && !(fi.isDir() && faDest.isDir() && (fi.isSymLink() == faDest.isSymLink())))
     {
         bSuccess = deleteFLD(destName, gOptions->m_bDmCreateBakFiles);
         if(!bSuccess)
         {
-            m_pStatusInfo->addText(i18n("Error: copy( %1 -> %2 ) failed."
-                                        "Deleting existing destination failed.",
-                                        srcName, destName));
+            addStatusText(i18n("Error: copy( %1 -> %2 ) failed."
+                               "Deleting existing destination failed.",
+                               srcName, destName));
             return bSuccess;
         }
     }
 
     if(fi.isSymLink() && ((fi.isDir() && !m_bFollowDirLinks) || (!fi.isDir() && !m_bFollowFileLinks)))
     {
-        m_pStatusInfo->addText(i18n("copyLink( %1 -> %2 )", srcName, destName));
+        addStatusText(i18n("copyLink( %1 -> %2 )", srcName, destName));
 
         if(m_bSimulatedMergeStarted)
         {
@@ -2560,7 +3881,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::copyFLD(const QString& s
         FileAccess destFi(destName);
         if(!destFi.isLocal() || !fi.isLocal())
         {
-            m_pStatusInfo->addText(i18n("Error: copyLink failed: Remote links are not yet supported."));
+            addStatusText(i18n("Error: copyLink failed: Remote links are not yet supported."));
             return false;
         }
 
@@ -2570,7 +3891,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::copyFLD(const QString& s
         {
             bSuccess = FileAccess::symLink(linkTarget, destName);
             if(!bSuccess)
-                m_pStatusInfo->addText(i18n("Error: copyLink failed."));
+                addStatusText(i18n("Error: copyLink failed."));
         }
         return bSuccess;
     }
@@ -2593,7 +3914,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::copyFLD(const QString& s
             return false;
     }
 
-    m_pStatusInfo->addText(i18n("copy( %1 -> %2 )", srcName, destName));
+    addStatusText(i18n("copy( %1 -> %2 )", srcName, destName));
 
     if(m_bSimulatedMergeStarted)
     {
@@ -2602,12 +3923,12 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::copyFLD(const QString& s
 
     FileAccess faSrc(srcName);
     bSuccess = faSrc.copyFile(destName);
-    if(!bSuccess) m_pStatusInfo->addText(faSrc.getStatusText());
+    if(!bSuccess) addStatusText(faSrc.getStatusText());
     return bSuccess;
 }
 
 // Rename is not an operation that can be selected by the user.
-// It will only be used to create backups.
+// It will only be used to create backups and for the renames found by detectRenames.
 // Hence it will delete an existing destination without making a backup (of the old backup.)
 bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::renameFLD(const QString& srcName, const QString& destName)
 {
@@ -2619,14 +3940,14 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::renameFLD(const QString&
         bool bSuccess = deleteFLD(destName, false /*no backup*/);
         if(!bSuccess)
         {
-            m_pStatusInfo->addText(i18n("Error during rename( %1 -> %2 ): "
-                                        "Cannot delete existing destination.",
-                                        srcName, destName));
+            addStatusText(i18n("Error during rename( %1 -> %2 ): "
+                               "Cannot delete existing destination.",
+                               srcName, destName));
             return false;
         }
     }
 
-    m_pStatusInfo->addText(i18n("rename( %1 -> %2 )", srcName, destName));
+    addStatusText(i18n("rename( %1 -> %2 )", srcName, destName));
     if(m_bSimulatedMergeStarted)
     {
         return true;
@@ -2635,7 +3956,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::renameFLD(const QString&
     bool bSuccess = FileAccess(srcName).rename(destFile);
     if(!bSuccess)
     {
-        m_pStatusInfo->addText(i18n("Error: Rename failed."));
+        addStatusText(i18n("Error: Rename failed."));
         return false;
     }
 
@@ -2653,9 +3974,9 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::makeDir(const QString& n
         bool bSuccess = deleteFLD(name, true);
         if(!bSuccess)
         {
-            m_pStatusInfo->addText(i18n("Error during makeDir of %1. "
-                                        "Cannot delete existing file.",
-                                        name));
+            addStatusText(i18n("Error during makeDir of %1. "
+                               "Cannot delete existing file.",
+                               name));
             return false;
         }
     }
@@ -2670,7 +3991,7 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::makeDir(const QString& n
     }
 
     if(!bQuiet)
-        m_pStatusInfo->addText(i18n("makeDir( %1 )", name));
+        addStatusText(i18n("makeDir( %1 )", name));
 
     if(m_bSimulatedMergeStarted)
     {
@@ -2678,9 +3999,10 @@ bool DirectoryMergeWindow::DirectoryMergeWindowPrivate::makeDir(const QString& n
     }
 
     bool bSuccess = FileAccess::makeDir(name);
-    if(!bSuccess)
+    // Operations running side by side may create the same parent folder.
+    if(!bSuccess && !FileAccess(name, true).isDir())
     {
-        m_pStatusInfo->addText(i18n("Error while creating folder."));
+        addStatusText(i18n("Error while creating folder."));
         return false;
     }
     return true;
@@ -2748,11 +4070,13 @@ void DirectoryMergeInfo::addListViewItem(const QString& dir, const QString& base
 
     if(fi != nullptr && fi->exists())
     {
-        QString dateString = fi->lastModified().toString(QLocale::system().dateTimeFormat());
+        // A checksum manifest has no sizes and dates to show.
+        const bool bMetaData = fi->hasMetaData();
+        QString dateString = bMetaData ? fi->lastModified().toString(QLocale::system().dateTimeFormat()) : QString();
 
         m_pInfoList->addTopLevelItem(new QTreeWidgetItem(
             m_pInfoList,
-            {dir, QString(fi->isDir() ? i18nc("Header label", "Folder") : i18nc("Header label", "File")) + (fi->isSymLink() ? i18nc("Header label ending", "-Link") : ""), QString::number(fi->size()), QLatin1String(fi->isReadable() ? "r" : " ") + QLatin1String(fi->isWritable() ? "w" : " ") + QLatin1String((fi->isExecutable() ? "x" : " ")), dateString, QString(fi->isSymLink() ? (" -> " + fi->readLink()) : QString(""))}));
+            {dir, QString(fi->isDir() ? i18nc("Header label", "Folder") : i18nc("Header label", "File")) + (fi->isSymLink() ? i18nc("Header label ending", "-Link") : ""), bMetaData ? QString::number(fi->size()) : QString(), QLatin1String(fi->isReadable() ? "r" : " ") + QLatin1String(fi->isWritable() ? "w" : " ") + QLatin1String((fi->isExecutable() ? "x" : " ")), dateString, QString(fi->isSymLink() ? (" -> " + fi->readLink()) : QString(""))}));
     }
     else
     {
@@ -2866,6 +4190,56 @@ void DirectoryMergeWindow::slotLoadMergeState()
 {
 }
 
+void DirectoryMergeWindow::slotSaveSnapshot()
+{
+    struct Side
+    {
+        QString m_label;
+        const FileAccess* m_pDir;
+        DirectoryList* m_pDirList;
+    };
+    std::vector<Side> sides;
+    // Remote folders would have to be downloaded for the hashes.
+    const auto addSide = [&sides](const QString& label, const FileAccess& dir, DirectoryList& dirList) {
+        if(dir.isValid() && dir.isLocal() && !dir.isSnapshot())
+            sides.push_back({label + dir.prettyAbsPath(), &dir, &dirList});
+    };
+    addSide(i18n("A: "), gDirInfo->dirA(), gDirInfo->getDirListA());
+    addSide(i18n("B: "), gDirInfo->dirB(), gDirInfo->getDirListB());
+    addSide(i18n("C: "), gDirInfo->dirC(), gDirInfo->getDirListC());
+    if(sides.empty())
+    {
+        KMessageBox::error(this, i18n("Only local folders can be saved as a snapshot."));
+        return;
+    }
+
+    const Side* pSide = &sides.front();
+    if(sides.size() > 1)
+    {
+        QStringList labels;
+        for(const Side& side: sides)
+            labels.append(side.m_label);
+
+        bool bOk = false;
+        const QString label = QInputDialog::getItem(this, i18n("Save Folder Snapshot"), i18n("Folder:"), labels, 0, false, &bOk);
+        if(!bOk)
+            return;
+        pSide = &sides[labels.indexOf(label)];
+    }
+
+    const QString filter = i18n("Folder Snapshots (*%1)", ScanSnapshot::fileExtension());
+    QString fileName = QFileDialog::getSaveFileName(this, i18n("Save Folder Snapshot As..."), QDir::currentPath(), filter);
+    if(fileName.isEmpty())
+        return;
+    // Only files with this extension are opened as snapshots.
+    if(!fileName.endsWith(ScanSnapshot::fileExtension()))
+        fileName += ScanSnapshot::fileExtension();
+
+    QString errorText;
+    if(!d->saveSnapshot(*pSide->m_pDir, *pSide->m_pDirList, fileName, errorText))
+        KMessageBox::error(this, errorText);
+}
+
 void DirectoryMergeWindow::updateFileVisibilities()
 {
     bool bShowIdentical = d->m_pDirShowIdenticalFiles->isChecked();
@@ -2874,6 +4248,7 @@ void DirectoryMergeWindow::updateFileVisibilities()
     bool bShowOnlyInB = d->m_pDirShowFilesOnlyInB->isChecked();
     bool bShowOnlyInC = d->m_pDirShowFilesOnlyInC->isChecked();
     bool bThreeDirs = d->isDirThreeWay();
+    const FileFilter filter(gOptions->m_DmFilePattern, gOptions->m_DmFileAntiPattern, gOptions->m_DmDirAntiPattern, d->m_bCaseSensitive);
     d->m_selection1Index = QModelIndex();
     d->m_selection2Index = QModelIndex();
     d->m_selection3Index = QModelIndex();
@@ -2899,7 +4274,7 @@ void DirectoryMergeWindow::updateFileVisibilities()
                 (bShowOnlyInA && pMFI->onlyInA()) || (bShowOnlyInB && pMFI->onlyInB()) || (bShowOnlyInC && pMFI->onlyInC());
 
             QString fileName = pMFI->fileName();
-            bVisible = bVisible && ((bDir && !Utils::wildcardMultiMatch(gOptions->m_DmDirAntiPattern, fileName, d->m_bCaseSensitive)) || (Utils::wildcardMultiMatch(gOptions->m_DmFilePattern, fileName, d->m_bCaseSensitive) && !Utils::wildcardMultiMatch(gOptions->m_DmFileAntiPattern, fileName, d->m_bCaseSensitive)));
+            bVisible = bVisible && ((bDir && !filter.isDirExcluded(fileName)) || filter.isFileIncluded(fileName));
 
             if(loop != 0)
                 setRowHidden(mi.row(), mi.parent(), !bVisible);
@@ -2954,6 +4329,7 @@ void DirectoryMergeWindow::initDirectoryMergeActions(KDiff3App* pKDiff3App, KAct
     d->m_pDirFoldAll = GuiUtils::createAction<QAction>(i18n("Fold All Subfolders"), this, &DirectoryMergeWindow::collapseAll, ac, "dir_fold_all");
     d->m_pDirUnfoldAll = GuiUtils::createAction<QAction>(i18n("Unfold All Subfolders"), this, &DirectoryMergeWindow::expandAll, ac, "dir_unfold_all");
     d->m_pDirRescan = GuiUtils::createAction<QAction>(i18n("Rescan"), QKeySequence(Qt::SHIFT | Qt::Key_F5), this, &DirectoryMergeWindow::reload, ac, "dir_rescan");
+    d->m_pDirSaveSnapshot = GuiUtils::createAction<QAction>(i18n("Save Folder Snapshot..."), this, &DirectoryMergeWindow::slotSaveSnapshot, ac, "dir_save_snapshot");
     d->m_pDirSaveMergeState = nullptr; //GuiUtils::createAction< QAction >(i18n("Save Directory Merge State ..."), 0, this, &DirectoryMergeWindow::slotSaveMergeState, ac, "dir_save_merge_state");
     d->m_pDirLoadMergeState = nullptr; //GuiUtils::createAction< QAction >(i18n("Load Directory Merge State ..."), 0, this, &DirectoryMergeWindow::slotLoadMergeState, ac, "dir_load_merge_state");
     d->m_pDirChooseAEverywhere = GuiUtils::createAction<QAction>(i18n("Choose A for All Items"), this, &DirectoryMergeWindow::slotChooseAEverywhere, ac, "dir_choose_a_everywhere");
@@ -3017,6 +4393,7 @@ void DirectoryMergeWindow::updateAvailabilities(bool bMergeEditorVisible, bool b
     d->m_pDirMergeCurrent->setEnabled((bDirCompare && isVisible() && isFileSelected()) || bDiffWindowVisible);
 
     d->m_pDirRescan->setEnabled(bDirCompare);
+    d->m_pDirSaveSnapshot->setEnabled(bDirCompare);
 
     bool bThreeDirs = d->isDirThreeWay();
     d->m_pDirAutoChoiceEverywhere->setEnabled(bDirCompare && isVisible());
@@ -13,6 +13,7 @@
 
 #include "common.h"
 #include "fileaccess.h"
+#include "FullAnalysis.h"
 
 #include <QEvent>
 #include <QTreeWidget>
@@ -48,6 +49,10 @@ class DirectoryMergeWindow : public QTreeView
    qint32 totalColumnWidth();
    bool isSyncMode();
    bool isScanning();
+   // The files of a manual merge if they were loaded and diffed ahead, otherwise null.
+   [[nodiscard]] std::unique_ptr<FullAnalysis::Comparison> takePrefetched(const QString& fn1, const QString& fn2, const QString& fn3);
+   // Before the options change, the files prepared ahead were read with the old ones.
+   void discardPrefetched();
    void initDirectoryMergeActions(KDiff3App* pKDiff3App, KActionCollection* ac);
 
    void setupConnections(const KDiff3App* app);
@@ -111,6 +116,7 @@ class DirectoryMergeWindow : public QTreeView
 
    void slotSaveMergeState();
    void slotLoadMergeState();
+   void slotSaveSnapshot();
 
    void slotRefresh() { updateFileVisibilities(); };
 
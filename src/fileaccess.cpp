@@ -12,22 +12,30 @@
 #include "common.h"
 #include "compat.h"
 
+#include "AsyncFileReader.h"
 #if HAS_KFKIO && !defined AUTOTEST
 #include "DefaultFileAccessJobHandler.h"
 #endif
 #include "FileAccessJobHandler.h"
+#include "FileFilter.h"
 #include "IgnoreList.h"
 #include "Logging.h"
 #include "ProgressProxy.h"
+#include "ScanSnapshot.h"
 #include "Utils.h"
 
 #include <algorithm>                      // for min
 #include <cstdlib>
 #include <sys/stat.h>
+#include <vector>
 
 #ifndef Q_OS_WIN
+#include <fcntl.h>
 #include <unistd.h>
 #endif
+#ifdef Q_OS_LINUX
+#include <sys/sysmacros.h>
+#endif
 #include <utility>                        // for move
 
 #include <QDir>
@@ -35,14 +43,7 @@
 #include <QTemporaryFile>
 #include <QtMath>
 
-#if HAS_KFKIO && !defined AUTOTEST
-FileAccess::FileAccess()
-{
-    mJobHandler.reset(new DefaultFileAccessJobHandler(this));
-}
-#else
 FileAccess::FileAccess() = default;
-#endif
 
 FileAccess::~FileAccess() = default;
 
@@ -52,6 +53,7 @@ FileAccess::FileAccess(const FileAccess& b):
     m_bValidData{b.m_bValidData},
     m_baseDir{b.m_baseDir},
     m_fileInfo{b.m_fileInfo},
+    m_dirPath{b.m_dirPath},
     m_linkTarget{b.m_linkTarget},
     m_name{b.m_name},
     mDisplayName{b.mDisplayName},
@@ -68,16 +70,34 @@ FileAccess::FileAccess(const FileAccess& b):
     m_bWritable{b.m_bWritable},
     m_bReadable{b.m_bReadable},
     m_bExecutable{b.m_bExecutable},
-    m_bHidden{b.m_bHidden}
+    m_bHidden{b.m_bHidden},
+    m_bStatCached{b.m_bStatCached},
+    m_scanIdentity{b.m_scanIdentity},
+    m_pSnapshot{b.m_pSnapshot},
+    m_snapshotIndex{b.m_snapshotIndex}
 {
     mJobHandler.reset(b.mJobHandler ? b.mJobHandler->copy(this) : nullptr);
 }
 
+FileAccess FileAccess::threadCopy() const
+{
+    assert(isLocal());
+
+    FileAccess copy(*this);
+    copy.mJobHandler.reset();
+    copy.tmpFile.reset();
+    copy.realFile.reset();
+    if(m_dirPath.isEmpty())
+        copy.m_fileInfo = QFileInfo(m_fileInfo.absoluteFilePath());
+    return copy;
+}
+
 FileAccess::FileAccess(FileAccess&& b) noexcept:
     m_pParent{b.m_pParent},
     m_bValidData{b.m_bValidData},
     m_baseDir{b.m_baseDir},
     m_fileInfo{b.m_fileInfo},
+    m_dirPath{b.m_dirPath},
     m_linkTarget{b.m_linkTarget},
     m_name{b.m_name},
     mDisplayName{b.mDisplayName},
@@ -94,7 +114,11 @@ FileAccess::FileAccess(FileAccess&& b) noexcept:
     m_bWritable{b.m_bWritable},
     m_bReadable{b.m_bReadable},
     m_bExecutable{b.m_bExecutable},
-    m_bHidden{b.m_bHidden}
+    m_bHidden{b.m_bHidden},
+    m_bStatCached{b.m_bStatCached},
+    m_scanIdentity{b.m_scanIdentity},
+    m_pSnapshot{b.m_pSnapshot},
+    m_snapshotIndex{b.m_snapshotIndex}
 {
     mJobHandler.reset(b.mJobHandler.release());
     if(mJobHandler) mJobHandler->setFileAccess(this);
@@ -106,6 +130,7 @@ FileAccess::FileAccess(FileAccess&& b) noexcept:
 
     b.m_baseDir = QDir();
     b.m_fileInfo = QFileInfo();
+    b.m_dirPath = QString();
     b.m_linkTarget = QString();
     b.m_name = QString();
     b.mDisplayName = QString();
@@ -123,6 +148,10 @@ FileAccess::FileAccess(FileAccess&& b) noexcept:
     b.m_bReadable = false;
     b.m_bExecutable = false;
     b.m_bHidden = false;
+    b.m_bStatCached = false;
+    b.m_scanIdentity = std::nullopt;
+    b.m_pSnapshot = nullptr;
+    b.m_snapshotIndex = -1;
 }
 
 FileAccess& FileAccess::operator=(const FileAccess& b)
@@ -138,6 +167,7 @@ FileAccess& FileAccess::operator=(const FileAccess& b)
     m_bValidData = b.m_bValidData;
     m_baseDir = b.m_baseDir;
     m_fileInfo = b.m_fileInfo;
+    m_dirPath = b.m_dirPath;
     m_linkTarget = b.m_linkTarget;
     m_name = b.m_name;
     mDisplayName = b.mDisplayName;
@@ -155,6 +185,10 @@ FileAccess& FileAccess::operator=(const FileAccess& b)
     m_bReadable = b.m_bReadable;
     m_bExecutable = b.m_bExecutable;
     m_bHidden = b.m_bHidden;
+    m_bStatCached = b.m_bStatCached;
+    m_scanIdentity = b.m_scanIdentity;
+    m_pSnapshot = b.m_pSnapshot;
+    m_snapshotIndex = b.m_snapshotIndex;
     return *this;
 }
 
@@ -170,6 +204,7 @@ FileAccess& FileAccess::operator=(FileAccess&& b) noexcept
     m_bValidData = b.m_bValidData;
     m_baseDir = b.m_baseDir;
     m_fileInfo = b.m_fileInfo;
+    m_dirPath = b.m_dirPath;
     m_linkTarget = b.m_linkTarget;
     m_name = b.m_name;
     mDisplayName = b.mDisplayName;
@@ -187,6 +222,10 @@ FileAccess& FileAccess::operator=(FileAccess&& b) noexcept
     m_bReadable = b.m_bReadable;
     m_bExecutable = b.m_bExecutable;
     m_bHidden = b.m_bHidden;
+    m_bStatCached = b.m_bStatCached;
+    m_scanIdentity = b.m_scanIdentity;
+    m_pSnapshot = b.m_pSnapshot;
+    m_snapshotIndex = b.m_snapshotIndex;
 
     b.m_pParent = nullptr;
     b.m_url = QUrl();
@@ -194,6 +233,7 @@ FileAccess& FileAccess::operator=(FileAccess&& b) noexcept
 
     b.m_baseDir = QDir();
     b.m_fileInfo = QFileInfo();
+    b.m_dirPath = QString();
     b.m_linkTarget = QString();
     b.m_name = QString();
     b.mDisplayName = QString();
@@ -211,6 +251,10 @@ FileAccess& FileAccess::operator=(FileAccess&& b) noexcept
     b.m_bReadable = false;
     b.m_bExecutable = false;
     b.m_bHidden = false;
+    b.m_bStatCached = false;
+    b.m_scanIdentity = std::nullopt;
+    b.m_pSnapshot = nullptr;
+    b.m_snapshotIndex = -1;
     return *this;
 }
 
@@ -232,20 +276,25 @@ void FileAccess::reset()
     m_url.clear();
     m_name.clear();
     m_fileInfo = QFileInfo();
+    m_dirPath.clear();
     m_bExists = false;
     m_bFile = false;
     m_bDir = false;
     m_bSymLink = false;
     m_bWritable = false;
     m_bHidden = false;
+    m_bStatCached = false;
+    m_scanIdentity = std::nullopt;
     m_size = 0;
     m_modificationTime = QDateTime::fromMSecsSinceEpoch(0);
+    m_pSnapshot = nullptr;
+    m_snapshotIndex = -1;
 
     mDisplayName.clear();
     mPhysicalPath.clear();
     m_linkTarget.clear();
     //Cleanup temp file if any.
-    tmpFile = std::make_shared<QTemporaryFile>();
+    tmpFile.reset();
     realFile.reset();
 
     m_pParent = nullptr;
@@ -259,9 +308,6 @@ void FileAccess::reset()
 void FileAccess::setFile(FileAccess* pParent, const QFileInfo& fi)
 {
     assert(pParent != this);
-#if HAS_KFKIO && !defined AUTOTEST
-    if(mJobHandler == nullptr) mJobHandler.reset(new DefaultFileAccessJobHandler(this));
-#endif
     reset();
 
     m_fileInfo = fi;
@@ -285,9 +331,6 @@ void FileAccess::setFile(const QUrl& url, bool bWantToWrite)
     if(url.isEmpty())
         return;
 
-#if HAS_KFKIO && !defined AUTOTEST
-    if(mJobHandler == nullptr) mJobHandler.reset(new DefaultFileAccessJobHandler(this));
-#endif
     reset();
     assert(parent() == nullptr || url != parent()->url());
 
@@ -308,7 +351,7 @@ void FileAccess::setFile(const QUrl& url, bool bWantToWrite)
     {
         m_name = m_url.fileName();
 
-        if(mJobHandler->stat(bWantToWrite))
+        if(jobHandler()->stat(bWantToWrite))
             m_bValidData = true; // After running stat() the variables are initialised
                                  // and valid even if the file doesn't exist and the stat
                                  // query failed.
@@ -369,10 +412,32 @@ void FileAccess::loadData()
             m_modificationTime = QDateTime::fromMSecsSinceEpoch(0);
     }
 
-    realFile = std::make_shared<QFile>(absoluteFilePath());
+    // Created by localFile() once the file is actually opened.
+    realFile.reset();
     m_bValidData = true;
 }
 
+bool FileAccess::openSnapshot()
+{
+    if(!m_bFile || !ScanSnapshot::isSnapshotFile(m_name))
+        return false;
+
+    QString errorText;
+    m_pSnapshot = ScanSnapshot::open(absoluteFilePath(), errorText);
+    if(m_pSnapshot == nullptr)
+    {
+        setStatusText(errorText);
+        return false;
+    }
+
+    m_snapshotIndex = -1;
+    m_bFile = false;
+    m_bDir = true;
+    m_bWritable = false;
+    m_bStatCached = true;
+    return true;
+}
+
 void FileAccess::addPath(const QString& txt, bool reinit)
 {
     if(!isLocal())
@@ -576,6 +641,97 @@ void FileAccess::setFromUdsEntry(const KIO::UDSEntry& e, FileAccess* parent)
 }
 #endif
 
+#ifdef Q_OS_LINUX
+void FileAccess::setFromStat(FileAccess* pParent, const QString& dirPath, const QString& name,
+                             const struct statx& st, const struct statx* pTargetStat, const QString& linkTarget)
+{
+    assert(pParent != nullptr && pParent != this);
+    assert(dirPath.endsWith(u'/'));
+    reset();
+
+    m_pParent = pParent;
+    m_baseDir = pParent->m_baseDir;
+    m_dirPath = dirPath;
+    m_name = name;
+
+    m_bSymLink = S_ISLNK(st.stx_mode);
+    m_linkTarget = linkTarget;
+    m_bExists = true;
+    // Like QFileInfo, type, size and date of a symlink are those of its target.
+    const struct statx* pStat = m_bSymLink ? pTargetStat : &st;
+    if(pStat != nullptr)
+    {
+        m_bFile = S_ISREG(pStat->stx_mode);
+        m_bDir = S_ISDIR(pStat->stx_mode);
+        m_size = (qint64)pStat->stx_size;
+        m_modificationTime = QDateTime::fromMSecsSinceEpoch(pStat->stx_mtime.tv_sec * 1000 + pStat->stx_mtime.tv_nsec / 1000000);
+        // Like stat() in ContentHashCache::keyFor.
+        if((pStat->stx_mask & (STATX_INO | STATX_CTIME)) == (STATX_INO | STATX_CTIME))
+        {
+            ScanIdentity identity;
+            identity.m_device = (quint64)makedev(pStat->stx_dev_major, pStat->stx_dev_minor);
+            identity.m_inode = (quint64)pStat->stx_ino;
+            identity.m_mtimeNs = (qint64)pStat->stx_mtime.tv_sec * 1000000000 + pStat->stx_mtime.tv_nsec;
+            identity.m_ctimeNs = (qint64)pStat->stx_ctime.tv_sec * 1000000000 + pStat->stx_ctime.tv_nsec;
+            m_scanIdentity = identity;
+        }
+    }
+    else
+    {
+        m_bBrokenLink = true;
+    }
+    m_bHidden = m_name.startsWith(u'.');
+
+    m_bStatCached = true;
+    m_bValidData = true;
+}
+#endif
+
+void FileAccess::setFromSnapshot(FileAccess* pParent, const QString& dirPath, const std::shared_ptr<const ScanSnapshot>& pSnapshot, qint32 index)
+{
+    assert(pParent != nullptr && pParent != this);
+    assert(dirPath.endsWith(u'/'));
+    reset();
+
+    m_pParent = pParent;
+    m_baseDir = pParent->m_baseDir;
+    m_pSnapshot = pSnapshot;
+    m_snapshotIndex = index;
+    // Below the snapshot file as if it were a folder, nothing is there on disk.
+    m_dirPath = dirPath;
+    m_name = pSnapshot->name(index);
+
+    const quint32 flags = pSnapshot->flags(index);
+    m_bFile = (flags & ScanSnapshot::eFile) != 0;
+    m_bDir = (flags & ScanSnapshot::eDir) != 0;
+    m_bSymLink = (flags & ScanSnapshot::eSymLink) != 0;
+    m_bBrokenLink = (flags & ScanSnapshot::eBrokenLink) != 0;
+    m_bHidden = (flags & ScanSnapshot::eHidden) != 0;
+    m_linkTarget = pSnapshot->linkTarget(index);
+    m_size = pSnapshot->size(index);
+    m_modificationTime = pSnapshot->modified(index);
+    m_bExists = true;
+    m_bReadable = true;
+    m_bWritable = false;
+    m_bExecutable = false;
+
+    m_bStatCached = true;
+    m_bValidData = true;
+}
+
+std::optional<QByteArray> FileAccess::snapshotHash() const
+{
+    if(m_pSnapshot == nullptr || m_snapshotIndex < 0)
+        return std::nullopt;
+
+    return m_pSnapshot->hash(m_snapshotIndex);
+}
+
+bool FileAccess::hasMetaData() const
+{
+    return m_pSnapshot == nullptr || m_snapshotIndex < 0 || (m_pSnapshot->flags(m_snapshotIndex) & ScanSnapshot::eNoMetaData) == 0;
+}
+
 bool FileAccess::isValid() const
 {
     return m_bValidData;
@@ -583,7 +739,8 @@ bool FileAccess::isValid() const
 
 bool FileAccess::isNormal() const
 {
-    static quint32 depth = 0;
+    // Files are compared on worker threads, each needs its own link depth.
+    static thread_local quint32 depth = 0;
     /*
         Speed is important here isNormal is called for every file during directory
         comparison. It can therefor have great impact on overall performance.
@@ -592,7 +749,8 @@ bool FileAccess::isNormal() const
         links that point to links. Therefore we hard cap at 15 such links in a chain
         and make sure we don't cycle back to something we already saw.
     */
-    if(!mVisited && depth < 15 && isLocal() && isSymLink())
+    // The link target of a snapshot entry is not on this disk.
+    if(!mVisited && depth < 15 && isLocal() && !isSnapshot() && isSymLink())
     {
         /*
             wierd psudo-name created from commandline input redirection from output of another command.
@@ -623,47 +781,50 @@ bool FileAccess::isNormal() const
 
 bool FileAccess::isFile() const
 {
-    if(!isLocal())
+    if(!isLocal() || m_bStatCached)
         return m_bFile;
     else
-        return m_fileInfo.isFile();
+        return fileInfo().isFile();
 }
 
 bool FileAccess::isDir() const
 {
-    if(!isLocal())
+    if(!isLocal() || m_bStatCached)
         return m_bDir;
     else
-        return m_fileInfo.isDir();
+        return fileInfo().isDir();
 }
 
 bool FileAccess::isSymLink() const
 {
-    if(!isLocal())
+    if(!isLocal() || m_bStatCached)
         return m_bSymLink;
     else
-        return m_fileInfo.isSymLink();
+        return fileInfo().isSymLink();
 }
 
 bool FileAccess::exists() const
 {
-    if(!isLocal())
+    if(!isLocal() || m_bStatCached)
         return m_bExists;
     else
-        return (m_fileInfo.exists() || isSymLink()) && // QFileInfo.exists returns false for broken links,
+        return (fileInfo().exists() || isSymLink()) && // QFileInfo.exists returns false for broken links,
                absoluteFilePath() != "/dev/null";      // git uses /dev/null as a placeholder meaning does not exist
 }
 
 qint64 FileAccess::size() const
 {
-    if(!isLocal())
+    if(!isLocal() || m_bStatCached)
         return m_size;
     else
-        return m_fileInfo.size();
+        return fileInfo().size();
 }
 
-const QUrl& FileAccess::url() const
+QUrl FileAccess::url() const
 {
+    if(!m_dirPath.isEmpty())
+        return QUrl::fromLocalFile(absoluteFilePath());
+
     return m_url;
 }
 
@@ -679,33 +840,34 @@ bool FileAccess::isLocal() const
 bool FileAccess::isReadable() const
 {
     //This can be very slow in some network setups so use cached value
-    if(!isLocal())
+    if(!isLocal() || isSnapshot())
         return m_bReadable;
     else
-        return m_fileInfo.isReadable();
+        return fileInfo().isReadable();
 }
 
 bool FileAccess::isWritable() const
 {
     //This can be very slow in some network setups so use cached value
-    if(!isLocal())
+    if(!isLocal() || isSnapshot())
         return m_bWritable;
     else
-        return m_fileInfo.isWritable();
+        return fileInfo().isWritable();
 }
 
 bool FileAccess::isExecutable() const
 {
     //This can be very slow in some network setups so use cached value
-    if(!isLocal())
+    if(!isLocal() || isSnapshot())
         return m_bExecutable;
     else
-        return m_fileInfo.isExecutable();
+        return fileInfo().isExecutable();
 }
 
 bool FileAccess::isHidden() const
 {
-    if(!(isLocal()))
+    // Scanned entries know from their name.
+    if(!isLocal() || isSnapshot() || !m_dirPath.isEmpty())
         return m_bHidden;
     else
         return m_fileInfo.isHidden();
@@ -718,12 +880,19 @@ const QString& FileAccess::readLink() const
 
 QString FileAccess::absoluteFilePath() const
 {
+    if(!m_dirPath.isEmpty())
+        return m_dirPath + m_name;
     if(!isLocal())
         return m_url.url(); // return complete url
 
     return m_fileInfo.absoluteFilePath();
 } // Full abs path
 
+QFileInfo FileAccess::fileInfo() const
+{
+    return m_dirPath.isEmpty() ? m_fileInfo : QFileInfo(absoluteFilePath());
+}
+
 // Just the name-part of the path, without parent directories
 const QString& FileAccess::fileName(bool needTmp) const
 {
@@ -742,7 +911,7 @@ QString FileAccess::fileRelPath() const
 
     if(isLocal())
     {
-        path = m_baseDir.relativeFilePath(m_fileInfo.absoluteFilePath());
+        path = m_baseDir.relativeFilePath(absoluteFilePath());
 
         return path;
     }
@@ -821,7 +990,14 @@ bool FileAccess::readFile(void* pDestBuffer, qint64 maxLength)
     if(!isNormal())
         return true;
 
-    if(isLocal() || !m_localCopy.isEmpty())
+    if(isLocal() && m_localCopy.isEmpty() && !isSnapshot())
+    {
+        // Keeps several reads in flight, large files load faster.
+        AsyncFileReader reader;
+        success = reader.open(absoluteFilePath()) && reader.readAll((char*)pDestBuffer, maxLength);
+        setStatusText(reader.errorString());
+    }
+    else if(isLocal() || !m_localCopy.isEmpty())
     {
         if(open(QIODevice::ReadOnly))
         {
@@ -831,14 +1007,14 @@ bool FileAccess::readFile(void* pDestBuffer, qint64 maxLength)
     }
     else
     {
-        success = mJobHandler->get(pDestBuffer, maxLength);
+        success = jobHandler()->get(pDestBuffer, maxLength);
         if(ProgressProxy::wasCancelled())
             setStatusText(i18nc("@info %1 is a path", "User cancelled read operation on %1", absoluteFilePath()));
 
         close();
     }
 
-    assert((realFile == nullptr || !realFile->isOpen()) && !tmpFile->isOpen());
+    assert((realFile == nullptr || !realFile->isOpen()) && (tmpFile == nullptr || !tmpFile->isOpen()));
     return success;
 }
 
@@ -849,7 +1025,7 @@ bool FileAccess::writeFile(const void* pSrcBuffer, qint64 length)
     setStatusText("");
     if(isLocal())
     {
-        if(realFile->open(QIODevice::WriteOnly))
+        if(localFile().open(QIODevice::WriteOnly))
         {
             const qint64 maxChunkSize = 100000;
             ProgressProxy::setMaxNofSteps(length / maxChunkSize + 1);
@@ -881,31 +1057,31 @@ bool FileAccess::writeFile(const void* pSrcBuffer, qint64 length)
             }
 
             realFile->close();
-            assert((realFile == nullptr || !realFile->isOpen()) && !tmpFile->isOpen());
+            assert((realFile == nullptr || !realFile->isOpen()) && (tmpFile == nullptr || !tmpFile->isOpen()));
             return true;
         }
     }
     else
     {
-        bool success = mJobHandler->put(pSrcBuffer, length, true /*overwrite*/);
+        bool success = jobHandler()->put(pSrcBuffer, length, true /*overwrite*/);
         close();
 
-        assert((realFile == nullptr || !realFile->isOpen()) && !tmpFile->isOpen());
+        assert((realFile == nullptr || !realFile->isOpen()) && (tmpFile == nullptr || !tmpFile->isOpen()));
         return success;
     }
 
-    assert((realFile == nullptr || !realFile->isOpen()) && !tmpFile->isOpen());
+    assert((realFile == nullptr || !realFile->isOpen()) && (tmpFile == nullptr || !tmpFile->isOpen()));
     return false;
 }
 
 bool FileAccess::copyFile(const QString& dest)
 {
-    return mJobHandler->copyFile(dest); // Handles local and remote copying.
+    return jobHandler()->copyFile(dest); // Handles local and remote copying.
 }
 
 bool FileAccess::rename(const FileAccess& dest)
 {
-    return mJobHandler->rename(dest);
+    return jobHandler()->rename(dest);
 }
 
 bool FileAccess::removeFile()
@@ -916,7 +1092,7 @@ bool FileAccess::removeFile()
     }
     else
     {
-        return mJobHandler->removeFile(url());
+        return jobHandler()->removeFile(url());
     }
 }
 
@@ -924,11 +1100,84 @@ bool FileAccess::listDir(DirectoryList* pDirList, bool bRecursive, bool bFindHid
                          const QString& filePattern, const QString& fileAntiPattern, const QString& dirAntiPattern,
                          bool bFollowDirLinks, IgnoreList& ignoreList) const
 {
-    assert(mJobHandler != nullptr);
-    return mJobHandler->listDir(pDirList, bRecursive, bFindHidden, filePattern, fileAntiPattern,
+    // There are no ignore files to read in a snapshot and its links were never followed.
+    if(isSnapshot())
+        return listSnapshot(pDirList, bRecursive, bFindHidden, FileFilter(filePattern, fileAntiPattern, dirAntiPattern));
+
+    return jobHandler()->listDir(pDirList, bRecursive, bFindHidden, filePattern, fileAntiPattern,
                       dirAntiPattern, bFollowDirLinks, ignoreList);
 }
 
+bool FileAccess::listSnapshot(DirectoryList* pDirList, bool bRecursive, bool bFindHidden, const FileFilter& filter) const
+{
+    pDirList->clear();
+    // Entries are stored after their folder, so one pass finds every parent already listed or left out.
+    std::vector<FileAccess*> listed(m_pSnapshot->count(), nullptr);
+    // The path of each folder, shared by all entries in it.
+    std::vector<QString> dirPaths(m_pSnapshot->count());
+    QString dirPath = absoluteFilePath();
+    if(!dirPath.endsWith(u'/'))
+        dirPath += u'/';
+    for(qint32 i = m_snapshotIndex + 1; i < m_pSnapshot->count(); ++i)
+    {
+        const qint32 parentIndex = m_pSnapshot->parent(i);
+        FileAccess* pParent = parentIndex == m_snapshotIndex ? const_cast<FileAccess*>(this) : (parentIndex > m_snapshotIndex ? listed[parentIndex] : nullptr);
+        if(pParent == nullptr || (!bRecursive && pParent != this))
+            continue;
+
+        const quint32 flags = m_pSnapshot->flags(i);
+        const QString name = m_pSnapshot->name(i);
+        if(!bFindHidden && (flags & ScanSnapshot::eHidden) != 0)
+            continue;
+        if((flags & ScanSnapshot::eDir) != 0 ? filter.isDirExcluded(name) : ((flags & ScanSnapshot::eFile) != 0 && !filter.isFileIncluded(name)))
+            continue;
+
+        QString& parentPath = parentIndex == m_snapshotIndex ? dirPath : dirPaths[parentIndex];
+        if(parentPath.isEmpty())
+            parentPath = pParent->absoluteFilePath() + u'/';
+
+        FileAccess& fa = pDirList->emplace_back();
+        fa.setFromSnapshot(pParent, parentPath, m_pSnapshot, i);
+        listed[i] = &fa;
+
+        if(ProgressProxy::wasCancelled())
+            break;
+    }
+    return true;
+}
+
+FileAccessJobHandler* FileAccess::jobHandler() const
+{
+#if HAS_KFKIO && !defined AUTOTEST
+    if(mJobHandler == nullptr) mJobHandler.reset(new DefaultFileAccessJobHandler(const_cast<FileAccess*>(this)));
+#endif
+    assert(mJobHandler != nullptr);
+    return mJobHandler.get();
+}
+
+QTemporaryFile& FileAccess::tempFile()
+{
+    if(tmpFile == nullptr)
+        tmpFile = std::make_shared<QTemporaryFile>();
+
+    return *tmpFile;
+}
+
+QFile& FileAccess::localFile()
+{
+    assert(isLocal());
+    if(realFile == nullptr)
+        realFile = std::make_shared<QFile>(absoluteFilePath());
+
+    return *realFile;
+}
+
+void FileAccess::moveToThread(QThread* pThread)
+{
+    if(mJobHandler)
+        mJobHandler->moveToThread(pThread);
+}
+
 QString FileAccess::getTempName() const
 {
     if(mPhysicalPath.isEmpty())
@@ -948,6 +1197,12 @@ bool FileAccess::open(const QFile::OpenMode flags)
 
     setStatusText("");
 
+    if(isSnapshot())
+    {
+        setStatusText(i18nc("@info:status %1 is the path", "%1 is part of a folder snapshot, only its content hash is known.", absoluteFilePath()));
+        return false;
+    }
+
     result = createLocalCopy();
     if(!result)
     {
@@ -955,16 +1210,16 @@ bool FileAccess::open(const QFile::OpenMode flags)
         return result;
     }
 
-    if(m_localCopy.isEmpty() && realFile != nullptr)
+    if(m_localCopy.isEmpty() && isLocal())
     {
-        bool r = realFile->open(flags);
+        bool r = localFile().open(flags);
 
         if(!r)
             setStatusText(i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", absoluteFilePath(), realFile->errorString()));
         return r;
     }
 
-    bool r = tmpFile->open();
+    bool r = tempFile().open();
     if(!r)
         setStatusText(i18nc("@info:status %1 is the path, %2 is the error message", "Opening %1 failed. %2", tmpFile->fileName(), tmpFile->errorString()));
     return r;
@@ -981,9 +1236,9 @@ qint64 FileAccess::read(char* data, const qint64 maxlen)
     }
 
     qint64 len = 0;
-    if(m_localCopy.isEmpty() && realFile != nullptr)
+    if(m_localCopy.isEmpty() && isLocal())
     {
-        len = realFile->read(data, maxlen);
+        len = localFile().read(data, maxlen);
         if(len != maxlen)
         {
             setStatusText(i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", absoluteFilePath(), realFile->errorString()));
@@ -991,7 +1246,7 @@ qint64 FileAccess::read(char* data, const qint64 maxlen)
     }
     else
     {
-        len = tmpFile->read(data, maxlen);
+        len = tempFile().read(data, maxlen);
         if(len != maxlen)
         {
             setStatusText(i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", absoluteFilePath(), tmpFile->errorString()));
@@ -1001,6 +1256,26 @@ qint64 FileAccess::read(char* data, const qint64 maxlen)
     return len;
 }
 
+bool FileAccess::seek(qint64 pos)
+{
+    QFileDevice& device = m_localCopy.isEmpty() && isLocal() ? static_cast<QFileDevice&>(localFile()) : static_cast<QFileDevice&>(tempFile());
+    if(!device.seek(pos))
+    {
+        setStatusText(i18nc("@info:status %1 is the path, %2 is the error message", "Error reading from %1. %2", absoluteFilePath(), device.errorString()));
+        return false;
+    }
+    return true;
+}
+
+void FileAccess::adviseSequentialRead()
+{
+#if !defined(Q_OS_WIN) && defined(POSIX_FADV_SEQUENTIAL)
+    QFileDevice* pFile = m_localCopy.isEmpty() ? static_cast<QFileDevice*>(realFile.get()) : static_cast<QFileDevice*>(tmpFile.get());
+    if(pFile != nullptr && pFile->isOpen())
+        posix_fadvise(pFile->handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
 void FileAccess::close()
 {
     if(m_localCopy.isEmpty() && realFile != nullptr)
@@ -1008,7 +1283,8 @@ void FileAccess::close()
         realFile->close();
     }
 
-    tmpFile->close();
+    if(tmpFile != nullptr)
+        tmpFile->close();
 }
 
 bool FileAccess::createLocalCopy()
@@ -1016,12 +1292,13 @@ bool FileAccess::createLocalCopy()
     if(isLocal() || !m_localCopy.isEmpty() || !mPhysicalPath.isEmpty())
         return true;
 
-    tmpFile->setAutoRemove(true);
-    tmpFile->open();
-    tmpFile->close();
-    m_localCopy = tmpFile->fileName();
+    QTemporaryFile& localCopy = tempFile();
+    localCopy.setAutoRemove(true);
+    localCopy.open();
+    localCopy.close();
+    m_localCopy = localCopy.fileName();
 
-    return copyFile(tmpFile->fileName());
+    return copyFile(localCopy.fileName());
 }
 
 //static tempfile Generator
@@ -1067,7 +1344,7 @@ qint64 FileAccess::sizeForReading()
         // Size couldn't be determined. Copy the file to a local temp place.
         if(createLocalCopy())
         {
-            const QString localCopy = tmpFile->fileName();
+            const QString localCopy = tempFile().fileName();
             const QFileInfo fi(localCopy);
 
             m_size = fi.size();
@@ -1146,16 +1423,9 @@ void FileAccess::doError()
     m_bExists = false;
 }
 
-void FileAccess::filterList(const QString& dir, DirectoryList* pDirList, const QString& filePattern,
-                            const QString& fileAntiPattern, const QString& dirAntiPattern,
-                            const IgnoreList& ignoreList)
+void FileAccess::filterList(const QString& dir, DirectoryList* pDirList, const FileFilter& filter, const IgnoreList& ignoreList)
 {
-    //TODO: Ask os for this information don't hard code it.
-#if defined(Q_OS_WIN)
-    bool bCaseSensitive = false;
-#else
-    bool bCaseSensitive = true;
-#endif
+    const bool bCaseSensitive = filter.isCaseSensitive();
 
     // Now remove all entries that should be ignored:
     DirectoryList::const_iterator i;
@@ -1165,10 +1435,8 @@ void FileAccess::filterList(const QString& dir, DirectoryList* pDirList, const Q
         ++i2;
         const QString& fileName = i->fileName();
 
-        if((i->isFile() &&
-            (!Utils::wildcardMultiMatch(filePattern, fileName, bCaseSensitive) ||
-             Utils::wildcardMultiMatch(fileAntiPattern, fileName, bCaseSensitive))) ||
-           (i->isDir() && Utils::wildcardMultiMatch(dirAntiPattern, fileName, bCaseSensitive)) ||
+        if((i->isFile() && !filter.isFileIncluded(fileName)) ||
+           (i->isDir() && filter.isDirExcluded(fileName)) ||
            (ignoreList.matches(dir, fileName, bCaseSensitive)))
         {
             // Remove it
@@ -13,8 +13,11 @@
 
 #include "DirectoryList.h"
 
+#include <memory>
+#include <optional>
 #include <type_traits>
 
+#include <QByteArray>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
@@ -28,7 +31,14 @@
 
 class FileAccessJobHandler;
 class DefaultFileAccessJobHandler;
+class FileFilter;
 class IgnoreList;
+class QThread;
+class ScanSnapshot;
+#ifdef Q_OS_LINUX
+class LocalDirectoryScanner;
+struct statx;
+#endif
 /*
   Defining a function as virtual in FileAccess is intended to allow testing sub classes to be written
   more easily. This way the test can use a moc class that emulates the needed conditions with no
@@ -47,6 +57,12 @@ class FileAccess
     explicit FileAccess(const QString& name, bool bWantToWrite = false); // name: local file or dirname or url (when supported)
 
     explicit FileAccess(const QUrl& name, bool bWantToWrite = false); // name: local file or dirname or url (when supported)
+    /*
+        A copy of a local file for another thread. Unlike a plain copy it shares no open file,
+        job handler or QFileInfo cache with this one. The parent is still shared, leave it alone.
+    */
+    [[nodiscard]] FileAccess threadCopy() const;
+
     void setFile(const QString& name, bool bWantToWrite = false);
     void setFile(const QUrl& url, bool bWantToWrite = false);
     void setFile(FileAccess* pParent, const QFileInfo& fi);
@@ -68,13 +84,34 @@ class FileAccess
     [[nodiscard]] virtual bool isHidden() const;
     [[nodiscard]] const QString& readLink() const;
 
+    // A folder snapshot or an entry of one, see ScanSnapshot. Only type, size, date and hash are known.
+    [[nodiscard]] bool isSnapshot() const { return m_pSnapshot != nullptr; }
+    [[nodiscard]] std::optional<QByteArray> snapshotHash() const;
+    // False for entries of a checksum manifest, which has neither sizes nor dates.
+    [[nodiscard]] bool hasMetaData() const;
+    /*
+        Lists this snapshot or checksum manifest file like the folder it was taken of. Only for A, B
+        or C of a folder comparison, anywhere else these are files like any other.
+    */
+    bool openSnapshot();
+
     [[nodiscard]] const QDateTime& lastModified() const;
 
+    // Device, inode and times in nanoseconds as the folder scan saw them. Only LocalDirectoryScanner sets these.
+    struct ScanIdentity
+    {
+        quint64 m_device = 0;
+        quint64 m_inode = 0;
+        qint64 m_mtimeNs = 0;
+        qint64 m_ctimeNs = 0;
+    };
+    [[nodiscard]] const std::optional<ScanIdentity>& scanIdentity() const { return m_scanIdentity; }
+
     [[nodiscard]] const QString& displayName() const { return mDisplayName.isEmpty() ? fileName() : mDisplayName; }
     [[nodiscard]] const QString& fileName(bool needTmp = false) const; // Just the name-part of the path, without parent directories
     [[nodiscard]] QString fileRelPath() const;                  // The path relative to base comparison directory
     [[nodiscard]] QString prettyAbsPath() const;
-    [[nodiscard]] const QUrl& url() const;
+    [[nodiscard]] QUrl url() const;
     void setUrl(const QUrl& inUrl) { m_url = inUrl; }
 
     //Workaround for QUrl::toDisplayString/QUrl::toString behavior that does not fit KDiff3's expectations
@@ -125,15 +162,19 @@ class FileAccess
     [[nodiscard]] FileAccess* parent() const; // !=0 for listDir-results, but only valid if the parent was not yet destroyed.
 
     void doError();
-    void filterList(const QString& dir, DirectoryList* pDirList, const QString& filePattern,
-                    const QString& fileAntiPattern, const QString& dirAntiPattern,
-                    const IgnoreList& ignoreList);
+    void filterList(const QString& dir, DirectoryList* pDirList, const FileFilter& filter, const IgnoreList& ignoreList);
 
     [[nodiscard]] QDir getBaseDirectory() const { return m_baseDir; }
+    // Entries listed on a helper thread must be handed back before that thread exits.
+    void moveToThread(QThread* pThread);
 
     bool open(const QFile::OpenMode flags);
 
     qint64 read(char* data, const qint64 maxlen);
+    // Moves the read position of an open file.
+    bool seek(qint64 pos);
+    // Hint for the OS to read ahead aggressively, a no-op where not supported.
+    void adviseSequentialRead();
     void close();
 
     [[nodiscard]] const QString& errorString() const;
@@ -144,26 +185,43 @@ class FileAccess
     friend DefaultFileAccessJobHandler;
     void setFromUdsEntry(const KIO::UDSEntry& e, FileAccess* parent);
 #endif
+#ifdef Q_OS_LINUX
+    friend LocalDirectoryScanner;
+    // dirPath ends with a separator. pTargetStat is only set for symlinks that could be resolved.
+    void setFromStat(FileAccess* pParent, const QString& dirPath, const QString& name,
+                     const struct statx& st, const struct statx* pTargetStat, const QString& linkTarget);
+#endif
+    void setFromSnapshot(FileAccess* pParent, const QString& dirPath, const std::shared_ptr<const ScanSnapshot>& pSnapshot, qint32 index);
     void setStatusText(const QString& s);
 
     void reset();
 
     bool interruptableReadFile(void* pDestBuffer, qint64 maxLength);
 
-    std::unique_ptr<FileAccessJobHandler> mJobHandler;
+    /*
+        The job handler, the temp file and the QFile are only needed once an entry is actually
+        read, written, copied or listed. A folder scan creates millions of entries that never
+        get that far, so these are created on first use via jobHandler(), tempFile() and localFile().
+    */
+    mutable std::unique_ptr<FileAccessJobHandler> mJobHandler;
     FileAccess* m_pParent = nullptr;
     QUrl m_url;
     bool m_bValidData = false;
 
     QDir m_baseDir;
     QFileInfo m_fileInfo;
+    /*
+        Entries of a scanned folder only keep their name and the path of the folder, which all of them
+        share. Their url and QFileInfo are made when asked for, m_url and m_fileInfo stay empty.
+    */
+    QString m_dirPath;
     QString m_linkTarget;
     QString m_name;
 
     QString mDisplayName;
     QString m_localCopy;
     QString mPhysicalPath;
-    std::shared_ptr<QTemporaryFile> tmpFile = std::make_shared<QTemporaryFile>();
+    std::shared_ptr<QTemporaryFile> tmpFile = nullptr;
     std::shared_ptr<QFile> realFile = nullptr;
 
     qint64 m_size = 0;
@@ -177,10 +235,23 @@ class FileAccess
     bool m_bReadable = false;
     bool m_bExecutable = false;
     bool m_bHidden = false;
+    // Type, size and date came from a directory scan. Local queries use them instead of stat'ing again.
+    bool m_bStatCached = false;
+    std::optional<ScanIdentity> m_scanIdentity;
 
     QString m_statusText; // Might contain an error string, when the last operation didn't succeed.
 
+    std::shared_ptr<const ScanSnapshot> m_pSnapshot;
+    qint32 m_snapshotIndex = -1; // -1 for the snapshot itself
+
   private:
+    bool listSnapshot(DirectoryList* pDirList, bool bRecursive, bool bFindHidden, const FileFilter& filter) const;
+
+    [[nodiscard]] QFileInfo fileInfo() const;
+    [[nodiscard]] FileAccessJobHandler* jobHandler() const;
+    [[nodiscard]] QTemporaryFile& tempFile();
+    [[nodiscard]] QFile& localFile();
+
     /*
     These two variables are used to prevent infinate/long running loops when a symlinks true target
     must be found. isNormal is right now the only place this is needed.
@@ -35,16 +35,17 @@
 #include <stdlib.h>
 
 
-static GNULineRef *xvec, *yvec;  /* Vectors being compared. */
-static GNULineRef *fdiag;        /* Vector, indexed by diagonal, containing
+/* Per thread so several diffs can run at once.  */
+static thread_local GNULineRef *xvec, *yvec;  /* Vectors being compared. */
+static thread_local GNULineRef *fdiag;        /* Vector, indexed by diagonal, containing
                    1 + the X coordinate of the point furthest
                    along the given diagonal in the forward
                    search of the edit matrix. */
-static GNULineRef *bdiag;        /* Vector, indexed by diagonal, containing
+static thread_local GNULineRef *bdiag;        /* Vector, indexed by diagonal, containing
                    the X coordinate of the point furthest
                    along the given diagonal in the backward
                    search of the edit matrix. */
-static GNULineRef too_expensive; /* Edit scripts longer than this are too
+static thread_local GNULineRef too_expensive; /* Edit scripts longer than this are too
                    expensive to compute.  */
 
 #define SNAKE_LIMIT 20 /* Snakes bigger than this are considered `big'.  */
@@ -41,23 +41,25 @@ struct equivclass {
     size_t length;     /* That line's length, not counting its newline.  */
 };
 
+/* The state below is per thread so several diffs can run at once.  */
+
 /* Hash-table: array of buckets, each being a chain of equivalence classes.
    buckets[-1] is reserved for incomplete lines.  */
-static GNULineRef *buckets;
+static thread_local GNULineRef *buckets;
 
 /* Number of buckets in the hash table array, not counting buckets[-1].  */
-static size_t nbuckets;
+static thread_local size_t nbuckets;
 
 /* Array in which the equivalence classes are allocated.
    The bucket-chains go through the elements in this array.
    The number of an equivalence class is its index in this array.  */
-static equivclass *equivs;
+static thread_local equivclass *equivs;
 
 /* Index of first free element in the array `equivs'.  */
-static GNULineRef equivs_index;
+static thread_local GNULineRef equivs_index;
 
 /* Number of elements allocated in the array `equivs'.  */
-static GNULineRef equivs_alloc;
+static thread_local GNULineRef equivs_alloc;
 
 /* Check for binary files and compare them for exact identity.  */
 
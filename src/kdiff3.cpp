@@ -114,7 +114,6 @@ KDiff3App::KDiff3App(QWidget* pParent, const QString& name, KDiff3Shell* pKDiff3
     if(!names.fn1.isEmpty())
     {
         m_sd1->setFilename(names.fn1);
-        m_bDirCompare = m_sd1->isDir();
     }
     if(!names.fn2.isEmpty())
     {
@@ -124,6 +123,8 @@ KDiff3App::KDiff3App(QWidget* pParent, const QString& name, KDiff3Shell* pKDiff3
     {
         m_sd3->setFilename(names.fn3);
     }
+    if(!names.fn1.isEmpty())
+        m_bDirCompare = isDirComparison();
 
     m_pCentralWidget = new QWidget(this);
     QVBoxLayout* pCentralLayout = new QVBoxLayout(m_pCentralWidget);
@@ -259,7 +260,7 @@ KDiff3App::KDiff3App(QWidget* pParent, const QString& name, KDiff3Shell* pKDiff3
             if(args.count() > 1) m_sd3->setFilename(args[1]);
         }
         //Set m_bDirCompare flag
-        m_bDirCompare = m_sd1->isDir();
+        m_bDirCompare = isDirComparison();
 
         QStringList aliasList = KDiff3Shell::getParser()->values("fname");
         QStringList::Iterator ali = aliasList.begin();
@@ -606,9 +607,7 @@ void KDiff3App::completeInit()
     bool openError = false;
     bool bSuccess = true;
 
-    //Should not fail ever.
-    assert(m_bDirCompare == m_sd1->isDir());
-    if(m_bDirCompare != m_sd2->isDir() || (!m_sd3->isEmpty() && m_bDirCompare != m_sd3->isDir()))
+    if(m_bDirCompare != isDirSide(*m_sd1) || m_bDirCompare != isDirSide(*m_sd2) || (!m_sd3->isEmpty() && m_bDirCompare != isDirSide(*m_sd3)))
     {
         KMessageBox::error(this, i18nc("Error message", "Can't compare file with folder."),
                            i18nc("Title error message box", "Bad comparison attempt"));
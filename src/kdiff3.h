@@ -13,6 +13,7 @@
 
 #include "defmac.h"
 #include "diff.h"
+#include "FullAnalysis.h"
 #include "SourceData.h"
 #include "StandardMenus.h"
 #include "TypeUtils.h"
@@ -314,7 +315,9 @@ public Q_SLOTS:
     void initView();
 
   private:
-    void mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFlags = InitFlag::defaultFlags);
+    // pPrefetched: the files already loaded and diffed, see MergePrefetch.
+    void mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFlags = InitFlag::defaultFlags,
+                  std::unique_ptr<FullAnalysis::Comparison> pPrefetched = nullptr);
     void resetDiffData();
     void mainWindowEnable(bool bEnable);
     void wheelEvent(QWheelEvent* pWheelEvent) override;
@@ -323,6 +326,9 @@ public Q_SLOTS:
 
     void doFileCompare();
     bool doDirectoryCompare(const bool bCreateNewInstance);
+    // See ScanSnapshot for the files that may stand in for a folder.
+    [[nodiscard]] bool isDirComparison() const;
+    [[nodiscard]] bool isDirSide(const SourceData& sd) const;
     void improveFilenames();
 
     void choose(e_SrcSelector choice);
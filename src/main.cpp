@@ -8,6 +8,7 @@
 */
 // clang-format on
 
+#include "ContentHashCache.h"
 #include "kdiff3_shell.h"
 #include "TypeUtils.h"
 #include "version.h"
@@ -74,6 +75,35 @@ void initialiseCmdLineArgs(QCommandLineParser* cmdLineParser)
     }
 }
 
+qint32 hashCacheCommand(const QCommandLineParser* cmdLineParser)
+{
+    QTextStream out(stdout);
+    ContentHashCache cache;
+    cache.load();
+
+    if(cmdLineParser->isSet(QStringLiteral("hash-cache-prune")))
+    {
+        bool bOk = false;
+        const qint64 maxEntries = cmdLineParser->value(QStringLiteral("hash-cache-prune")).toLongLong(&bOk);
+        if(!bOk || maxEntries < 0)
+        {
+            QTextStream(stderr) << i18n("Invalid entry count: %1", cmdLineParser->value(QStringLiteral("hash-cache-prune"))) << Qt::endl;
+            return 1;
+        }
+
+        const qint64 before = cache.count();
+        if(!cache.save(maxEntries))
+        {
+            QTextStream(stderr) << i18n("Could not write %1", cache.fileName()) << Qt::endl;
+            return 1;
+        }
+        out << i18n("Removed %1 entries.", before - cache.count()) << Qt::endl;
+    }
+
+    out << cache.describe();
+    return 0;
+}
+
 qint32 main(qint32 argc, char* argv[])
 {
     constexpr QLatin1String appName("kdiff3");
@@ -130,6 +160,8 @@ qint32 main(qint32 argc, char* argv[])
     cmdLineParser->addOption(QCommandLineOption(u8"cs", i18n("Override a config setting. Use once for every setting. E.g.: --cs \"AutoAdvance=1\""), u8"string"));
     cmdLineParser->addOption(QCommandLineOption(u8"confighelp", i18n("Show list of config settings and current values.")));
     cmdLineParser->addOption(QCommandLineOption(u8"config", i18n("Use a different config file."), u8"file"));
+    cmdLineParser->addOption(QCommandLineOption(u8"hash-cache-info", i18n("Show information about the folder comparison hash cache and exit.")));
+    cmdLineParser->addOption(QCommandLineOption(u8"hash-cache-prune", i18n("Keep only the given number of most recently used entries in the folder comparison hash cache and exit. Use 0 to clear it."), u8"count"));
 
     // other command options
     cmdLineParser->addPositionalArgument(u8"[File1]", i18n("file1 to open (base, if not specified via --base)"));
@@ -178,6 +210,9 @@ qint32 main(qint32 argc, char* argv[])
 
     aboutData.processCommandLine(cmdLineParser);
 
+    if(cmdLineParser->isSet(QStringLiteral("hash-cache-info")) || cmdLineParser->isSet(QStringLiteral("hash-cache-prune")))
+        return hashCacheCommand(cmdLineParser);
+
     /*
         This short segment is wrapped in a lambda to delay KDiff3Shell construction until
         after the main event loop starts. Thus allowing us to avoid std::exit as much as
@@ -1234,6 +1234,70 @@ void OptionDialog::setupDirectoryMergePage()
                                 "Useful for big folders or slow networks when the date is modified during download."));
     pBGLayout->addWidget(pTrustSize);
 
+    OptionRadioButton* pSampledComparison = new OptionRadioButton(i18n("Compare samples of large files (unsafe)"), false, "SampledComparison", &gOptions->m_bDmSampledComparison, pBG);
+
+    pSampledComparison->setToolTip(i18nc("Tool Tip", "Compare the start, the end and a number of blocks in between of files with equal sizes.\n"
+                                        "Files with equal samples are shown as probably equal, small files are compared completely.\n"
+                                        "Useful for big media archives."));
+    pBGLayout->addWidget(pSampledComparison);
+
+    ++line;
+
+    OptionIntEdit* pSampleSize = new OptionIntEdit(64, "SampleSizeKB", &gOptions->m_dmSampleSizeKB, 4, 64 * 1024, page);
+    label = new QLabel(i18n("Sample size (KB):"), page);
+    label->setBuddy(pSampleSize);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pSampleSize, line, 1);
+    chk_connect_a(pSampledComparison, &OptionRadioButton::toggled, pSampleSize, &OptionIntEdit::setEnabled);
+    pSampleSize->setEnabled(false);
+    ++line;
+
+    OptionIntEdit* pSampleCount = new OptionIntEdit(16, "SampleCount", &gOptions->m_dmSampleCount, 0, 10000, page);
+    label = new QLabel(i18n("Samples between start and end:"), page);
+    label->setBuddy(pSampleCount);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pSampleCount, line, 1);
+    pSampleCount->setToolTip(i18nc("Tool Tip", "The places of the samples only depend on the file size, each comparison reads the same ones."));
+    chk_connect_a(pSampledComparison, &OptionRadioButton::toggled, pSampleCount, &OptionIntEdit::setEnabled);
+    pSampleCount->setEnabled(false);
+    ++line;
+
+    OptionCheckBox* pUseHashCache = new OptionCheckBox(i18n("Remember content hashes between comparisons"), false, "UseHashCache", &gOptions->m_bDmUseHashCache, page);
+    gbox->addWidget(pUseHashCache, line, 0, 1, 2);
+    pUseHashCache->setToolTip(i18nc("Tool Tip",
+        "Store a hash of each local file that was read completely during a binary comparison.\n"
+        "Files whose size, dates and inode are unchanged are later compared by their hashes\n"
+        "instead of being read again."));
+    chk_connect_a(pBinaryComparison, &OptionRadioButton::toggled, pUseHashCache, &OptionCheckBox::setEnabled);
+    ++line;
+
+    OptionIntEdit* pHashCacheMaxEntries = new OptionIntEdit(500000, "HashCacheMaxEntries", &gOptions->m_dmHashCacheMaxEntries, 1000, 10000000, page);
+    label = new QLabel(i18n("Max number of remembered hashes:"), page);
+    label->setBuddy(pHashCacheMaxEntries);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pHashCacheMaxEntries, line, 1);
+    pHashCacheMaxEntries->setToolTip(i18nc("Tool Tip",
+        "The least recently used hashes are dropped beyond this number.\n"
+        "Each entry takes about 80 bytes on disk."));
+    chk_connect_a(pUseHashCache, &OptionCheckBox::toggled, pHashCacheMaxEntries, &OptionIntEdit::setEnabled);
+    pHashCacheMaxEntries->setEnabled(false);
+    ++line;
+
+    OptionCheckBox* pLazyCompare = new OptionCheckBox(i18n("Compare file contents in the background"), false, "LazyCompare", &gOptions->m_bDmLazyCompare, page);
+    gbox->addWidget(pLazyCompare, line, 0, 1, 2);
+    pLazyCompare->setToolTip(i18nc("Tool Tip",
+        "Show the folders as soon as they are scanned and compare the files afterwards.\n"
+        "Files on screen are compared first, their status is \"Pending\" until then.\n"
+        "Merge operations wait for the files they need. Remote files are compared up front."));
+    ++line;
+
+    OptionCheckBox* pDiskOrder = new OptionCheckBox(i18n("Compare files in the order they are stored on disk"), false, "DiskOrderCompare", &gOptions->m_bDmDiskOrder, page);
+    gbox->addWidget(pDiskOrder, line, 0, 1, 2);
+    pDiskOrder->setToolTip(i18nc("Tool Tip",
+        "For rotating disks: local files are compared in the order of their data on the disk\n"
+        "instead of the order of the folders, so the disk heads don't jump back and forth.\n"
+        "Where the file system can't tell the location, files are ordered by inode number.\n"
+        "Of no use on SSDs."));
     ++line;
 
     // Some two Dir-options: Affects only the default actions.
@@ -1266,6 +1330,55 @@ void OptionDialog::setupDirectoryMergePage()
         "Only effective when comparing two folders."));
     ++line;
 
+    OptionCheckBox* pDetectRenames = new OptionCheckBox(i18n("Detect renamed and moved files"), false, "DetectRenames", &gOptions->m_bDmDetectRenames, page);
+    gbox->addWidget(pDetectRenames, line, 0, 1, 2);
+    pDetectRenames->setToolTip(i18nc("Tool Tip",
+        "A file that would be deleted on one side and an equal file that would be copied\n"
+        "to that side under another name are paired: the file is renamed instead.\n"
+        "Candidates must have the same size and content hash.\n"
+        "Only effective when comparing two local folders."));
+    ++line;
+
+    OptionCheckBox* pDeltaCopy = new OptionCheckBox(i18n("Write only the changed blocks of large files"), false, "DeltaCopy", &gOptions->m_bDmDeltaCopy, page);
+    gbox->addWidget(pDeltaCopy, line, 0, 1, 2);
+    pDeltaCopy->setToolTip(i18nc("Tool Tip",
+        "When a large local file replaces an older version of itself, the old version is\n"
+        "reflinked and only the blocks that differ are written, then the result is verified.\n"
+        "Needs a file system with reflinks such as btrfs or XFS, elsewhere files are copied in full."));
+    ++line;
+
+    OptionIntEdit* pDeltaCopyMinSize = new OptionIntEdit(256, "DeltaCopyMinSizeMB", &gOptions->m_dmDeltaCopyMinSizeMB, 1, 1024 * 1024, page);
+    label = new QLabel(i18n("Minimum file size for block copies (MB):"), page);
+    label->setBuddy(pDeltaCopyMinSize);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pDeltaCopyMinSize, line, 1);
+    pDeltaCopyMinSize->setToolTip(i18nc("Tool Tip",
+        "Smaller files are copied in full, comparing the blocks doesn't pay off for them."));
+    chk_connect_a(pDeltaCopy, &OptionCheckBox::toggled, pDeltaCopyMinSize, &OptionIntEdit::setEnabled);
+    pDeltaCopyMinSize->setEnabled(false);
+    ++line;
+
+    OptionIntEdit* pPrefetchCount = new OptionIntEdit(2, "PrefetchCount", &gOptions->m_dmPrefetchCount, 0, 100, page);
+    label = new QLabel(i18n("Manual merges to prepare ahead:"), page);
+    label->setBuddy(pPrefetchCount);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pPrefetchCount, line, 1);
+    pPrefetchCount->setToolTip(i18nc("Tool Tip",
+        "While you merge a file, the files of the next manual merges are loaded and compared\n"
+        "in the background, so they are shown at once when you continue. 0 turns this off.\n"
+        "Only local files, and not with a preprocessor or automatic merges at merge start."));
+    ++line;
+
+    OptionIntEdit* pPrefetchMemory = new OptionIntEdit(512, "PrefetchMemoryMB", &gOptions->m_dmPrefetchMemoryMB, 1, 1024 * 1024, page);
+    label = new QLabel(i18n("Memory for merges prepared ahead (MB):"), page);
+    label->setBuddy(pPrefetchMemory);
+    gbox->addWidget(label, line, 0);
+    gbox->addWidget(pPrefetchMemory, line, 1);
+    pPrefetchMemory->setToolTip(i18nc("Tool Tip",
+        "Files take several times their size once loaded and compared.\n"
+        "Merges that would exceed this are not prepared ahead."));
+    ++line;
+
     OptionCheckBox* pCreateBakFiles = new OptionCheckBox(i18n("Backup files (.orig)"), true, "CreateBakFiles", &gOptions->m_bDmCreateBakFiles, page);
     gbox->addWidget(pCreateBakFiles, line, 0, 1, 2);
 
@@ -230,6 +230,9 @@ class Options
     bool m_bDmTrustDate = false;
     bool m_bDmTrustDateFallbackToBinary = false;
     bool m_bDmTrustSize = false;
+    bool m_bDmSampledComparison = false;
+    qint32 m_dmSampleSizeKB = 64;
+    qint32 m_dmSampleCount = 16;
     bool m_bDmCopyNewer = false;
     //bool m_bDmShowOnlyDeltas;
     bool m_bDmShowIdenticalFiles = true;
@@ -238,6 +241,15 @@ class Options
     bool m_bDmCaseSensitiveFilenameComparison;
     bool m_bDmUnfoldSubdirs = false;
     bool m_bDmSkipDirStatus = false;
+    bool m_bDmUseHashCache = false;
+    qint32 m_dmHashCacheMaxEntries = 500000;
+    bool m_bDmLazyCompare = false;
+    bool m_bDmDiskOrder = false;
+    bool m_bDmDetectRenames = false;
+    bool m_bDmDeltaCopy = false;
+    qint32 m_dmDeltaCopyMinSizeMB = 256;
+    qint32 m_dmPrefetchCount = 2;
+    qint32 m_dmPrefetchMemoryMB = 512;
     QString m_DmFilePattern = "*";
     QString m_DmFileAntiPattern = "*.orig;*.o;*.obj;*.rej;*.bak";
     QString m_DmDirAntiPattern = "CVS;.deps;.svn;.hg;.git";
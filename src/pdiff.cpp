@@ -19,6 +19,7 @@
 #include "Logging.h"
 #include "optiondialog.h"
 #include "progress.h"
+#include "ScanSnapshot.h"
 #include "Utils.h"
 
 #include "mergeresultwindow.h"
@@ -27,7 +28,10 @@
 #include <algorithm>
 #include <cstdio>
 #include <list>
+#include <memory>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 #include <QCheckBox>
 #include <QClipboard>
@@ -71,7 +75,7 @@ void KDiff3App::resetDiffData()
     m_manualDiffHelpList.clear();
 }
 
-void KDiff3App::mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFlags)
+void KDiff3App::mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFlags, std::unique_ptr<FullAnalysis::Comparison> pPrefetched)
 {
     ProgressScope pp;
     bool bLoadFiles = inFlags & InitFlag::loadFiles;
@@ -96,6 +100,8 @@ void KDiff3App::mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFl
     //Easier to do here then have all eleven of our call points do the check.
     if(bFirstRun)
         bLoadFiles = false;
+    // Loaded and diffed by the folder merge in the background, with the same options.
+    const bool bPrefetched = bLoadFiles && !bUseCurrentEncoding && pPrefetched != nullptr;
 
     if(bGUI)
     {
@@ -121,7 +127,19 @@ void KDiff3App::mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFl
         setLockPainting(true);
     }
 
-    if(bLoadFiles)
+    if(bPrefetched)
+    {
+        resetDiffData();
+        m_sd1->takeDataFrom(*pPrefetched->m_sdA);
+        m_sd2->takeDataFrom(*pPrefetched->m_sdB);
+        m_sd3->takeDataFrom(*pPrefetched->m_sdC);
+        m_diffList12 = std::move(pPrefetched->m_diffList12);
+        m_diffList13 = std::move(pPrefetched->m_diffList13);
+        m_diffList23 = std::move(pPrefetched->m_diffList23);
+        m_diff3LineList = std::move(pPrefetched->m_diff3LineList);
+        qCInfo(kdiffMain) << "Using prefetched data for" << m_sd2->getFilename();
+    }
+    else if(bLoadFiles)
     {
         resetDiffData();
         if(m_sd3->isEmpty())
@@ -165,7 +183,11 @@ void KDiff3App::mainInit(TotalDiffStatus* pTotalDiffStatus, const InitFlags inFl
 
     pTotalDiffStatus->reset();
 
-    if(mErrors.isEmpty() && !bFirstRun)
+    if(bPrefetched)
+    {
+        *pTotalDiffStatus = pPrefetched->m_totalDiffStatus;
+    }
+    else if(mErrors.isEmpty() && !bFirstRun)
     {
         try
         {
@@ -768,7 +790,7 @@ void KDiff3App::slotFileOpen()
             else
                 m_outputFilename = "";
 
-            m_bDirCompare = m_sd1->isDir();
+            m_bDirCompare = isDirComparison();
 
             if(m_bDirCompare)
             {
@@ -851,7 +873,8 @@ void KDiff3App::slotFileOpen2(QStringList& errors, const QString& fn1, const QSt
         improveFilenames();
         //KDiff3App::slotFileOpen2 needs to handle both GUI and non-GUI diffs.
         if(pTotalDiffStatus == nullptr)
-            mainInit(m_totalDiffStatus);
+            mainInit(m_totalDiffStatus, InitFlag::defaultFlags,
+                     m_pDirectoryMergeWindow != nullptr ? m_pDirectoryMergeWindow->takePrefetched(fn1, fn2, fn3) : nullptr);
         else
             mainInit(pTotalDiffStatus, InitFlag::loadFiles | InitFlag::autoSolve);
 
@@ -1121,6 +1144,9 @@ void KDiff3App::slotJoinDiffs()
 
 void KDiff3App::slotConfigure()
 {
+    // Prefetch jobs read the options, stop them before the dialog changes any.
+    if(m_pDirectoryMergeWindow != nullptr)
+        m_pDirectoryMergeWindow->discardPrefetched();
     m_pOptionDialog->setState();
     m_pOptionDialog->setMinimumHeight(m_pOptionDialog->minimumHeight() + 40);
     m_pOptionDialog->exec();
@@ -1408,6 +1434,37 @@ void KDiff3App::slotShowLineNumbersToggled()
     Q_EMIT showLineNumbersToggled();
 }
 
+/*
+    A snapshot of a folder or a checksum manifest stands in for a folder if another side is one.
+    Snapshots alone are compared as folders too, they aren't text. Manifests alone are just text.
+*/
+bool KDiff3App::isDirComparison() const
+{
+    std::vector<const SourceData*> sides{m_sd1.get(), m_sd2.get()};
+    if(!m_sd3->isEmpty())
+        sides.push_back(m_sd3.get());
+
+    bool bSnapshots = false;
+    bool bDirs = false;
+    bool bOnlySnapshots = true;
+    for(const SourceData* pSide: sides)
+    {
+        const bool bSnapshot = !pSide->isDir() && ScanSnapshot::isSnapshotFile(pSide->getFilename());
+        bSnapshots = bSnapshots || bSnapshot;
+        bDirs = bDirs || pSide->isDir();
+        bOnlySnapshots = bOnlySnapshots && bSnapshot && pSide->getFilename().endsWith(ScanSnapshot::fileExtension());
+    }
+
+    if(!bSnapshots)
+        return m_sd1->isDir();
+    return bDirs || bOnlySnapshots;
+}
+
+bool KDiff3App::isDirSide(const SourceData& sd) const
+{
+    return sd.isDir() || (m_bDirCompare && ScanSnapshot::isSnapshotFile(sd.getFilename()));
+}
+
 /// Return true for success, else false
 bool KDiff3App::doDirectoryCompare(const bool bCreateNewInstance)
 {
@@ -1416,6 +1473,16 @@ bool KDiff3App::doDirectoryCompare(const bool bCreateNewInstance)
     FileAccess f3(m_sd3->getFilename());
     FileAccess f4(m_outputFilename);
 
+    // Only here are snapshots and manifests listed as folders, see isDirComparison.
+    for(FileAccess* pFile: {&f1, &f2, &f3})
+    {
+        if(pFile->isValid() && !pFile->isDir() && !pFile->openSnapshot())
+        {
+            KMessageBox::error(this, pFile->getStatusText(), i18n("File open error"));
+            return false;
+        }
+    }
+
     assert(f1.isDir());
 
     if(bCreateNewInstance)
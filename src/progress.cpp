@@ -127,6 +127,9 @@ void ProgressDialog::setStayHidden(bool bStayHidden)
 
 void ProgressDialog::push()
 {
+    if(ProgressMute::isActive())
+        return;
+
     ProgressLevelData pld;
     if(!m_progressStack.empty())
     {
@@ -149,6 +152,9 @@ void ProgressDialog::push()
 
 void ProgressDialog::beginBackgroundTask()
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(backgroundTaskCount > 0)
     {
         m_t1.restart();
@@ -161,6 +167,9 @@ void ProgressDialog::beginBackgroundTask()
 
 void ProgressDialog::endBackgroundTask()
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(backgroundTaskCount > 0)
     {
         backgroundTaskCount--;
@@ -174,6 +183,9 @@ void ProgressDialog::endBackgroundTask()
 
 void ProgressDialog::pop(bool bRedrawUpdate)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(!m_progressStack.empty())
     {
         m_progressStack.pop_back();
@@ -189,6 +201,9 @@ void ProgressDialog::pop(bool bRedrawUpdate)
 
 void ProgressDialog::setInformation(const QString& info, qint32 current, bool bRedrawUpdate)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -199,6 +214,9 @@ void ProgressDialog::setInformation(const QString& info, qint32 current, bool bR
 
 void ProgressDialog::setInformation(const QString& info, bool bRedrawUpdate)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -208,6 +226,9 @@ void ProgressDialog::setInformation(const QString& info, bool bRedrawUpdate)
 
 void ProgressDialog::setMaxNofSteps(const quint64 maxNofSteps)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty() || maxNofSteps == 0)
         return;
 
@@ -236,6 +257,9 @@ void ProgressDialog::setInformationImp(const QString& info)
 
 void ProgressDialog::addNofSteps(const quint64 nofSteps)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -245,6 +269,9 @@ void ProgressDialog::addNofSteps(const quint64 nofSteps)
 
 void ProgressDialog::step(bool bRedrawUpdate)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -255,6 +282,9 @@ void ProgressDialog::step(bool bRedrawUpdate)
 
 void ProgressDialog::setCurrent(quint64 subCurrent, bool bRedrawUpdate)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -266,6 +296,9 @@ void ProgressDialog::setCurrent(quint64 subCurrent, bool bRedrawUpdate)
 
 void ProgressDialog::clear()
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -279,6 +312,9 @@ void ProgressDialog::clear()
 // Requirement: 0 < dMin < dMax < 1
 void ProgressDialog::setRangeTransformation(double dMin, double dMax)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
@@ -290,6 +326,9 @@ void ProgressDialog::setRangeTransformation(double dMin, double dMax)
 
 void ProgressDialog::setSubRangeTransformation(double dMin, double dMax)
 {
+    if(ProgressMute::isActive())
+        return;
+
     if(m_progressStack.empty())
         return;
 
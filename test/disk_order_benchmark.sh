@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Compares the throughput of a folder comparison in tree order and in disk order (DiskOrderTest)
+# on a fresh ext4 file system in a loopback image. The files of A and B are written in random
+# order, so the order of the tree and the order on the disk differ like they do on an archive
+# that has been in use for a while.
+#
+# Usage: disk_order_benchmark.sh <path to DiskOrderTest> <image file> [files] [KiB per file]
+# Needs root for losetup, mount and dropping the page cache. Put the image on a rotating disk,
+# on an SSD both orders come out about the same.
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <DiskOrderTest> <image file> [files] [KiB per file]"
+    exit 1
+fi
+
+test_binary=$1
+image=$2
+files=${3:-2000}
+size_kib=${4:-512}
+
+# Both trees plus a fifth for the file system.
+truncate -s $((files * size_kib * 2 * 5 / 4 / 1024 + 64))M "$image"
+loop=$(losetup --find --show "$image")
+mountpoint=$(mktemp -d)
+trap 'umount "$mountpoint"; losetup -d "$loop"; rmdir "$mountpoint"' EXIT
+mkfs.ext4 -q "$loop"
+mount "$loop" "$mountpoint"
+
+python3 - "$mountpoint" "$files" "$size_kib" <<'PYTHON'
+import os
+import random
+import sys
+
+root, files, size = sys.argv[1], int(sys.argv[2]), int(sys.argv[3]) * 1024
+names = [f'dir{i // 100:03}/file{i:05}.bin' for i in range(files)]
+writes = [(side, name) for side in ('A', 'B') for name in names]
+random.Random(1).shuffle(writes)
+for side, name in writes:
+    path = os.path.join(root, side, name)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'wb') as f:
+        # Same contents on both sides, every file is read to the end.
+        f.write(random.Random(name).randbytes(size))
+        # Allocate now, in the order written.
+        f.flush()
+        os.fsync(f.fileno())
+PYTHON
+
+export KDIFF3_DISK_ORDER_BENCHMARK_DIR=$mountpoint
+export QT_QPA_PLATFORM=offscreen
+
+for benchmark in benchmarkTreeOrder benchmarkDiskOrder; do
+    echo "== $benchmark"
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+    "$test_binary" "$benchmark" | grep -E "Files|MiB/s"
+done
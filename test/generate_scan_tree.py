@@ -0,0 +1,40 @@
+#!/usr/bin/env python
+
+# SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import argparse
+import os
+import sys
+
+parser = argparse.ArgumentParser(formatter_class=argparse.RawDescriptionHelpFormatter,
+                                 description='Generate a synthetic folder tree for the folder scan benchmark.\n\n' +
+                                             'Files are spread evenly over a tree of folders. They are created empty\n' +
+                                             'by default since the scan only looks at metadata.')
+parser.add_argument('target', help='Folder to create the tree in. Must not exist yet.')
+parser.add_argument('-n', '--files', type=int, default=1000000, help='Number of files (default: 1000000)')
+parser.add_argument('-f', '--fanout', type=int, default=32, help='Sub-folders per folder (default: 32)')
+parser.add_argument('-p', '--per-folder', type=int, default=256, help='Files per folder (default: 256)')
+parser.add_argument('-s', '--size', type=int, default=0, help='Bytes written to each file (default: 0)')
+args = parser.parse_args()
+
+if os.path.exists(args.target):
+    sys.exit(f'{args.target} already exists.')
+
+content = b'x' * args.size
+created = 0
+folders = [args.target]
+while created < args.files:
+    nextFolders = []
+    for folder in folders:
+        os.makedirs(folder, exist_ok=True)
+        for i in range(min(args.per_folder, args.files - created)):
+            with open(os.path.join(folder, f'file{i:05}.txt'), 'wb') as f:
+                f.write(content)
+            created += 1
+        nextFolders.extend(os.path.join(folder, f'dir{i:03}') for i in range(args.fanout))
+        if created >= args.files:
+            break
+    folders = nextFolders
+
+print(f'Created {created} files in {args.target}')
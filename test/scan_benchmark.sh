@@ -0,0 +1,26 @@
+#!/bin/sh
+
+# SPDX-FileCopyrightText: 2026 Michael Reeves reeves.87@gmail.com
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Counts the system calls made by the QDir based folder scan and by the native Linux
+# scanner (LocalDirectoryScanner) on the same tree.
+#
+# Usage: scan_benchmark.sh <path to LocalDirectoryScannerTest> <tree>
+# Create the tree first, e.g.: ./generate_scan_tree.py /tmp/scantree
+# Drop the page cache between runs (echo 3 > /proc/sys/vm/drop_caches) to compare cold scans.
+
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <LocalDirectoryScannerTest> <tree>"
+    exit 1
+fi
+
+test_binary=$1
+export KDIFF3_SCAN_BENCHMARK_DIR=$2
+export QT_QPA_PLATFORM=offscreen
+
+for benchmark in benchmarkQDir benchmarkNative; do
+    echo "== $benchmark"
+    strace -f -c -o "$benchmark.strace" "$test_binary" "$benchmark" | grep -E "Entries|msecs"
+    grep -E "statx|newfstatat|lstat|stat|getdents|access|readlink|openat|total" "$benchmark.strace"
+done